@@ -0,0 +1,375 @@
+// Microbenchmarks do pvfirst_core.
+//
+// Cada caso roda o mesmo trecho muitas vezes e mostra:
+// - ns/op: tempo medio por chamada
+// - aloc/op: quantas alocacoes no heap cada chamada fez, em media
+//
+// Nao tem rede nem SimGrid aqui: so o modelo puro, com entradas fixas. O unico
+// arquivo lido e a mascara de horizonte de bench/fixtures (PVFIRST_FIXTURES_DIR),
+// uma vez, antes dos casos de PlaneOfArray.
+
+#include "energy/EnergyModel.hpp"
+#include "energy/PanelFleet.hpp"
+#include "energy/PanelModel.hpp"
+#include "metrics/Metrics.hpp"
+#include "policy/PVFirstPolicy.hpp"
+#include "sensors/IrradianceStream.hpp"
+#include "sensors/MetarReport.hpp"
+#include "sensors/PlaneOfArray.hpp"
+#include "sensors/RampDetector.hpp"
+#include "sensors/SensorPayloads.hpp"
+#include "sensors/SolarModel.hpp"
+#include "sensors/SpscRing.hpp"
+#include "storage/CsvScanner.hpp"
+#include "storage/ResultsCsvReader.hpp"
+#include "storage/ResultsCsvWriter.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace
+{
+    unsigned long long allocationCount = 0;
+}
+
+// Aqui eu conto toda alocacao do processo.
+// O benchmark e single-thread, entao um contador simples basta.
+void* operator new(std::size_t size)
+{
+    allocationCount++;
+    if (void* memory = std::malloc(size == 0 ? 1 : size))
+        return memory;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+namespace
+{
+    // Impede o compilador de jogar fora um resultado que ninguem usa.
+    template <class T>
+    void keep(const T& value)
+    {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    const std::string weatherResponse =
+        "{\"latitude\":-1.5,\"longitude\":-48.5,\"generationtime_ms\":0.03,"
+        "\"utc_offset_seconds\":0,\"timezone\":\"GMT\",\"timezone_abbreviation\":\"GMT\","
+        "\"elevation\":10.0,\"current_units\":{\"time\":\"iso8601\",\"interval\":\"seconds\","
+        "\"temperature_2m\":\"C\",\"cloudcover\":\"%\",\"precipitation\":\"mm\","
+        "\"windspeed_10m\":\"km/h\"},\"current\":{\"time\":\"2026-06-21T09:00\",\"interval\":900,"
+        "\"temperature_2m\":23.3,\"cloudcover\":24,\"precipitation\":0.00,\"windspeed_10m\":5.6}}";
+
+    const std::string locationResponse =
+        "{\"status\":\"success\",\"country\":\"Brazil\",\"countryCode\":\"BR\",\"region\":\"PA\","
+        "\"regionName\":\"Para\",\"city\":\"Belem\",\"zip\":\"66000-000\",\"lat\":-1.4537,"
+        "\"lon\":-48.5078,\"timezone\":\"America/Belem\",\"isp\":\"Provedor\",\"org\":\"Provedor\","
+        "\"as\":\"AS0000 Provedor\",\"query\":\"200.0.0.1\"}";
+
+    const std::string metarReport =
+        "METAR SBBE 211200Z 09008KT 9999 -RA FEW015 SCT030CB BKN100 27/24 Q1012 NOSIG=";
+
+    template <class Body>
+    void runBench(const char* name, long iterations, Body&& body)
+    {
+        // Um aquecimento curto para cache e branch predictor.
+        for (long i = 0; i < iterations / 10; i++)
+            body(i);
+
+        unsigned long long allocationsBefore = allocationCount;
+        auto start = std::chrono::steady_clock::now();
+
+        for (long i = 0; i < iterations; i++)
+            body(i);
+
+        auto finish = std::chrono::steady_clock::now();
+        unsigned long long allocations = allocationCount - allocationsBefore;
+
+        double elapsedNs = std::chrono::duration<double, std::nano>(finish - start).count();
+
+        std::printf("%-36s %12.1f ns/op %10.2f aloc/op\n",
+                    name,
+                    elapsedNs / static_cast<double>(iterations),
+                    static_cast<double>(allocations) / static_cast<double>(iterations));
+    }
+
+    ResultRow sampleRow()
+    {
+        ResultRow row;
+        row.year   = 2026;
+        row.month  = 6;
+        row.day    = 21;
+        row.hour   = 9;
+        row.minute = 30;
+        row.second = 12;
+
+        row.dayOfYear = 172;
+        row.city      = "Belem";
+        row.latitude  = -1.4537;
+        row.longitude = -48.5078;
+
+        row.panelMaterial                = "monocrystalline";
+        row.panelFaceType                = "monofacial";
+        row.panelAreaM2                  = 10.0;
+        row.panelBaseEfficiency          = 0.2;
+        row.panelMaterialFactor          = 1.0;
+        row.panelEffectiveBaseEfficiency = 0.2;
+        row.panelBifacialGainFactor      = 1.1;
+
+        row.cloudCoverPct = 24.0;
+        row.rainMm        = 0.0;
+        row.temperatureC  = 23.3;
+        row.windSpeedKmh  = 5.6;
+
+        row.irradianceTheoreticalWm2 = 771.234;
+        row.irradianceAdjustedWm2    = 632.412;
+        row.pvEfficiency             = 0.200896;
+        row.pvPowerKW                = 1.27049;
+
+        row.gridCarbonIntensity = 100.0;
+
+        row.jobFlops          = 5e10;
+        row.jobDurationS      = 1.0;
+        row.jobEnergyJ        = 250.0;
+        row.jobEnergyKWh      = 6.94444e-05;
+        row.jobAveragePowerKW = 0.25;
+
+        row.energyTotalKWh = 6.94444e-05;
+        row.energyPvKWh    = 6.94444e-05;
+        row.energyGridKWh  = 0.0;
+        row.co2G           = 0.0;
+        return row;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    long iterations = 1000000;
+    if (argc > 1)
+        iterations = std::atol(argv[1]);
+
+    if (iterations <= 0) {
+        std::fprintf(stderr, "Uso: pvfirst_bench [iteracoes]\n");
+        return 1;
+    }
+
+    std::printf("pvfirst_bench: %ld iteracoes por caso\n\n", iterations);
+
+    SolarModel solar;
+    runBench("SolarModel::computeIrradiance", iterations, [&](long i) {
+        double hour = 6.0 + static_cast<double>(i % 720) / 60.0;
+        keep(solar.computeIrradiance(-1.4537, 172, hour));
+    });
+
+    // Janela de um job de 1 s a 1 h: o custo nao depende do tamanho da janela.
+    runBench("SolarModel::integrateIrradiance", iterations, [&](long i) {
+        double hour = 6.0 + static_cast<double>(i % 720) / 60.0;
+        double windowHours = static_cast<double>(1 + i % 3600) / 3600.0;
+        keep(solar.integrateIrradiance(-1.4537, 172, hour, hour + windowHours));
+    });
+
+    double firstHour = 0.0;
+    double lastHour = 0.0;
+    runBench("SolarModel::solarWindow", iterations, [&](long i) {
+        keep(solar.solarWindow(-1.4537, static_cast<int>(1 + i % 365), 1.0, firstHour, lastHour));
+        keep(lastHour - firstHour);
+    });
+
+    PVFirstPolicy policy;
+    runBench("PVFirstPolicy::apply", iterations, [&](long i) {
+        double pv = static_cast<double>(i % 500) / 1000.0;
+        keep(policy.apply(0.25, pv));
+    });
+
+    EnergyModel energy(100.0);
+    runBench("EnergyModel::update", iterations, [&](long i) {
+        double pv = static_cast<double>(i % 500) / 1000.0;
+        energy.update(0.25, pv, 1.0);
+    });
+    keep(energy.getStats());
+
+    PVConfig pv;
+    WeatherImpact impact = parseWeatherPayload(weatherResponse);
+    runBench("evaluatePanel", iterations, [&](long i) {
+        double irradiance = static_cast<double>(i % 1000);
+        keep(evaluatePanel(pv, impact, irradiance));
+    });
+
+    // Projeto de usina: 4096 arranjos misturando os tres materiais e as duas faces.
+    // O ns/op e da passada inteira; dividido por 4096 da o custo de um arranjo.
+    const char* materials[] = {"monocrystalline", "polycrystalline", "thinfilm"};
+    PanelFleet plant;
+    plant.reserve(4096);
+    for (int array = 0; array < 4096; array++) {
+        PVConfig config;
+        config.panelMaterial = materials[array % 3];
+        config.panelFaceType = array % 2 == 0 ? "monofacial" : "bifacial";
+        config.panelAreaM2 = 2.0 + static_cast<double>(array % 17);
+        config.baseEfficiency = 0.18 + static_cast<double>(array % 5) * 0.01;
+        plant.add(config);
+    }
+    std::vector<double> plantPowers(plant.size());
+    runBench("PanelFleet::evaluate (4096 arranjos)", iterations / 4096 + 1, [&](long i) {
+        double irradiance = static_cast<double>(i % 1000);
+        keep(plant.evaluate(impact, irradiance, plantPowers.data()));
+    });
+
+    // Painel inclinado para o norte, com e sem o predio e o beiral de fixtures/horizonte.csv. O sol anda pelo dia
+    // inteiro, como num ano minuto a minuto; de noite a conta sai logo no comeco.
+    PlaneOfArray tilted(ArrayOrientation{10.0, 0.0, 0.2});
+    runBench("PlaneOfArray::transpose", iterations, [&](long i) {
+        double hour = static_cast<double>(i % 1440) / 60.0;
+        SunVector sun = solar.sunVector(-1.4537, 172, hour);
+        keep(tilted.transpose(900.0 * sun.up, sun, 172).totalWm2);
+    });
+
+    HorizonMask horizon = HorizonMask::loadCsv(PVFIRST_FIXTURES_DIR "/horizonte.csv");
+
+    PlaneOfArray shaded(ArrayOrientation{10.0, 0.0, 0.2}, &horizon);
+    runBench("PlaneOfArray::transpose (horizonte)", iterations, [&](long i) {
+        double hour = static_cast<double>(i % 1440) / 60.0;
+        SunVector sun = solar.sunVector(-1.4537, 172, hour);
+        keep(shaded.transpose(900.0 * sun.up, sun, 172).totalWm2);
+    });
+
+    runBench("extractCurrentValue", iterations, [&](long) {
+        keep(extractCurrentValue(weatherResponse, "windspeed_10m", 0.0));
+    });
+
+    runBench("extractNumber", iterations, [&](long) {
+        keep(extractNumber(locationResponse, "\"lon\"", 0.0));
+    });
+
+    runBench("extractText", iterations, [&](long) {
+        std::string city = extractText(locationResponse, "\"city\":\"", "");
+        keep(city.size());
+    });
+
+    runBench("parseWeatherPayload", iterations, [&](long) {
+        keep(parseWeatherPayload(weatherResponse));
+    });
+
+    MetarReport report;
+    runBench("parseMetar", iterations, [&](long) {
+        keep(parseMetar(metarReport, report));
+        keep(report.cloudCoverPct);
+    });
+
+    // Resposta do modo frota com 100 sitios: o custo por sitio tem que ficar
+    // perto do de uma resposta de um sitio so.
+    std::string batchResponse = "[";
+    for (int site = 0; site < 100; site++) {
+        if (site > 0)
+            batchResponse += ',';
+        batchResponse += weatherResponse;
+    }
+    batchResponse += ']';
+
+    std::vector<WeatherImpact> impacts;
+    impacts.reserve(100);
+    runBench("parseWeatherBatchPayload (100 sitios)", iterations / 100, [&](long) {
+        impacts.clear();
+        keep(parseWeatherBatchPayload(batchResponse, impacts));
+    });
+
+    StreamSample sample;
+    runBench("parseStreamLine", iterations, [&](long i) {
+        keep(parseStreamLine("1782036000.25;812.4", i, sample));
+        keep(sample.value);
+    });
+
+    // Na mesma thread: mede o custo das barreiras de memoria, sem a disputa pela linha de cache.
+    static SpscRing<StreamSample, 4096> ring;
+    runBench("SpscRing push+pop", iterations, [&](long i) {
+        sample.timeNs = i;
+        ring.push(sample);
+        keep(ring.pop(sample));
+    });
+
+    // 1 Hz com uma borda de nuvem a cada 90 amostras: a fila do maximo e a do minimo
+    // andam do jeito que andariam num dia de nuvem picotada.
+    RampDetector ramps(RampConfig{});
+    RampEvent ramp;
+    runBench("RampDetector::observe", iterations, [&](long i) {
+        sample.timeNs = static_cast<std::int64_t>(i) * 1000000000;
+        sample.value = (i / 90) % 2 == 0 ? 800.0 + static_cast<double>(i % 7) : 250.0 + static_cast<double>(i % 5);
+        keep(ramps.observe(sample, ramp));
+    });
+
+    GPSData fallback;
+    runBench("parseLocationPayload", iterations, [&](long) {
+        GPSData gps = parseLocationPayload(locationResponse, fallback);
+        keep(gps.latitude);
+    });
+
+    ResultRow row = sampleRow();
+    std::string line;
+    runBench("ResultsCsvWriter::appendRow", iterations, [&](long i) {
+        line.clear();
+        row.second = static_cast<int>(i % 60);
+        ResultsCsvWriter::appendRow(line, row);
+        keep(line.size());
+    });
+
+    std::string csvLine;
+    ResultsCsvWriter::appendRow(csvLine, row);
+    csvLine.pop_back();
+    ResultRow parsed;
+    runBench("ResultsCsvReader::parseLine", iterations, [&](long) {
+        keep(ResultsCsvReader::parseLine(csvLine, parsed));
+    });
+
+    // So a separacao dos 33 campos, sem converter numero nenhum.
+    std::string_view fields[33];
+    runBench("CsvScanner::nextLine", iterations, [&](long) {
+        std::size_t fieldCount = 0;
+        CsvScanner scanner(csvLine);
+        scanner.nextLine(fields, 33, fieldCount);
+        keep(fieldCount);
+    });
+
+    // O que o controller paga por execucao para manter as metricas em dia.
+    PvfirstMetrics& processMetrics = metrics();
+    runBench("metrics gauge+contador+histograma", iterations, [&](long i) {
+        double value = static_cast<double>(i % 1000) / 1000.0;
+        processMetrics.pvPowerKW.set(value);
+        processMetrics.energyPvKWh.add(value);
+        processMetrics.simgridRunSeconds.observe(value * 0.01);
+    });
+
+    std::string exposition;
+    runBench("renderPrometheus", iterations / 100, [&](long) {
+        exposition = renderPrometheus(processMetrics);
+        keep(exposition.size());
+    });
+
+    return 0;
+}
@@ -0,0 +1,362 @@
+// Regressao dos dias de referencia (results/6.JUNHO).
+//
+// Cada linha desses CSVs guarda as entradas reais de um minuto (posicao, clima,
+// job do SimGrid) e as saidas que o modelo calculou na hora (irradiancia,
+// painel, divisao PV/rede e CO2). Aqui eu passo as entradas de novo pela
+// mesma conta do SimulationController (evaluateTickPv e evaluateTickEnergy,
+// em energy/TickModel.hpp) e confiro se as saidas batem com as gravadas,
+// dentro da tolerancia.
+//
+// O CSV guarda os numeros com 6 algarismos (%g), entao a tolerancia padrao e
+// relativa, de 1e-5. Qualquer otimizacao no caminho numerico tem que passar
+// por aqui sem diferenca.
+//
+// Os dias de junho vieram do run_solar_window.sh, um processo por minuto:
+// cada linha tem a energia so daquele job, entao cada linha usa um EnergyModel novo.
+//
+// Linhas que o leitor nao aceita (o 17/06 foi salvo de novo pelo Excel e o
+// 18/06 tem uma linha com dois campos grudados) sao contadas e puladas.
+//
+// Depois eu confiro o PanelFleet (a conta em colunas da frota e da usina) contra
+// o evaluatePanel, arranjo por arranjo, sob o clima dessas mesmas linhas: as duas
+// contas so mudam a ordem das multiplicacoes, entao a diferenca tem que ficar
+// em poucos ulps (fleetTolerance).
+//
+// Sai com 1 se alguma saida nao bater. Tambem mostra o tempo medio por linha
+// do replay, repetido varias vezes para o numero ficar estavel.
+
+#include "energy/PanelFleet.hpp"
+#include "energy/TickModel.hpp"
+#include "sensors/SensorPayloads.hpp"
+#include "storage/ResultsCsvReader.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#ifndef PVFIRST_GOLDEN_DIR
+#define PVFIRST_GOLDEN_DIR "results/6.JUNHO"
+#endif
+
+namespace
+{
+    // Diferenca relativa aceita entre o PanelFleet e o evaluatePanel.
+    const double fleetTolerance = 1e-14;
+
+    // Saidas do modelo que a linha do CSV guarda.
+    struct ReplayOutput
+    {
+        double irradianceTheoreticalWm2     = 0.0;
+        double irradianceAdjustedWm2        = 0.0;
+        double panelMaterialFactor          = 0.0;
+        double panelEffectiveBaseEfficiency = 0.0;
+        double pvEfficiency                 = 0.0;
+        double pvPowerKW                    = 0.0;
+        double energyTotalKWh               = 0.0;
+        double energyPvKWh                  = 0.0;
+        double energyGridKWh                = 0.0;
+        double co2G                         = 0.0;
+    };
+
+    struct GoldenRow
+    {
+        std::string file;
+        std::size_t line = 0;
+        ResultRow row;
+    };
+
+    WeatherImpact impactOf(const ResultRow& row)
+    {
+        WeatherImpact impact;
+        impact.cloudCover  = row.cloudCoverPct;
+        impact.rainAmount  = row.rainMm;
+        impact.temperature = row.temperatureC;
+        impact.windSpeed   = row.windSpeedKmh;
+        applyWeatherFactors(impact);
+        return impact;
+    }
+
+    ReplayOutput replay(const ResultRow& row, const PVConfig& pv)
+    {
+        ReplayOutput out;
+
+        // As linhas de junho nao tinham medidor local: measured fica vazio.
+        TickPvInput input;
+        input.latitude    = row.latitude;
+        input.dayOfYear   = row.dayOfYear;
+        input.hourDecimal = row.hour + row.minute / 60.0;
+        input.impact      = impactOf(row);
+
+        TickPv tick = evaluateTickPv(pv, input);
+        const PanelOutput& panel = tick.panel;
+        out.irradianceTheoreticalWm2     = tick.irradianceTheoreticalWm2;
+        out.irradianceAdjustedWm2        = panel.irradianceAdjustedWm2;
+        out.panelMaterialFactor          = panel.materialFactor;
+        out.panelEffectiveBaseEfficiency = panel.effectiveBaseEfficiency;
+        out.pvEfficiency                 = panel.pvEfficiency;
+        out.pvPowerKW                    = panel.pvPowerKW;
+
+        // As linhas de junho foram gravadas com a potencia do instante em que o job
+        // comecou; o controller de hoje usa a media na janela do job (WindowAverage).
+        // O replay pede o modo de quando elas foram gravadas; o resto da conta e o mesmo.
+        TickJob job;
+        job.averagePowerKW  = row.jobAveragePowerKW;
+        job.durationSeconds = row.jobDurationS;
+        job.carbonIntensity = row.gridCarbonIntensity;
+
+        EnergyModel model(row.gridCarbonIntensity);
+        evaluateTickEnergy(pv, input, tick, job, JobPvMode::JobStart, model);
+        EnergyStats stats = model.getStats();
+        out.energyTotalKWh = stats.E_total;
+        out.energyPvKWh    = stats.E_pv;
+        out.energyGridKWh  = stats.E_grid;
+        out.co2G           = stats.CO2;
+
+        return out;
+    }
+
+    PVConfig panelOf(const ResultRow& row)
+    {
+        PVConfig pv;
+        pv.panelMaterial      = row.panelMaterial;
+        pv.panelFaceType      = row.panelFaceType;
+        pv.panelAreaM2        = row.panelAreaM2;
+        pv.baseEfficiency     = row.panelBaseEfficiency;
+        pv.bifacialGainFactor = row.panelBifacialGainFactor;
+        return pv;
+    }
+
+    bool withinTolerance(double stored, double replayed, double tolerance)
+    {
+        double scale = std::max(std::fabs(stored), std::fabs(replayed));
+        return std::fabs(stored - replayed) <= tolerance * scale + 1e-12;
+    }
+
+    double relativeError(double expected, double actual)
+    {
+        double scale = std::max(std::fabs(expected), std::fabs(actual));
+        return scale > 0.0 ? std::fabs(expected - actual) / scale : 0.0;
+    }
+
+    // 360 arranjos (3 materiais x 2 faces x 6 areas x 10 eficiencias), nas duas
+    // formas do PanelFleet::evaluate:
+    // - todos sob o clima de uma linha (uma linha a cada sampleStep);
+    // - cada arranjo com a irradiancia ajustada e o clima de uma linha diferente.
+    // Devolve quantas potencias (e totais) passaram de fleetTolerance.
+    std::size_t checkPanelFleet(const std::vector<GoldenRow>& rows, std::size_t& comparisons, double& worst)
+    {
+        const char* materials[] = {"monocrystalline", "polycrystalline", "thinfilm"};
+        const char* faces[] = {"monofacial", "bifacial"};
+
+        std::vector<PVConfig> configs;
+        PanelFleet fleet;
+        for (const char* material : materials) {
+            for (const char* face : faces) {
+                for (int area = 0; area < 6; area++) {
+                    for (int efficiency = 0; efficiency < 10; efficiency++) {
+                        PVConfig pv;
+                        pv.panelMaterial  = material;
+                        pv.panelFaceType  = face;
+                        pv.panelAreaM2    = 1.5 + 3.7 * area;
+                        pv.baseEfficiency = 0.15 + 0.011 * efficiency;
+                        configs.push_back(pv);
+                        fleet.add(pv);
+                    }
+                }
+            }
+        }
+
+        std::size_t mismatches = 0;
+        auto compare = [&](double expected, double actual) {
+            double error = relativeError(expected, actual);
+            worst = std::max(worst, error);
+            comparisons++;
+            if (error > fleetTolerance) {
+                if (mismatches < 5)
+                    std::printf("DIFERENTE PanelFleet: evaluatePanel %.17g, PanelFleet %.17g\n", expected, actual);
+                mismatches++;
+            }
+        };
+
+        std::vector<double> powers(fleet.size());
+        const std::size_t sampleStep = 10;
+
+        for (std::size_t r = 0; r < rows.size(); r += sampleStep) {
+            const ResultRow& row = rows[r].row;
+            WeatherImpact impact = impactOf(row);
+
+            double total = fleet.evaluate(impact, row.irradianceTheoreticalWm2, powers.data());
+            double expectedTotal = 0.0;
+            for (std::size_t i = 0; i < configs.size(); i++) {
+                double expected = evaluatePanel(configs[i], impact, row.irradianceTheoreticalWm2).pvPowerKW;
+                compare(expected, powers[i]);
+                expectedTotal += expected;
+            }
+            compare(expectedTotal, total);
+        }
+
+        std::vector<double> adjusted(fleet.size());
+        std::vector<double> weatherFactors(fleet.size());
+        std::vector<double> expected(fleet.size());
+        for (std::size_t i = 0; i < configs.size(); i++) {
+            const ResultRow& row = rows[(i * 7919) % rows.size()].row;
+            WeatherImpact impact = impactOf(row);
+            PanelOutput panel = evaluatePanel(configs[i], impact, row.irradianceTheoreticalWm2);
+            adjusted[i] = panel.irradianceAdjustedWm2;
+            weatherFactors[i] = impact.tempFactor * impact.windCoolingFactor;
+            expected[i] = panel.pvPowerKW;
+        }
+        fleet.evaluate(adjusted.data(), weatherFactors.data(), powers.data());
+        for (std::size_t i = 0; i < configs.size(); i++)
+            compare(expected[i], powers[i]);
+
+        return mismatches;
+    }
+
+    std::vector<GoldenRow> loadGoldenRows(const std::string& directory, std::size_t& skippedLines)
+    {
+        std::vector<std::filesystem::path> files;
+        for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+            std::string name = entry.path().filename().string();
+            if (name.rfind("RPVfirst", 0) == 0 && entry.path().extension() == ".csv")
+                files.push_back(entry.path());
+        }
+        std::sort(files.begin(), files.end());
+
+        std::vector<GoldenRow> rows;
+
+        for (const auto& path : files) {
+            std::size_t before = rows.size();
+            ResultsCsvReader reader(path.string());
+            GoldenRow golden;
+            golden.file = path.filename().string();
+
+            for (;;) {
+                try {
+                    if (!reader.next(golden.row))
+                        break;
+                    golden.line = reader.lineNumber();
+                    rows.push_back(golden);
+                }
+                catch (const std::exception&) {
+                    skippedLines++;
+                }
+            }
+
+            std::printf("%s: %zu linhas\n", golden.file.c_str(), rows.size() - before);
+        }
+
+        return rows;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::string directory = PVFIRST_GOLDEN_DIR;
+    double tolerance = 1e-5;
+    int repetitions = 200;
+
+    if (argc > 1)
+        directory = argv[1];
+    if (argc > 2)
+        tolerance = std::atof(argv[2]);
+    if (argc > 3)
+        repetitions = std::atoi(argv[3]);
+
+    if (tolerance <= 0.0 || repetitions <= 0) {
+        std::fprintf(stderr, "Uso: pvfirst_golden [pasta] [tolerancia_relativa] [repeticoes]\n");
+        return 1;
+    }
+
+    try {
+        std::size_t skippedLines = 0;
+        std::vector<GoldenRow> rows = loadGoldenRows(directory, skippedLines);
+
+        if (rows.empty()) {
+            std::fprintf(stderr, "Nenhuma linha de referencia em %s\n", directory.c_str());
+            return 1;
+        }
+
+        std::vector<PVConfig> panels;
+        panels.reserve(rows.size());
+        for (const GoldenRow& golden : rows)
+            panels.push_back(panelOf(golden.row));
+
+        // Replay cronometrado: so as contas do modelo, sem leitura de arquivo.
+        std::vector<ReplayOutput> outputs(rows.size());
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < repetitions; r++) {
+            for (std::size_t i = 0; i < rows.size(); i++)
+                outputs[i] = replay(rows[i].row, panels[i]);
+        }
+        auto finish = std::chrono::steady_clock::now();
+
+        struct Check
+        {
+            const char* column;
+            double ResultRow::* stored;
+            double ReplayOutput::* replayed;
+        };
+
+        const Check checks[] = {
+            {"irradiance_theoretical_w_m2", &ResultRow::irradianceTheoreticalWm2, &ReplayOutput::irradianceTheoreticalWm2},
+            {"irradiance_adjusted_w_m2", &ResultRow::irradianceAdjustedWm2, &ReplayOutput::irradianceAdjustedWm2},
+            {"panel_material_factor", &ResultRow::panelMaterialFactor, &ReplayOutput::panelMaterialFactor},
+            {"panel_effective_base_efficiency", &ResultRow::panelEffectiveBaseEfficiency, &ReplayOutput::panelEffectiveBaseEfficiency},
+            {"pv_efficiency", &ResultRow::pvEfficiency, &ReplayOutput::pvEfficiency},
+            {"pv_power_kw", &ResultRow::pvPowerKW, &ReplayOutput::pvPowerKW},
+            {"energy_total_kwh", &ResultRow::energyTotalKWh, &ReplayOutput::energyTotalKWh},
+            {"energy_pv_kwh", &ResultRow::energyPvKWh, &ReplayOutput::energyPvKWh},
+            {"energy_grid_kwh", &ResultRow::energyGridKWh, &ReplayOutput::energyGridKWh},
+            {"co2_g", &ResultRow::co2G, &ReplayOutput::co2G},
+        };
+
+        std::size_t mismatches = 0;
+        for (std::size_t i = 0; i < rows.size(); i++) {
+            for (const Check& check : checks) {
+                double stored = rows[i].row.*check.stored;
+                double replayed = outputs[i].*check.replayed;
+                if (withinTolerance(stored, replayed, tolerance))
+                    continue;
+
+                // As primeiras diferencas ja mostram o problema; o resto so entra na contagem.
+                if (mismatches < 20) {
+                    std::printf("DIFERENTE %s linha %zu, %s: gravado %.9g, replay %.9g\n",
+                                rows[i].file.c_str(), rows[i].line, check.column, stored, replayed);
+                }
+                mismatches++;
+            }
+        }
+
+        double totalNs = std::chrono::duration<double, std::nano>(finish - start).count();
+        std::printf("\n%zu linhas conferidas (%zu ilegiveis puladas), tolerancia relativa %g\n",
+                    rows.size(), skippedLines, tolerance);
+        std::printf("replay: %.1f ns por linha (%d repeticoes)\n",
+                    totalNs / (static_cast<double>(rows.size()) * repetitions), repetitions);
+
+        std::size_t fleetComparisons = 0;
+        double fleetWorst = 0.0;
+        std::size_t fleetMismatches = checkPanelFleet(rows, fleetComparisons, fleetWorst);
+        std::printf("PanelFleet: %zu potencias conferidas com o evaluatePanel, maior diferenca relativa %.3g\n",
+                    fleetComparisons, fleetWorst);
+
+        if (mismatches > 0 || fleetMismatches > 0) {
+            std::printf("FALHOU: %zu saidas fora da tolerancia, %zu do PanelFleet\n", mismatches, fleetMismatches);
+            return 1;
+        }
+
+        std::printf("OK: todas as saidas batem\n");
+    }
+    catch (const std::exception& e) {
+        std::fprintf(stderr, "Erro: %s\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,176 @@
+// Benchmark de ponta a ponta de uma execucao (tick) do SimulationController.
+//
+// Aqui eu rodo o pipeline inteiro do controller N vezes:
+// localizacao, clima, modelo solar, SimGrid, triagem PV-First, CSV e console.
+// A rede e trocada pelas respostas gravadas em bench/fixtures e a hora vem
+// de um relogio virtual que anda 60 s por tick. Assim o resultado so depende
+// do codigo, e nao da conexao ou da hora em que o benchmark rodou.
+//
+// Para cada etapa (e para o total) eu mostro p50, p99 e maximo em microssegundos.
+// O segundo argumento escolhe a saida do controller (texto, jsonl ou silencioso),
+// para comparar o custo da etapa de console entre elas.
+
+#include "simulation/SimulationController.hpp"
+
+#include <xbt/log.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#ifndef PVFIRST_FIXTURES_DIR
+#define PVFIRST_FIXTURES_DIR "bench/fixtures"
+#endif
+
+namespace
+{
+    // Descarta tudo o que o controller escreve no console.
+    // A formatacao continua acontecendo (e sendo medida); so o terminal fica de fora.
+    class NullBuffer : public std::streambuf
+    {
+    protected:
+        int overflow(int c) override
+        {
+            return c;
+        }
+
+        std::streamsize xsputn(const char*, std::streamsize count) override
+        {
+            return count;
+        }
+    };
+
+    std::string readFixture(const std::string& name)
+    {
+        std::filesystem::path path = std::filesystem::path(PVFIRST_FIXTURES_DIR) / name;
+
+        std::ifstream file(path);
+        if (!file.is_open())
+            throw std::runtime_error("Nao encontrei a fixture: " + path.string());
+
+        std::ostringstream content;
+        content << file.rdbuf();
+        return content.str();
+    }
+
+    double percentile(std::vector<std::int64_t> values, double fraction)
+    {
+        if (values.empty())
+            return 0.0;
+
+        std::sort(values.begin(), values.end());
+        std::size_t index = static_cast<std::size_t>(fraction * static_cast<double>(values.size() - 1) + 0.5);
+        return static_cast<double>(values[index]) / 1000.0;
+    }
+
+    void printStats(const char* name, const std::vector<std::int64_t>& samples)
+    {
+        std::int64_t maxNs = samples.empty() ? 0 : *std::max_element(samples.begin(), samples.end());
+
+        std::printf("%-16s %12.1f %12.1f %12.1f\n",
+                    name,
+                    percentile(samples, 0.50),
+                    percentile(samples, 0.99),
+                    static_cast<double>(maxNs) / 1000.0);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    xbt_log_control_set("host_energy.thres:critical");
+
+    int ticks = 600;
+    if (argc > 1)
+        ticks = std::atoi(argv[1]);
+
+    OutputMode output = OutputMode::Text;
+    bool validOutput = argc <= 2 || parseOutputMode(argv[2], output);
+
+    if (ticks <= 0 || !validOutput) {
+        std::fprintf(stderr, "Uso: pvfirst_tick_bench [ticks] [texto|jsonl|silencioso]\n");
+        return 1;
+    }
+
+    try {
+        const std::string locationResponse = readFixture("ip-api.json");
+        const std::string weatherResponse  = readFixture("open-meteo.json");
+
+        SimulationConfig config;
+        config.askJobInput = false;
+        config.stageTiming = true;
+        config.output      = output;
+        config.resultsDir  = (std::filesystem::temp_directory_path() / "pvfirst_tick_bench").string();
+
+        std::filesystem::remove_all(config.resultsDir);
+
+        // Relogio virtual: comeca em 21/06/2026 06:00 (hora local) e anda 60 s por tick.
+        std::tm start{};
+        start.tm_year  = 2026 - 1900;
+        start.tm_mon   = 5;
+        start.tm_mday  = 21;
+        start.tm_hour  = 6;
+        start.tm_isdst = -1;
+        std::time_t virtualNow = std::mktime(&start);
+
+        HttpFetcher cannedFetcher = [&](const std::string& url,
+                                        std::string& response,
+                                        std::chrono::milliseconds) {
+            if (url.find("ip-api") != std::string::npos)
+                response = locationResponse;
+            else
+                response = weatherResponse;
+            return HttpStatus::Ok;
+        };
+
+        std::vector<std::vector<std::int64_t>> stageSamples(tickStageCount);
+        std::vector<std::int64_t> totalSamples;
+        totalSamples.reserve(static_cast<std::size_t>(ticks));
+
+        NullBuffer nullBuffer;
+        std::streambuf* consoleBuffer = std::cout.rdbuf(&nullBuffer);
+
+        for (int i = 0; i < ticks; i++) {
+            // Um controller novo por tick, igual ao modo daemon.
+            SimulationController controller(config);
+            controller.setHttpFetcher(cannedFetcher);
+            controller.setClock([virtualNow]() { return virtualNow; });
+
+            controller.run();
+
+            const TickProfile& profile = controller.getLastProfile();
+            for (std::size_t stage = 0; stage < tickStageCount; stage++)
+                stageSamples[stage].push_back(profile.stageNs[stage]);
+            totalSamples.push_back(profile.totalNs);
+
+            virtualNow += 60;
+        }
+
+        std::cout.rdbuf(consoleBuffer);
+
+        std::printf("pvfirst_tick_bench: %d ticks, saida %s\n\n", ticks, argc > 2 ? argv[2] : "texto");
+        std::printf("%-16s %12s %12s %12s\n", "etapa", "p50 (us)", "p99 (us)", "max (us)");
+
+        for (std::size_t stage = 0; stage < tickStageCount; stage++)
+            printStats(tickStageName(static_cast<TickStage>(stage)), stageSamples[stage]);
+
+        printStats("total", totalSamples);
+
+        std::filesystem::remove_all(config.resultsDir);
+    }
+    catch (const std::exception& e) {
+        std::fprintf(stderr, "O benchmark parou: %s\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}
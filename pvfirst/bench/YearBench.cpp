@@ -0,0 +1,108 @@
+// Benchmark da simulacao de um ano (YearSimulator).
+//
+// Meta: um ano minuto a minuto (525.600 passos) em menos de 1 s num nucleo so.
+// Aqui eu rodo o ano algumas vezes com ceu limpo e com um clima horario
+// sintetico (8760 amostras geradas em memoria, sempre iguais), com o painel
+// deitado e inclinado com horizonte, e mostro o melhor tempo, a mediana e os
+// passos por segundo de cada caso.
+// Sai com 1 se a mediana passar da meta.
+
+#include "energy/YearSimulator.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+    const double targetSeconds = 1.0;
+
+    // Clima horario de mentira, mas com a cara de Belem: nuvem e chuva
+    // variando ao longo do dia e do ano, temperatura entre 23 e 32 C.
+    WeatherSeries syntheticWeather()
+    {
+        WeatherSeries series;
+        unsigned state = 12345;
+
+        for (int hour = 0; hour < 365 * 24; hour++) {
+            state = state * 1103515245u + 12345u;
+            double noise = static_cast<double>((state >> 16) & 0x7fff) / 32767.0;
+            double hourOfDay = hour % 24;
+            double dayPhase = std::sin((hourOfDay - 9.0) / 24.0 * 2.0 * M_PI);
+
+            series.secondOfYear.push_back(static_cast<std::int64_t>(hour) * 3600);
+            series.cloudCoverPct.push_back(std::min(100.0, 40.0 + 40.0 * noise + 10.0 * dayPhase));
+            series.rainMm.push_back(noise > 0.85 ? (noise - 0.85) * 40.0 : 0.0);
+            series.temperatureC.push_back(27.5 + 4.5 * dayPhase);
+            series.windSpeedKmh.push_back(4.0 + 6.0 * noise);
+        }
+
+        return series;
+    }
+
+    // Devolve a mediana em segundos e mostra a linha do caso.
+    double runCase(const char* name, const YearSimulator& simulator, const WeatherSeries* weather, int runs)
+    {
+        std::vector<double> seconds;
+        double energyPv = 0.0;
+        unsigned long long steps = 0;
+
+        for (int i = 0; i < runs; i++) {
+            auto start = std::chrono::steady_clock::now();
+            YearSimulationResult result = simulator.run(weather);
+            auto finish = std::chrono::steady_clock::now();
+
+            seconds.push_back(std::chrono::duration<double>(finish - start).count());
+            energyPv = result.year.energyPvKWh;
+            steps = result.year.steps;
+        }
+
+        std::sort(seconds.begin(), seconds.end());
+        double median = seconds[seconds.size() / 2];
+
+        std::printf("%-22s %10.1f %10.1f %12.2f %14.3f\n",
+                    name,
+                    seconds.front() * 1000.0,
+                    median * 1000.0,
+                    static_cast<double>(steps) / median / 1e6,
+                    energyPv);
+        return median;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int runs = 5;
+    if (argc > 1)
+        runs = std::atoi(argv[1]);
+
+    if (runs <= 0) {
+        std::fprintf(stderr, "Uso: pvfirst_year_bench [execucoes]\n");
+        return 1;
+    }
+
+    YearSimulationConfig config;
+    YearSimulator simulator(config);
+    WeatherSeries weather = syntheticWeather();
+
+    std::printf("%-22s %10s %10s %12s %14s\n", "caso", "melhor_ms", "mediana_ms", "Mpassos/s", "energia_pv_kwh");
+
+    double clearSky = runCase("ceu limpo", simulator, nullptr, runs);
+    double withWeather = runCase("clima horario", simulator, &weather, runs);
+
+    // Mesmo ano no plano de um painel inclinado para o norte, com predio e beiral em volta.
+    YearSimulationConfig tiltedConfig;
+    tiltedConfig.pv.orientation.tiltDeg = 10.0;
+    tiltedConfig.pv.horizon = HorizonMask::loadCsv(PVFIRST_FIXTURES_DIR "/horizonte.csv");
+    YearSimulator tilted(tiltedConfig);
+    double withPlane = runCase("inclinado + horizonte", tilted, &weather, runs);
+
+    double worst = std::max({clearSky, withWeather, withPlane});
+    std::printf("\nmeta: 1 ano em %.1f s -> %s (pior mediana %.1f ms)\n",
+                targetSeconds, worst < targetSeconds ? "OK" : "ACIMA DA META", worst * 1000.0);
+
+    return worst < targetSeconds ? 0 : 1;
+}
@@ -0,0 +1,217 @@
+#include "CarbonIntensityProfile.hpp"
+
+#include "storage/CivilTime.hpp"
+#include "storage/CsvScanner.hpp"
+#include "storage/MappedFile.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <stdexcept>
+#include <string_view>
+
+namespace
+{
+    bool parseNumber(std::string_view text, double& value)
+    {
+        std::from_chars_result result = std::from_chars(text.data(), text.data() + text.size(), value);
+        return result.ec == std::errc() && result.ptr == text.data() + text.size();
+    }
+
+    bool parseNumber(std::string_view text, int& value)
+    {
+        std::from_chars_result result = std::from_chars(text.data(), text.data() + text.size(), value);
+        return result.ec == std::errc() && result.ptr == text.data() + text.size();
+    }
+
+    // "HH:MM"
+    bool parseClock(std::string_view text, double& seconds)
+    {
+        int hour = 0;
+        int minute = 0;
+        if (text.size() != 5 || text[2] != ':' ||
+            !parseNumber(text.substr(0, 2), hour) || !parseNumber(text.substr(3, 2), minute) ||
+            hour > 23 || minute > 59)
+            return false;
+
+        seconds = hour * 3600.0 + minute * 60.0;
+        return true;
+    }
+
+    // "AAAA-MM-DD HH:MM"
+    bool parseDateTime(std::string_view text, double& seconds)
+    {
+        int year = 0;
+        int month = 0;
+        int day = 0;
+        double clock = 0.0;
+        if (text.size() != 16 || text[4] != '-' || text[7] != '-' || text[10] != ' ' ||
+            !parseNumber(text.substr(0, 4), year) ||
+            !parseNumber(text.substr(5, 2), month) ||
+            !parseNumber(text.substr(8, 2), day) ||
+            !parseClock(text.substr(11, 5), clock) ||
+            month < 1 || month > 12 || day < 1 || day > 31)
+            return false;
+
+        seconds = static_cast<double>(daysFromCivil(year, static_cast<unsigned>(month), static_cast<unsigned>(day))) * 86400.0 + clock;
+        return true;
+    }
+}
+
+CarbonIntensityProfile CarbonIntensityProfile::loadCsv(const std::string& path)
+{
+    MappedFile file(path);
+    std::string_view text = file.text();
+
+    std::size_t headerEnd = text.find('\n');
+    if (headerEnd == std::string_view::npos || text.substr(0, headerEnd).find("datetime;gco2_kwh") != 0)
+        throw std::runtime_error("O arquivo de fator de emissao nao tem o cabecalho datetime;gco2_kwh: " + path);
+
+    CarbonIntensityProfile profile;
+    CsvScanner scanner(text.substr(headerEnd + 1));
+    std::string_view fields[2];
+    std::size_t fieldCount = 0;
+    std::size_t line = 1;
+
+    while (scanner.nextLine(fields, 2, fieldCount)) {
+        line++;
+
+        if (fieldCount == 1 && fields[0].empty())
+            continue;
+
+        // A primeira amostra decide se o arquivo e de um dia tipico ou com datas.
+        if (profile.times.empty())
+            profile.daily = fields[0].size() == 5;
+
+        double time = 0.0;
+        double value = 0.0;
+        bool valid = fieldCount == 2 &&
+                     (profile.daily ? parseClock(fields[0], time) : parseDateTime(fields[0], time)) &&
+                     parseNumber(fields[1], value) && value >= 0.0;
+
+        if (!valid)
+            throw std::runtime_error("Linha invalida no arquivo de fator de emissao " + path +
+                                     " (linha " + std::to_string(line) + ")");
+
+        if (!profile.times.empty() && time <= profile.times.back())
+            throw std::runtime_error("O arquivo de fator de emissao precisa estar em ordem de hora " + path +
+                                     " (linha " + std::to_string(line) + ")");
+
+        profile.times.push_back(time);
+        profile.values.push_back(value);
+    }
+
+    if (profile.times.empty())
+        throw std::runtime_error("O arquivo de fator de emissao nao tem nenhuma amostra: " + path);
+
+    if (profile.daily) {
+        profile.times.push_back(profile.times.front() + 86400.0);
+        profile.values.push_back(profile.values.front());
+    }
+
+    return profile;
+}
+
+bool CarbonIntensityProfile::isDaily() const
+{
+    return daily;
+}
+
+std::size_t CarbonIntensityProfile::size() const
+{
+    return daily ? times.size() - 1 : times.size();
+}
+
+CarbonIntensityCursor::CarbonIntensityCursor(const CarbonIntensityProfile& profile)
+    : profile(profile)
+{
+}
+
+double CarbonIntensityCursor::valueAt(std::size_t index, double time) const
+{
+    const std::vector<double>& times = profile.times;
+    const std::vector<double>& values = profile.values;
+
+    double fraction = (time - times[index]) / (times[index + 1] - times[index]);
+    return values[index] + (values[index + 1] - values[index]) * fraction;
+}
+
+// Integral entre from e to, os dois dentro da faixa das amostras.
+double CarbonIntensityCursor::integrateInside(double from, double to)
+{
+    const std::vector<double>& times = profile.times;
+    const std::size_t lastSegment = times.size() - 2;
+
+    if (from < times[segment]) {
+        std::size_t found = static_cast<std::size_t>(
+            std::upper_bound(times.begin(), times.end(), from) - times.begin());
+        segment = std::min(found == 0 ? 0 : found - 1, lastSegment);
+    }
+    while (segment < lastSegment && times[segment + 1] <= from)
+        segment++;
+
+    double sum = 0.0;
+    double position = from;
+
+    while (position < to) {
+        double segmentEnd = std::min(to, times[segment + 1]);
+        sum += (segmentEnd - position) * (valueAt(segment, position) + valueAt(segment, segmentEnd)) / 2.0;
+        position = segmentEnd;
+
+        if (position < to && segment < lastSegment)
+            segment++;
+        else
+            break;
+    }
+
+    return sum;
+}
+
+double CarbonIntensityCursor::integrate(double from, double to)
+{
+    const std::vector<double>& times = profile.times;
+    const std::vector<double>& values = profile.values;
+
+    if (times.size() == 1)
+        return values.front() * (to - from);
+
+    if (profile.daily) {
+        // Leva o comeco para dentro do dia do perfil e vai dando a volta.
+        const double first = times.front();
+        const double last = times.back();
+        double position = first + std::fmod(from - first, 86400.0);
+        if (position < first)
+            position += 86400.0;
+
+        double remaining = to - from;
+        double sum = 0.0;
+        while (remaining > 0.0) {
+            double chunk = std::min(remaining, last - position);
+            sum += integrateInside(position, position + chunk);
+            remaining -= chunk;
+            position = first;
+        }
+        return sum;
+    }
+
+    double sum = 0.0;
+    if (from < times.front())
+        sum += values.front() * (std::min(to, times.front()) - from);
+    if (to > times.back())
+        sum += values.back() * (to - std::max(from, times.back()));
+
+    double insideFrom = std::max(from, times.front());
+    double insideTo = std::min(to, times.back());
+    if (insideFrom < insideTo)
+        sum += integrateInside(insideFrom, insideTo);
+
+    return sum;
+}
+
+double CarbonIntensityCursor::average(std::int64_t start, double durationSeconds)
+{
+    // Para o valor de um instante eu uso um intervalo de 1 ms: a reta quase nao muda nele.
+    double duration = durationSeconds > 0.0 ? durationSeconds : 1e-3;
+    double from = static_cast<double>(start);
+    return integrate(from, from + duration) / duration;
+}
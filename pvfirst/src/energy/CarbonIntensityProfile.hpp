@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Fator de emissao da rede (gCO2/kWh) variando no tempo, lido de arquivo.
+//
+// Entre duas amostras o fator muda em linha reta. O CO2 de um intervalo e
+// cobrado pela media do fator nesse intervalo (a integral da reta dividida
+// pela duracao), e nao pelo valor do instante em que o job comecou.
+//
+// Arquivo de ponto e virgula, com amostras de hora em hora ou de 5 em 5 minutos:
+//   datetime;gco2_kwh
+//   2026-06-21 00:00;92.5      (ano inteiro ou qualquer periodo com data)
+// ou
+//   datetime;gco2_kwh
+//   00:00;92.5                 (um dia tipico, repetido todo dia)
+//
+// Com data, antes da primeira amostra vale a primeira e depois da ultima vale a ultima.
+// O tempo e o mesmo de CivilTime.hpp: segundos corridos da hora local.
+class CarbonIntensityProfile
+{
+public:
+    static CarbonIntensityProfile loadCsv(const std::string& path);
+
+    // Perfil de um dia repetido (arquivo so com HH:MM).
+    bool isDaily() const;
+    std::size_t size() const;
+
+private:
+    friend class CarbonIntensityCursor;
+
+    // Tempos em segundos. No perfil diario eu repito a primeira amostra
+    // um dia depois no fim, para a reta fechar a volta da meia-noite.
+    std::vector<double> times;
+    std::vector<double> values;
+    bool daily = false;
+};
+
+// Leitura do perfil andando para frente no tempo.
+// Cada consulta continua do trecho onde a anterior parou: custo constante
+// por intervalo curto (um job, um passo da simulacao). Voltando no tempo,
+// o trecho e achado de novo com busca binaria.
+class CarbonIntensityCursor
+{
+public:
+    explicit CarbonIntensityCursor(const CarbonIntensityProfile& profile);
+
+    // Fator medio entre start e start + durationSeconds.
+    // Com durationSeconds <= 0, o fator do instante start.
+    double average(std::int64_t start, double durationSeconds);
+
+private:
+    double valueAt(std::size_t segment, double time) const;
+    double integrateInside(double from, double to);
+    double integrate(double from, double to);
+
+    const CarbonIntensityProfile& profile;
+    std::size_t segment = 0;
+};
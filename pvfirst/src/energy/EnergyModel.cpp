@@ -8,6 +8,14 @@ EnergyModel::EnergyModel(double carbonIntensity)
 void EnergyModel::update(double P_job,
                          double P_pv,
                          double delta_t_seconds)
+{
+    update(P_job, P_pv, delta_t_seconds, CI_grid);
+}
+
+void EnergyModel::update(double P_job,
+                         double P_pv,
+                         double delta_t_seconds,
+                         double carbonIntensity)
 {
     // Aqui eu mantenho o raciocinio mais direto:
     // 1) o job pede uma certa potencia media
@@ -28,7 +36,7 @@ void EnergyModel::update(double P_job,
     stats.E_grid  += E_grid_interval;
 
     // O CO2 so entra em cima do que veio da rede.
-    stats.CO2 += E_grid_interval * CI_grid;
+    stats.CO2 += E_grid_interval * carbonIntensity;
 }
 
 EnergyStats EnergyModel::getStats() const
@@ -18,6 +18,13 @@ public:
                 double P_pv,
                 double delta_t_seconds);
 
+    // Mesmo calculo, mas com o fator da rede que valeu neste intervalo
+    // (por exemplo a media de um CarbonIntensityProfile), no lugar do fixo.
+    void update(double P_job,
+                double P_pv,
+                double delta_t_seconds,
+                double carbonIntensity);
+
     EnergyStats getStats() const;
 
 private:
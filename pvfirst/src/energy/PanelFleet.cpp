@@ -0,0 +1,87 @@
+#include "PanelFleet.hpp"
+
+#include <algorithm>
+
+namespace
+{
+    // Soma em quatro acumuladores independentes: sem -ffast-math o compilador nao
+    // pode reordenar uma soma de double sozinho, e com uma variavel so o laco
+    // fica preso na latencia de cada adicao.
+    double sumPowers(const double* powerKW, std::size_t count)
+    {
+        double partial[4] = {0.0, 0.0, 0.0, 0.0};
+        std::size_t i = 0;
+
+        for (; i + 4 <= count; i += 4) {
+            partial[0] += powerKW[i];
+            partial[1] += powerKW[i + 1];
+            partial[2] += powerKW[i + 2];
+            partial[3] += powerKW[i + 3];
+        }
+        for (; i < count; i++)
+            partial[0] += powerKW[i];
+
+        return (partial[0] + partial[1]) + (partial[2] + partial[3]);
+    }
+}
+
+void PanelFleet::reserve(std::size_t count)
+{
+    efficiencies.reserve(count);
+    areas.reserve(count);
+}
+
+void PanelFleet::add(const PVConfig& pv)
+{
+    efficiencies.push_back(pv.baseEfficiency *
+                           getPanelMaterialFactor(pv.panelMaterial) *
+                           getPanelFaceGain(pv.panelFaceType, pv.bifacialGainFactor));
+    areas.push_back(pv.panelAreaM2);
+}
+
+std::size_t PanelFleet::size() const
+{
+    return areas.size();
+}
+
+double PanelFleet::efficiency(std::size_t i) const
+{
+    return efficiencies[i];
+}
+
+double PanelFleet::areaM2(std::size_t i) const
+{
+    return areas[i];
+}
+
+double PanelFleet::evaluate(const WeatherImpact& impact, double irradianceTheoreticalWm2, double* powerKW) const
+{
+    // Irradiancia ajustada e fator do clima sao os mesmos para todos: saem do laco.
+    const double irradianceAdjustedWm2 = irradianceTheoreticalWm2 * impact.cloudFactor * impact.rainFactor;
+    const double weatherFactor = impact.tempFactor * impact.windCoolingFactor;
+
+    const double* efficiency = efficiencies.data();
+    const double* area = areas.data();
+    const std::size_t count = areas.size();
+
+    for (std::size_t i = 0; i < count; i++) {
+        double pvEfficiency = efficiency[i] * weatherFactor;
+        powerKW[i] = std::max(pvEfficiency * area[i] * irradianceAdjustedWm2 / 1000.0, 0.0);
+    }
+
+    return sumPowers(powerKW, count);
+}
+
+double PanelFleet::evaluate(const double* irradianceAdjustedWm2, const double* weatherFactor, double* powerKW) const
+{
+    const double* efficiency = efficiencies.data();
+    const double* area = areas.data();
+    const std::size_t count = areas.size();
+
+    for (std::size_t i = 0; i < count; i++) {
+        double pvEfficiency = efficiency[i] * weatherFactor[i];
+        powerKW[i] = std::max(pvEfficiency * area[i] * irradianceAdjustedWm2[i] / 1000.0, 0.0);
+    }
+
+    return sumPowers(powerKW, count);
+}
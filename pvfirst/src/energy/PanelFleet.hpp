@@ -0,0 +1,40 @@
+#pragma once
+
+#include "PanelModel.hpp"
+
+#include <cstddef>
+#include <vector>
+
+// Muitos arranjos de uma vez (projeto de usina, frota de sitios), em colunas.
+//
+// O evaluatePanel compara o texto do material e da face a cada chamada e faz a
+// conta de um painel por vez. Aqui o texto e resolvido uma vez so, no add():
+// de cada arranjo sobram dois numeros, a area e a eficiencia sem clima
+// (base x material x face). As contas sao lacos simples sobre vetores
+// contiguos, que o compilador consegue vetorizar.
+class PanelFleet
+{
+public:
+    void reserve(std::size_t count);
+    void add(const PVConfig& pv);
+
+    std::size_t size() const;
+
+    // Eficiencia sem clima do arranjo i (base x material x face).
+    double efficiency(std::size_t i) const;
+    double areaM2(std::size_t i) const;
+
+    // Todos os arranjos sob o mesmo clima e a mesma irradiancia teorica.
+    // Escreve a potencia de cada um em powerKW (size() posicoes) e devolve o total.
+    // Da o pvPowerKW do evaluatePanel de cada arranjo; so a ordem das multiplicacoes
+    // muda (a face entra antes do clima), entao a diferenca fica no ultimo digito.
+    double evaluate(const WeatherImpact& impact, double irradianceTheoreticalWm2, double* powerKW) const;
+
+    // Cada arranjo com a sua irradiancia ja ajustada (nuvem e chuva) e o seu fator de
+    // temperatura x vento, como na frota de sitios. Mesma saida da versao acima.
+    double evaluate(const double* irradianceAdjustedWm2, const double* weatherFactor, double* powerKW) const;
+
+private:
+    std::vector<double> efficiencies;
+    std::vector<double> areas;
+};
@@ -0,0 +1,67 @@
+#include "PanelModel.hpp"
+
+double getPanelMaterialFactor(const std::string& material)
+{
+    if (material == "monocrystalline")
+        return 1.00;
+
+    if (material == "polycrystalline")
+        return 0.90;
+
+    if (material == "thinfilm")
+        return 0.65;
+
+    // Se vier um texto inesperado, eu nao travo o programa.
+    // So volto para um fator neutro.
+    return 1.00;
+}
+
+double getPanelFaceGain(const std::string& faceType, double bifacialGainFactor)
+{
+    if (faceType == "bifacial")
+        return bifacialGainFactor;
+
+    return 1.0;
+}
+
+PanelOutput evaluatePanel(const PVConfig& pv,
+                          const WeatherImpact& impact,
+                          double irradianceTheoreticalWm2)
+{
+    PanelOutput out;
+
+    // Aqui eu reduzo a irradiancia teorica com os fatores de nuvem e chuva.
+    out.irradianceAdjustedWm2 =
+        irradianceTheoreticalWm2 *
+        impact.cloudFactor *
+        impact.rainFactor;
+
+    // A ideia e:
+    // - baseEfficiency representa a eficiencia de referencia do experimento
+    // - panelMaterial ajusta essa base para o tipo de tecnologia
+    // - panelFaceType ajusta o ganho extra se o painel for bifacial
+    out.materialFactor = getPanelMaterialFactor(pv.panelMaterial);
+
+    out.effectiveBaseEfficiency = pv.baseEfficiency * out.materialFactor;
+
+    out.faceGain = getPanelFaceGain(pv.panelFaceType, pv.bifacialGainFactor);
+
+    // Agora eu monto a eficiencia final do arranjo.
+    // Primeiro ajusto pela tecnologia do painel.
+    // Depois aplico temperatura, vento e eventualmente ganho bifacial.
+    out.pvEfficiency =
+        out.effectiveBaseEfficiency *
+        impact.tempFactor *
+        impact.windCoolingFactor *
+        out.faceGain;
+
+    out.pvPowerKW =
+        out.pvEfficiency *
+        pv.panelAreaM2 *
+        out.irradianceAdjustedWm2 / 1000.0;
+
+    if (out.pvPowerKW < 0.0)
+        out.pvPowerKW = 0.0;
+
+    return out;
+}
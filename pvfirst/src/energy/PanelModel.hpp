@@ -0,0 +1,56 @@
+#pragma once
+
+#include "sensors/MetarSensor.hpp"
+#include "sensors/PlaneOfArray.hpp"
+
+#include <string>
+
+// Aqui eu concentrei os parametros do painel em uma struct simples.
+// A ideia e deixar o experimento mais modular sem mudar a estrutura do projeto.
+//
+// Para trocar o painel, basta alterar estes valores:
+// - panelMaterial: monocrystalline, polycrystalline, thinfilm
+// - panelFaceType: monofacial, bifacial
+// - panelAreaM2
+// - baseEfficiency
+// - bifacialGainFactor
+// - orientation (inclinacao, azimute e albedo; deitado por padrao, ver PlaneOfArray.hpp)
+// - horizon (obstrucoes em volta do arranjo; vazia por padrao)
+struct PVConfig
+{
+    std::string panelMaterial = "monocrystalline";
+    std::string panelFaceType = "monofacial";
+
+    double panelAreaM2 = 10.0;
+    double baseEfficiency = 0.20;
+    double bifacialGainFactor = 1.10;
+
+    ArrayOrientation orientation;
+    HorizonMask horizon;
+};
+
+// Tudo o que sai da conta do painel num instante.
+// Sao exatamente os valores que vao para o console e para o CSV.
+struct PanelOutput
+{
+    double irradianceAdjustedWm2   = 0.0;
+    double materialFactor          = 1.0;
+    double effectiveBaseEfficiency = 0.0;
+    double faceGain                = 1.0;
+    double pvEfficiency            = 0.0;
+    double pvPowerKW               = 0.0;
+};
+
+// Aqui eu converti o tipo de material em um fator multiplicador simples.
+// A base do projeto continua sendo a eficiencia configurada em baseEfficiency.
+// O material ajusta essa base para representar paineis diferentes sem complicar demais o modelo.
+double getPanelMaterialFactor(const std::string& material);
+
+// Aqui eu trato o efeito de monofacial ou bifacial.
+// Se for bifacial, eu aplico um ganho extra configuravel.
+double getPanelFaceGain(const std::string& faceType, double bifacialGainFactor);
+
+// Aplica clima e parametros do painel em cima da irradiancia teorica do SolarModel.
+PanelOutput evaluatePanel(const PVConfig& pv,
+                          const WeatherImpact& impact,
+                          double irradianceTheoreticalWm2);
@@ -0,0 +1,76 @@
+#include "TickModel.hpp"
+#include "sensors/PlaneOfArray.hpp"
+#include "sensors/SolarModel.hpp"
+
+TickPv evaluateTickPv(const PVConfig& pv, const TickPvInput& input)
+{
+    TickPv tick;
+
+    SolarModel solar;
+    tick.irradianceTheoreticalWm2 = solar.computeIrradiance(input.latitude, input.dayOfYear, input.hourDecimal);
+
+    // Painel inclinado ou com horizonte: a GHI (do modelo ou do piranometro)
+    // vai para o plano do arranjo antes do painel.
+    PlaneOfArray plane(pv.orientation, &pv.horizon);
+    SunVector sun;
+    if (!plane.horizontal())
+        sun = solar.sunVector(input.latitude, input.dayOfYear, input.hourDecimal);
+
+    const StreamWindow& measured = input.measured;
+
+    if (measured.count > 0 && input.measuredQuantity == StreamQuantity::Irradiance) {
+        // A irradiancia medida ja tem nuvem e chuva dentro, igual ao --ghi-medido
+        // do simulate-year: do clima sobram so temperatura e vento.
+        // O piranometro fica deitado (GHI), entao ela passa pela mesma transposicao.
+        WeatherImpact measuredImpact = input.impact;
+        measuredImpact.cloudFactor = 1.0;
+        measuredImpact.rainFactor = 1.0;
+
+        double irradianceWm2 = measured.mean;
+        if (!plane.horizontal())
+            irradianceWm2 = plane.transpose(measured.mean, sun, input.dayOfYear).totalWm2;
+
+        tick.panel = evaluatePanel(pv, measuredImpact, irradianceWm2);
+        return tick;
+    }
+
+    tick.panel = evaluatePanel(pv, input.impact, tick.irradianceTheoreticalWm2);
+
+    if (!plane.horizontal()) {
+        WeatherImpact planeImpact = input.impact;
+        planeImpact.cloudFactor = 1.0;
+        planeImpact.rainFactor = 1.0;
+        tick.panel = evaluatePanel(pv, planeImpact,
+                                   plane.transpose(tick.panel.irradianceAdjustedWm2, sun, input.dayOfYear).totalWm2);
+    }
+
+    // Potencia do inversor: ja e a saida do arranjo, o modelo fica so com a irradiancia.
+    if (measured.count > 0)
+        tick.panel.pvPowerKW = measured.mean;
+
+    tick.fromSolarModel = plane.horizontal() && measured.count == 0;
+    return tick;
+}
+
+double evaluateTickEnergy(const PVConfig& pv,
+                          const TickPvInput& input,
+                          const TickPv& tick,
+                          const TickJob& job,
+                          JobPvMode mode,
+                          EnergyModel& model)
+{
+    // A placa entra com a potencia media enquanto o job rodou, e nao com a do instante
+    // em que ele comecou. A potencia e proporcional a irradiancia teorica (o clima fica
+    // o mesmo na janela), entao basta a media exata do SolarModel na janela.
+    double pvKW = tick.panel.pvPowerKW;
+    if (mode == JobPvMode::WindowAverage && tick.fromSolarModel && job.durationSeconds > 0.0) {
+        double windowHours = job.durationSeconds / 3600.0;
+        SolarModel solar;
+        double averageWm2 = solar.integrateIrradiance(input.latitude, input.dayOfYear, input.hourDecimal,
+                                                      input.hourDecimal + windowHours) / windowHours;
+        pvKW = evaluatePanel(pv, input.impact, averageWm2).pvPowerKW;
+    }
+
+    model.update(job.averagePowerKW, pvKW, job.durationSeconds, job.carbonIntensity);
+    return pvKW;
+}
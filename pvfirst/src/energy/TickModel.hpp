@@ -0,0 +1,65 @@
+#pragma once
+
+#include "energy/EnergyModel.hpp"
+#include "energy/PanelModel.hpp"
+#include "sensors/IrradianceStream.hpp"
+
+// A conta numerica de uma execucao, do sol ate a divisao PV/rede, sem rede,
+// arquivo nem SimGrid. O SimulationController chama isto a cada execucao e o
+// pvfirst_golden chama as mesmas funcoes sobre as linhas gravadas, entao
+// qualquer mudanca aqui passa pela regressao dos dias de referencia.
+//
+// Etapas:
+// 1) evaluateTickPv: irradiancia teorica (SolarModel), medidor local se houver,
+//    plano do arranjo (PlaneOfArray) e painel (evaluatePanel);
+// 2) evaluateTickEnergy: potencia da PV durante o job e divisao PV-First no EnergyModel.
+
+// Entradas de um instante. O clima ja vem com os fatores calculados (applyWeatherFactors).
+struct TickPvInput
+{
+    double latitude = 0.0;
+    int dayOfYear = 1;
+    double hourDecimal = 0.0;
+    WeatherImpact impact;
+
+    // Media do medidor local; count zero quando nao tem medidor (ou ele parou).
+    StreamWindow measured;
+    StreamQuantity measuredQuantity = StreamQuantity::Irradiance;
+};
+
+struct TickPv
+{
+    double irradianceTheoreticalWm2 = 0.0;
+    PanelOutput panel;
+
+    // So a potencia que sai direto do SolarModel (painel deitado, sem medidor)
+    // pode ser integrada na janela do job; as outras ficam com o valor do instante.
+    bool fromSolarModel = false;
+};
+
+TickPv evaluateTickPv(const PVConfig& pv, const TickPvInput& input);
+
+// Qual potencia da PV atende o job.
+enum class JobPvMode
+{
+    // Media exata do SolarModel enquanto o job roda (o controller de hoje).
+    WindowAverage,
+
+    // Potencia do instante em que o job comecou (como os dias de junho foram gravados).
+    JobStart
+};
+
+struct TickJob
+{
+    double averagePowerKW = 0.0;
+    double durationSeconds = 0.0;
+    double carbonIntensity = 0.0;
+};
+
+// Soma o job no model e devolve a potencia da PV usada para ele (kW).
+double evaluateTickEnergy(const PVConfig& pv,
+                          const TickPvInput& input,
+                          const TickPv& tick,
+                          const TickJob& job,
+                          JobPvMode mode,
+                          EnergyModel& model);
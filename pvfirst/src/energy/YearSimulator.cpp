@@ -0,0 +1,141 @@
+#include "YearSimulator.hpp"
+#include "EnergyModel.hpp"
+
+#include "sensors/SensorPayloads.hpp"
+#include "sensors/SolarModel.hpp"
+#include "storage/CivilTime.hpp"
+
+#include <optional>
+#include <stdexcept>
+
+namespace
+{
+    void setEnergy(PeriodTotals& totals, const EnergyStats& stats)
+    {
+        totals.energyTotalKWh = stats.E_total;
+        totals.energyPvKWh    = stats.E_pv;
+        totals.energyGridKWh  = stats.E_grid;
+        totals.co2G           = stats.CO2;
+    }
+
+    void accumulate(PeriodTotals& total, const PeriodTotals& part)
+    {
+        total.steps += part.steps;
+        total.sunSteps += part.sunSteps;
+        total.irradiationKWhM2 += part.irradiationKWhM2;
+        total.pvAvailableKWh += part.pvAvailableKWh;
+        total.energyTotalKWh += part.energyTotalKWh;
+        total.energyPvKWh += part.energyPvKWh;
+        total.energyGridKWh += part.energyGridKWh;
+        total.co2G += part.co2G;
+    }
+}
+
+YearSimulator::YearSimulator(const YearSimulationConfig& config)
+    : config(config)
+{
+    if (config.stepSeconds <= 0 || 86400 % config.stepSeconds != 0)
+        throw std::runtime_error("O passo da simulacao precisa dividir o dia em partes iguais (60, 300, 900, 3600 s...).");
+}
+
+YearSimulationResult YearSimulator::run(const WeatherSeries* weather,
+                                        const CarbonIntensityProfile* carbon) const
+{
+    YearSimulationResult result;
+
+    std::optional<WeatherCursor> cursor;
+    if (weather != nullptr)
+        cursor.emplace(*weather);
+
+    std::optional<CarbonIntensityCursor> carbonCursor;
+    if (carbon != nullptr)
+        carbonCursor.emplace(*carbon);
+
+    const bool measured = config.useMeasuredIrradiance;
+    if (measured && (weather == nullptr || weather->globalHorizontalWm2.empty()))
+        throw std::runtime_error("A irradiancia medida precisa de um clima com GHI (arquivo EPW).");
+
+    WeatherImpact clearSky;
+    applyWeatherFactors(clearSky);
+
+    SolarModel solar;
+    const PlaneOfArray plane(config.pv.orientation, &config.pv.horizon);
+
+    const std::int64_t firstDay = daysFromCivil(config.year, 1, 1);
+    const std::int64_t dayCount = daysFromCivil(config.year + 1, 1, 1) - firstDay;
+    const double stepHours = config.stepSeconds / 3600.0;
+
+    // Um EnergyModel por mes: no fim do mes os totais dele ja sao os do mes.
+    int currentMonth = 0;
+    EnergyModel model(config.gridCarbonIntensity);
+
+    for (std::int64_t day = 0; day < dayCount; day++) {
+        int year = 0;
+        int month = 0;
+        int dayOfMonth = 0;
+        civilFromDays(firstDay + day, year, month, dayOfMonth);
+
+        if (month != currentMonth) {
+            if (currentMonth != 0)
+                setEnergy(result.months[currentMonth - 1], model.getStats());
+            model = EnergyModel(config.gridCarbonIntensity);
+            currentMonth = month;
+        }
+
+        PeriodTotals& totals = result.months[month - 1];
+        const int dayOfYear = static_cast<int>(day) + 1;
+
+        // O arquivo de clima tem 365 dias: a data entra pelo mes e dia, e o 29/02
+        // de ano bissexto repete o 28/02.
+        const std::int64_t weatherDay = weatherDayOfYear(month, dayOfMonth) * 86400;
+
+        for (int second = 0; second < 86400; second += config.stepSeconds) {
+            int hour = second / 3600;
+            int minute = (second / 60) % 60;
+
+            // Mesma hora decimal do controller: os segundos nao entram.
+            double irradianceTheoreticalWm2 =
+                solar.computeIrradiance(config.latitude, dayOfYear, hour + minute / 60.0);
+
+            WeatherImpact impact = cursor ? cursor->at(weatherDay + second) : clearSky;
+
+            double irradianceWm2 = irradianceTheoreticalWm2;
+            if (measured) {
+                irradianceWm2 = cursor->globalHorizontalAt(weatherDay + second);
+                impact.cloudFactor = 1.0;
+                impact.rainFactor = 1.0;
+            }
+
+            // Painel inclinado ou com sombra: a GHI (ja com nuvem e chuva) vai para o plano do arranjo.
+            if (!plane.horizontal()) {
+                double ghiWm2 = irradianceWm2 * impact.cloudFactor * impact.rainFactor;
+                SunVector sun = solar.sunVector(config.latitude, dayOfYear, hour + minute / 60.0);
+                irradianceWm2 = plane.transpose(ghiWm2, sun, dayOfYear).totalWm2;
+                impact.cloudFactor = 1.0;
+                impact.rainFactor = 1.0;
+            }
+
+            PanelOutput panel = evaluatePanel(config.pv, impact, irradianceWm2);
+
+            // Com perfil, o passo paga o fator medio da rede durante ele.
+            double carbonIntensity = config.gridCarbonIntensity;
+            if (carbonCursor)
+                carbonIntensity = carbonCursor->average((firstDay + day) * 86400 + second, config.stepSeconds);
+
+            model.update(config.jobPowerKW, panel.pvPowerKW, config.stepSeconds, carbonIntensity);
+
+            totals.steps++;
+            if (panel.pvPowerKW > 0.0)
+                totals.sunSteps++;
+            totals.irradiationKWhM2 += panel.irradianceAdjustedWm2 * stepHours / 1000.0;
+            totals.pvAvailableKWh += panel.pvPowerKW * stepHours;
+        }
+    }
+
+    setEnergy(result.months[currentMonth - 1], model.getStats());
+
+    for (const PeriodTotals& month : result.months)
+        accumulate(result.year, month);
+
+    return result;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "energy/CarbonIntensityProfile.hpp"
+#include "energy/PanelModel.hpp"
+#include "sensors/WeatherSeries.hpp"
+
+#include <cstdint>
+
+// Simulacao de um ano inteiro, passo a passo, num processo so:
+// geometria solar, clima do arquivo, painel, demanda do job e divisao PV-First.
+//
+// E a pergunta de planejamento "o que esta placa faz por este job num ano",
+// sem esperar um ano de relogio. Nada e guardado por passo: cada passo entra
+// direto nos totais do mes, entao a memoria nao cresce com o numero de passos.
+struct YearSimulationConfig
+{
+    int year = 2026;
+    double latitude = -1.4537;
+
+    // Com o painel inclinado (pv.orientation) ou com horizonte (pv.horizon),
+    // a irradiancia de cada passo e a do plano do arranjo.
+    PVConfig pv;
+
+    // Demanda constante do job, o dia todo. 0.25 kW e o job dos resultados de junho.
+    double jobPowerKW = 0.25;
+    double gridCarbonIntensity = 100.0;
+
+    int stepSeconds = 60;
+
+    // Com um clima que traz irradiancia medida (EPW), usa a medida no lugar do
+    // modelo solar com os fatores de nuvem e chuva (que ja estao dentro dela).
+    // Temperatura e vento continuam entrando na eficiencia do painel.
+    bool useMeasuredIrradiance = false;
+};
+
+struct PeriodTotals
+{
+    std::uint64_t steps = 0;
+
+    // Passos com potencia da PV acima de zero.
+    std::uint64_t sunSteps = 0;
+
+    // Irradiancia ajustada integrada no periodo (kWh/m2) e o que a placa podia gerar.
+    double irradiationKWhM2 = 0.0;
+    double pvAvailableKWh   = 0.0;
+
+    double energyTotalKWh = 0.0;
+    double energyPvKWh    = 0.0;
+    double energyGridKWh  = 0.0;
+    double co2G           = 0.0;
+};
+
+struct YearSimulationResult
+{
+    PeriodTotals months[12];
+    PeriodTotals year;
+};
+
+class YearSimulator
+{
+public:
+    explicit YearSimulator(const YearSimulationConfig& config);
+
+    // weather nulo: ceu limpo o ano todo (sem nuvem, sem chuva, 28 C, sem vento).
+    // carbon nulo: o gridCarbonIntensity fixo da config em todos os passos.
+    YearSimulationResult run(const WeatherSeries* weather,
+                             const CarbonIntensityProfile* carbon = nullptr) const;
+
+private:
+    YearSimulationConfig config;
+};
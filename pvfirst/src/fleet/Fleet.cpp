@@ -0,0 +1,157 @@
+#include "Fleet.hpp"
+
+#include "sensors/PlaneOfArray.hpp"
+#include "sensors/SolarModel.hpp"
+#include "storage/CivilTime.hpp"
+#include "storage/CsvScanner.hpp"
+#include "storage/MappedFile.hpp"
+
+#include <charconv>
+#include <stdexcept>
+#include <string_view>
+
+namespace
+{
+    const std::size_t siteColumns = 11;
+
+    bool parseNumber(std::string_view text, double& value)
+    {
+        std::from_chars_result result = std::from_chars(text.data(), text.data() + text.size(), value);
+        return result.ec == std::errc() && result.ptr == text.data() + text.size();
+    }
+
+    // Coluna opcional: vazia ou ausente, fica o valor que ja estava.
+    bool parseOptional(const std::string_view* fields, std::size_t fieldCount, std::size_t column, double& value)
+    {
+        if (column >= fieldCount || fields[column].empty())
+            return true;
+        return parseNumber(fields[column], value);
+    }
+
+    void readOptional(const std::string_view* fields, std::size_t fieldCount, std::size_t column, std::string& value)
+    {
+        if (column < fieldCount && !fields[column].empty())
+            value = std::string(fields[column]);
+    }
+}
+
+std::vector<FleetSite> loadFleetSites(const std::string& path)
+{
+    MappedFile file(path);
+    std::string_view text = file.text();
+
+    std::size_t headerEnd = text.find('\n');
+    if (headerEnd == std::string_view::npos || text.substr(0, headerEnd).find("site;latitude;longitude") != 0)
+        throw std::runtime_error("O arquivo de sitios nao tem o cabecalho site;latitude;longitude: " + path);
+
+    std::vector<FleetSite> sites;
+    sites.reserve(CsvScanner::countLines(text));
+
+    CsvScanner scanner(text.substr(headerEnd + 1));
+    std::string_view fields[siteColumns];
+    std::size_t fieldCount = 0;
+    std::size_t line = 1;
+
+    while (scanner.nextLine(fields, siteColumns, fieldCount)) {
+        line++;
+
+        if (fieldCount == 1 && fields[0].empty())
+            continue;
+
+        FleetSite site;
+        bool valid = fieldCount >= 3 && fieldCount <= siteColumns && !fields[0].empty() &&
+                     parseNumber(fields[1], site.latitude) && parseNumber(fields[2], site.longitude) &&
+                     site.latitude >= -90.0 && site.latitude <= 90.0 &&
+                     site.longitude >= -180.0 && site.longitude <= 180.0 &&
+                     parseOptional(fields, fieldCount, 3, site.pv.panelAreaM2) &&
+                     parseOptional(fields, fieldCount, 4, site.pv.baseEfficiency) &&
+                     parseOptional(fields, fieldCount, 7, site.pv.bifacialGainFactor) &&
+                     parseOptional(fields, fieldCount, 8, site.pv.orientation.tiltDeg) &&
+                     parseOptional(fields, fieldCount, 9, site.pv.orientation.azimuthDeg) &&
+                     site.pv.panelAreaM2 >= 0.0 && site.pv.baseEfficiency >= 0.0 &&
+                     site.pv.orientation.tiltDeg >= 0.0 && site.pv.orientation.tiltDeg <= 90.0;
+
+        if (!valid)
+            throw std::runtime_error("Linha invalida no arquivo de sitios " + path +
+                                     " (linha " + std::to_string(line) + ")");
+
+        site.name = std::string(fields[0]);
+        readOptional(fields, fieldCount, 5, site.pv.panelMaterial);
+        readOptional(fields, fieldCount, 6, site.pv.panelFaceType);
+
+        std::string horizonPath;
+        readOptional(fields, fieldCount, 10, horizonPath);
+        if (!horizonPath.empty())
+            site.pv.horizon = HorizonMask::loadCsv(horizonPath);
+
+        sites.push_back(std::move(site));
+    }
+
+    if (sites.empty())
+        throw std::runtime_error("O arquivo de sitios nao tem nenhum sitio: " + path);
+
+    return sites;
+}
+
+PanelFleet buildPanelFleet(const std::vector<FleetSite>& sites)
+{
+    PanelFleet panels;
+    panels.reserve(sites.size());
+    for (const FleetSite& site : sites)
+        panels.add(site.pv);
+    return panels;
+}
+
+double evaluateFleet(const std::vector<FleetSite>& sites,
+                     const PanelFleet& panels,
+                     std::int64_t utcSeconds,
+                     std::vector<FleetSiteResult>& results)
+{
+    if (results.size() != sites.size() || panels.size() != sites.size())
+        throw std::runtime_error("A frota e os resultados precisam ter o mesmo numero de sitios.");
+
+    SolarModel solar;
+
+    // Primeiro o sol e o clima de cada sitio, em colunas; depois o painel de todos num laco so.
+    std::vector<double> irradianceAdjusted(sites.size());
+    std::vector<double> weatherFactors(sites.size());
+    std::vector<double> powers(sites.size());
+
+    for (std::size_t i = 0; i < sites.size(); i++) {
+        const FleetSite& site = sites[i];
+        FleetSiteResult& result = results[i];
+
+        // Hora solar media: 4 minutos por grau de longitude a partir de Greenwich.
+        std::int64_t solarSeconds = utcSeconds + static_cast<std::int64_t>(site.longitude * 240.0);
+        std::int64_t days = floorDiv(solarSeconds, 86400);
+
+        int year = 0;
+        int month = 0;
+        int day = 0;
+        civilFromDays(days, year, month, day);
+        int dayOfYear = static_cast<int>(days - daysFromCivil(year, 1, 1)) + 1;
+
+        result.solarHour = static_cast<double>(solarSeconds - days * 86400) / 3600.0;
+        result.irradianceTheoreticalWm2 = solar.computeIrradiance(site.latitude, dayOfYear, result.solarHour);
+
+        irradianceAdjusted[i] = result.irradianceTheoreticalWm2 * result.impact.cloudFactor * result.impact.rainFactor;
+
+        PlaneOfArray plane(site.pv.orientation, &site.pv.horizon);
+        if (!plane.horizontal()) {
+            SunVector sun = solar.sunVector(site.latitude, dayOfYear, result.solarHour);
+            irradianceAdjusted[i] = plane.transpose(irradianceAdjusted[i], sun, dayOfYear).totalWm2;
+        }
+        weatherFactors[i] = result.impact.tempFactor * result.impact.windCoolingFactor;
+    }
+
+    double totalKW = panels.evaluate(irradianceAdjusted.data(), weatherFactors.data(), powers.data());
+
+    for (std::size_t i = 0; i < sites.size(); i++) {
+        FleetSiteResult& result = results[i];
+        result.irradianceAdjustedWm2 = irradianceAdjusted[i];
+        result.pvEfficiency = panels.efficiency(i) * weatherFactors[i];
+        result.pvPowerKW = powers[i];
+    }
+
+    return totalKW;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "energy/PanelFleet.hpp"
+#include "energy/PanelModel.hpp"
+#include "sensors/SensorState.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Um sitio da frota: onde ele fica e qual painel tem la.
+struct FleetSite
+{
+    std::string name;
+    double latitude = 0.0;
+    double longitude = 0.0;
+    PVConfig pv;
+};
+
+// Le o arquivo de sitios, um por linha, com cabecalho:
+//
+//   site;latitude;longitude;panel_area_m2;base_efficiency;panel_material;panel_face_type;bifacial_gain;tilt_deg;azimuth_deg;horizon_file
+//   belem;-1.4558;-48.4902;10;0.20;monocrystalline;monofacial;1.10;10;0;belem_horizonte.csv
+//
+// So as tres primeiras colunas sao obrigatorias; as do painel que faltarem
+// (ou vierem vazias) ficam com o valor padrao do PVConfig (deitado, sem sombra).
+// horizon_file e uma mascara de horizonte (ver PlaneOfArray.hpp), relativa a
+// pasta de onde o programa roda.
+std::vector<FleetSite> loadFleetSites(const std::string& path);
+
+// Resultado de um sitio numa passada.
+struct FleetSiteResult
+{
+    WeatherImpact impact;
+    SensorSource weatherSource = SensorSource::None;
+
+    // Hora solar media do sitio (0 a 24), a que entra no SolarModel.
+    double solarHour = 0.0;
+
+    double irradianceTheoreticalWm2 = 0.0;
+
+    // Com nuvem e chuva; no plano do painel quando ele e inclinado ou tem horizonte.
+    double irradianceAdjustedWm2 = 0.0;
+    double pvEfficiency = 0.0;
+    double pvPowerKW = 0.0;
+};
+
+// Os paineis da frota em colunas, na mesma ordem do arquivo de sitios.
+// Monto uma vez so por execucao: o texto do material e da face nao muda entre passadas.
+PanelFleet buildPanelFleet(const std::vector<FleetSite>& sites);
+
+// Passada unica pela frota inteira no instante utcSeconds.
+//
+// Os sitios podem estar em fusos diferentes, entao a hora de cada um nao e
+// a da maquina: e a hora solar media da longitude (UTC + longitude / 15).
+// results precisa ter um item por sitio, com impact e weatherSource ja preenchidos.
+// Devolve a potencia PV somada de todos os sitios.
+double evaluateFleet(const std::vector<FleetSite>& sites,
+                     const PanelFleet& panels,
+                     std::int64_t utcSeconds,
+                     std::vector<FleetSiteResult>& results);
@@ -1,17 +1,1313 @@
+#include "energy/YearSimulator.hpp"
+#include "fleet/Fleet.hpp"
+#include "metrics/Metrics.hpp"
+#include "query/Query.hpp"
+#include "sensors/IrradianceStream.hpp"
+#include "sensors/MetarReport.hpp"
+#include "sensors/RampDetector.hpp"
+#include "sensors/SensorFallback.hpp"
+#include "sensors/SensorPayloads.hpp"
+#include "sensors/SensorState.hpp"
+#include "sensors/SolarModel.hpp"
+#include "simulation/PlatformBuilder.hpp"
+#include "simulation/SimGridJobRunner.hpp"
 #include "simulation/SimulationController.hpp"
+#include "storage/CivilTime.hpp"
+#include "storage/EventLog.hpp"
+#include "storage/FleetCsvWriter.hpp"
+#include "storage/ResultsArchive.hpp"
+#include "storage/ResultsCsvReader.hpp"
+#include "storage/ResultsCsvWriter.hpp"
 
+#include <simgrid/plugins/energy.h>
+#include <simgrid/s4u.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
 #include <exception>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
 #include <xbt/log.h>
 
-int main()
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace
+{
+    void printUsage()
+    {
+        std::cerr << "Uso:\n";
+        std::cerr << "  pvfirst [--timing] [--event-log arquivo] [--output modo]\n";
+        std::cerr << "      roda uma simulacao PV-First com o job do SimGrid\n";
+        std::cerr << "  pvfirst daemon [intervalo_s] [--janela-solar] [--timing] [--metrics arquivo.prom] [--event-log arquivo] [--output modo]\n";
+        std::cerr << "      fica rodando e repete a simulacao a cada intervalo (padrao 60 s), sem perguntar o job\n";
+        std::cerr << "  pvfirst log <arquivo> [--tipo ok|sem_irradiancia|falha] [--desde AAAA-MM-DD] [--ultimos N]\n";
+        std::cerr << "      decodifica e filtra o log de eventos binario\n";
+        std::cerr << "  pvfirst archive <arquivo.csv|pasta>...\n";
+        std::cerr << "      compacta os dias ja encerrados em RPVfirstDDMMAA.pva, ao lado do CSV\n";
+        std::cerr << "  pvfirst unarchive <arquivo.pva> [saida.csv]\n";
+        std::cerr << "      reescreve o CSV original a partir do arquivo compactado\n";
+        std::cerr << "  pvfirst query [--dados pasta] \"select ... [where ...] [group by ...]\"\n";
+        std::cerr << "      agrega o historico de resultados (padrao: pasta results), ex.:\n";
+        std::cerr << "      \"select share(energy_pv_kwh, energy_total_kwh) where month = 6 group by day\"\n";
+        std::cerr << "  pvfirst fleet <sitios.csv> [intervalo_s]\n";
+        std::cerr << "      potencia PV de varios sitios (site;latitude;longitude[;painel...][;inclinacao;azimute;horizonte]),\n";
+        std::cerr << "      com o clima de todos\n";
+        std::cerr << "      em consultas de ate 100 sitios; uma linha por sitio em results/FPVfirstDDMMAA.csv\n";
+        std::cerr << "  pvfirst metar <arquivo|pasta> [--estacao ICAO]\n";
+        std::cerr << "      decodifica METAR (um por linha, NOAA ou CSV); com --estacao, sai no formato do --clima\n";
+        std::cerr << "  pvfirst simulate-year [--ano AAAA] [--clima arquivo.csv|.epw] [--ghi-medido] [--lat graus] [--carga kW] [--passo s]\n";
+        std::cerr << "      simula o ano inteiro minuto a minuto (sem rede nem SimGrid) e mostra os totais por mes\n";
+        std::cerr << "      com EPW, a latitude vem do arquivo e --ghi-medido usa a irradiancia medida\n";
+        std::cerr << "  pvfirst bench-simgrid [execucoes] [nos]\n";
+        std::cerr << "      mede o custo fixo de cada simulacao do SimGrid, primeira execucao contra as seguintes;\n";
+        std::cerr << "      com nos, usa uma estrela montada em codigo no lugar do platform.xml\n";
+        std::cerr << "  pvfirst platform <star|fattree|dragonfly> <nos|topo_parameters> [saida.xml]\n";
+        std::cerr << "      monta um cluster em codigo e compara com o load_platform do XML equivalente;\n";
+        std::cerr << "      com saida.xml, o XML fica salvo\n";
+        std::cerr << "\n";
+        std::cerr << "  --timing     salva o tempo de cada etapa em results/TPVfirstDDMMAA.csv\n";
+        std::cerr << "  --metrics    no daemon, reescreve o arquivo com as metricas no formato do Prometheus a cada 15 s\n";
+        std::cerr << "  --event-log  registra cada execucao num log binario de tamanho fixo\n";
+        std::cerr << "  --output     texto (padrao), jsonl (uma linha JSON por execucao) ou silencioso\n";
+        std::cerr << "  --prazo      segundos para local e clima em cada execucao (padrao 20); passou disso,\n";
+        std::cerr << "               vale a previsao guardada, o ultimo valor bom ou o ceu limpo\n";
+        std::cerr << "  --metar      arquivo ou pasta de METAR; relatorio recente (ate 90 min) da estacao\n";
+        std::cerr << "               --estacao-metar (padrao SBBE) vem antes da API de clima\n";
+        std::cerr << "  --stream     no daemon, le o medidor local (1 Hz ou mais) de um FIFO, de um arquivo\n";
+        std::cerr << "               que cresce ou de unix:/caminho; uma amostra por linha, \"[timestamp;]valor\"\n";
+        std::cerr << "  --stream-tipo   irradiancia (W/m2, padrao) ou potencia (kW do inversor)\n";
+        std::cerr << "  --stream-janela segundos da media do medidor usada em cada execucao (padrao 10)\n";
+        std::cerr << "  --rampa      variacao do medidor que conta como borda de nuvem (padrao 0.3; 0 desliga);\n";
+        std::cerr << "               cada rampa antecipa uma execucao extra do daemon, no maximo uma a cada 5 s\n";
+        std::cerr << "  --rampa-janela  segundos olhados para tras pelo detector de rampas (padrao 30)\n";
+        std::cerr << "  --rampa-minimo  abaixo disso nao conta rampa, na unidade do medidor (padrao 50 W/m2,\n";
+        std::cerr << "               ou na potencia o que o arranjo daria com 50 W/m2)\n";
+        std::cerr << "  --inclinacao, --azimute, --albedo  orientacao do painel (graus; azimute 0 = norte, 90 = leste)\n";
+        std::cerr << "               e refletancia do chao; com inclinacao, a irradiancia e a do plano do painel\n";
+        std::cerr << "  --horizonte  mascara de obstrucoes (azimuth;elevation[;elevation_base]); tapa o sol direto\n";
+        std::cerr << "               e parte do ceu; vale para a execucao, o daemon e o simulate-year\n";
+        std::cerr << "  --janela-solar  no daemon, calcula o nascer e o por do sol util do dia (SolarModel, no ultimo\n";
+        std::cerr << "               local bom dos sensores) e dorme fora dele, sem nenhuma execucao\n";
+        std::cerr << "  --carbono    perfil do fator da rede (datetime;gco2_kwh, por hora ou a cada 5 min);\n";
+        std::cerr << "               o CO2 de cada job e cobrado pela media do fator enquanto ele rodou\n";
+    }
+
+    // Opcoes que nao sao da simulacao em si, e sim do processo.
+    struct ProcessOptions
+    {
+        std::string metricsPath;
+        int metricsIntervalSeconds = 15;
+
+        std::string eventLogPath;
+
+        // Medidor local de irradiancia ou potencia (so no daemon).
+        std::string streamSource;
+        StreamQuantity streamQuantity = StreamQuantity::Irradiance;
+
+        // Deteccao de rampas no medidor; thresholdFraction zero desliga.
+        // Sem --rampa-minimo, o piso sai do tipo do medidor (ver rampMinimumLevel).
+        RampConfig ramp;
+        bool rampMinimumGiven = false;
+
+        // Daemon so dentro do periodo com sol util do dia (ver sleepUntilSolarWindow).
+        bool solarWindow = false;
+    };
+
+    // Sitios por consulta ao open-meteo no modo frota: a URL fica na casa de 2 a 3 KB.
+    const std::size_t fleetBatchSize = 100;
+
+    // No maximo uma execucao extra por rampa a cada rampTickMinGap.
+    const std::chrono::seconds rampTickMinGap{5};
+
+    // Tira as opcoes "--alguma-coisa" da lista de argumentos e aplica na config.
+    // O que sobra sao o comando e os parametros posicionais dele.
+    std::vector<std::string> applyOptions(const std::vector<std::string>& args,
+                                          SimulationConfig& config,
+                                          ProcessOptions& options)
+    {
+        std::vector<std::string> positional;
+
+        for (std::size_t i = 0; i < args.size(); i++) {
+            const std::string& arg = args[i];
+
+            if (arg == "--timing") {
+                config.stageTiming = true;
+            }
+            else if (arg == "--metrics") {
+                if (i + 1 >= args.size())
+                    throw std::runtime_error("A opcao --metrics precisa do caminho do arquivo.");
+                options.metricsPath = args[++i];
+            }
+            else if (arg == "--event-log") {
+                if (i + 1 >= args.size())
+                    throw std::runtime_error("A opcao --event-log precisa do caminho do arquivo.");
+                options.eventLogPath = args[++i];
+            }
+            else if (arg == "--prazo") {
+                if (i + 1 >= args.size())
+                    throw std::runtime_error("A opcao --prazo precisa do tempo em segundos.");
+                config.tickDeadlineSeconds = std::stod(args[++i]);
+                if (config.tickDeadlineSeconds <= 0.0)
+                    throw std::runtime_error("O prazo da execucao precisa ser maior que zero.");
+            }
+            else if (arg == "--metar") {
+                if (i + 1 >= args.size())
+                    throw std::runtime_error("A opcao --metar precisa do arquivo ou da pasta com os relatorios.");
+                config.metarFeedPath = args[++i];
+            }
+            else if (arg == "--estacao-metar") {
+                if (i + 1 >= args.size())
+                    throw std::runtime_error("A opcao --estacao-metar precisa do codigo ICAO (ex.: SBBE).");
+                config.metarStation = args[++i];
+            }
+            else if (arg == "--stream") {
+                if (i + 1 >= args.size())
+                    throw std::runtime_error("A opcao --stream precisa do FIFO, do arquivo ou de unix:/caminho do socket.");
+                options.streamSource = args[++i];
+            }
+            else if (arg == "--stream-tipo") {
+                if (i + 1 >= args.size() || !parseStreamQuantity(args[i + 1], options.streamQuantity))
+                    throw std::runtime_error("A opcao --stream-tipo aceita irradiancia ou potencia.");
+                i++;
+            }
+            else if (arg == "--stream-janela") {
+                if (i + 1 >= args.size())
+                    throw std::runtime_error("A opcao --stream-janela precisa do tempo em segundos.");
+                config.streamWindowSeconds = std::stod(args[++i]);
+                if (config.streamWindowSeconds <= 0.0)
+                    throw std::runtime_error("A janela do medidor local precisa ser maior que zero.");
+            }
+            else if (arg == "--rampa") {
+                if (i + 1 >= args.size())
+                    throw std::runtime_error("A opcao --rampa precisa da variacao minima (ex.: 0.3 para 30%).");
+                options.ramp.thresholdFraction = std::stod(args[++i]);
+                if (options.ramp.thresholdFraction < 0.0 || options.ramp.thresholdFraction >= 1.0)
+                    throw std::runtime_error("A variacao da rampa precisa ficar entre 0 (desligada) e 1.");
+            }
+            else if (arg == "--rampa-janela") {
+                if (i + 1 >= args.size())
+                    throw std::runtime_error("A opcao --rampa-janela precisa do tempo em segundos.");
+                options.ramp.windowSeconds = std::stod(args[++i]);
+                if (options.ramp.windowSeconds < 0.001)
+                    throw std::runtime_error("A janela da rampa precisa ter pelo menos 1 ms.");
+            }
+            else if (arg == "--rampa-minimo") {
+                if (i + 1 >= args.size())
+                    throw std::runtime_error("A opcao --rampa-minimo precisa do nivel minimo (W/m2 ou kW, a unidade do medidor).");
+                options.ramp.minimumLevel = std::stod(args[++i]);
+                options.rampMinimumGiven = true;
+                if (options.ramp.minimumLevel < 0.0)
+                    throw std::runtime_error("O nivel minimo da rampa nao pode ser negativo.");
+            }
+            else if (arg == "--inclinacao" || arg == "--azimute" || arg == "--albedo") {
+                if (i + 1 >= args.size())
+                    throw std::runtime_error("A opcao " + arg + " precisa de um valor.");
+                double value = std::stod(args[++i]);
+                if (arg == "--inclinacao") {
+                    if (value < 0.0 || value > 90.0)
+                        throw std::runtime_error("A inclinacao do painel precisa ficar entre 0 e 90 graus.");
+                    config.pv.orientation.tiltDeg = value;
+                }
+                else if (arg == "--azimute") {
+                    config.pv.orientation.azimuthDeg = value;
+                }
+                else {
+                    config.pv.orientation.albedo = value;
+                }
+            }
+            else if (arg == "--horizonte") {
+                if (i + 1 >= args.size())
+                    throw std::runtime_error("A opcao --horizonte precisa do arquivo azimuth;elevation.");
+                config.pv.horizon = HorizonMask::loadCsv(args[++i]);
+            }
+            else if (arg == "--janela-solar") {
+                options.solarWindow = true;
+            }
+            else if (arg == "--carbono") {
+                if (i + 1 >= args.size())
+                    throw std::runtime_error("A opcao --carbono precisa do caminho do arquivo.");
+                config.carbonProfilePath = args[++i];
+            }
+            else if (arg == "--output") {
+                if (i + 1 >= args.size() || !parseOutputMode(args[i + 1], config.output))
+                    throw std::runtime_error("A opcao --output aceita texto, jsonl ou silencioso.");
+                i++;
+            }
+            else {
+                positional.push_back(arg);
+            }
+        }
+
+        return positional;
+    }
+
+    std::unique_ptr<EventLog> openEventLog(const ProcessOptions& options)
+    {
+        if (options.eventLogPath.empty())
+            return nullptr;
+        return std::make_unique<EventLog>(options.eventLogPath);
+    }
+
+    // Uma execucao que terminou com erro tambem vira evento, so com a hora.
+    void recordFailure(EventLog* eventLog)
+    {
+        if (eventLog == nullptr)
+            return;
+
+        EventRecord event;
+        event.timestamp = static_cast<std::int64_t>(std::time(nullptr));
+        event.type      = static_cast<std::uint16_t>(EventType::TickFailed);
+        eventLog->append(event);
+    }
+
+    // Uma simulacao so, do jeito original (o run.sh chama assim).
+    void runSingleCommand(const SimulationConfig& config, const ProcessOptions& options)
+    {
+        std::unique_ptr<EventLog> eventLog = openEventLog(options);
+
+        try {
+            SimulationController controller(config);
+            controller.setEventLog(eventLog.get());
+            controller.run();
+        }
+        catch (...) {
+            recordFailure(eventLog.get());
+            throw;
+        }
+    }
+
+    // Minuto local (0 a 1439) de um dia, como time_t. O mktime resolve dia que passa
+    // do fim do mes e horario de verao.
+    std::time_t localMinute(std::tm day, int minuteOfDay)
+    {
+        day.tm_hour = minuteOfDay / 60;
+        day.tm_min = minuteOfDay % 60;
+        day.tm_sec = 0;
+        day.tm_isdst = -1;
+        return std::mktime(&day);
+    }
+
+    // Se agora esta fora do periodo com sol util, dorme ate o comeco do proximo.
+    // Devolve true se dormiu.
+    //
+    // O periodo e o do SolarModel no ultimo local bom dos sensores (ou no padrao),
+    // com o mesmo minimo do controller. O controller olha a hora em minutos
+    // inteiros, entao o periodo vai do primeiro minuto inteiro acima do minimo ate
+    // o fim do ultimo. Nuvem so tira irradiancia: fora do periodo o controller
+    // pararia em sem_irradiancia de qualquer jeito.
+    bool sleepUntilSolarWindow(const SimulationConfig& config)
+    {
+        SensorState state = SensorState::load((std::filesystem::path(config.resultsDir) / "SPVfirst_sensores.txt").string());
+        double latitude = state.hasLocation ? state.location.latitude : GPSData{}.latitude;
+
+        std::time_t now = std::time(nullptr);
+        std::tm today = *std::localtime(&now);
+
+        SolarModel solar;
+
+        // Sem sol nenhum num dia (noite polar), passa para o seguinte.
+        for (int offset = 0; offset <= 366; offset++) {
+            std::tm day = today;
+            day.tm_mday += offset;
+            day.tm_hour = 12;
+            day.tm_min = 0;
+            day.tm_sec = 0;
+            day.tm_isdst = -1;
+            std::mktime(&day);
+
+            double firstHour = 0.0;
+            double lastHour = 0.0;
+            if (!solar.solarWindow(latitude, day.tm_yday + 1,
+                                   SimulationController::irradianceMinimumToRun, firstHour, lastHour))
+                continue;
+
+            // Minutos do dia local, de 0 a 1439 (o from/to abaixo conta com isso).
+            int firstMinute = std::clamp(static_cast<int>(std::ceil(firstHour * 60.0)), 0, 1439);
+            int lastMinute = std::clamp(static_cast<int>(std::floor(lastHour * 60.0)), 0, 1439);
+            if (firstMinute > lastMinute)
+                continue;
+
+            std::time_t start = localMinute(day, firstMinute);
+            std::time_t end = localMinute(day, lastMinute) + 60;
+            if (now >= end)
+                continue;
+            if (now >= start)
+                return false;
+
+            char from[8];
+            char to[8];
+            std::snprintf(from, sizeof(from), "%02d:%02d", firstMinute / 60, firstMinute % 60);
+            std::snprintf(to, sizeof(to), "%02d:%02d", lastMinute / 60, lastMinute % 60);
+            std::cerr << "Fora do periodo solar (latitude " << latitude << "): o proximo vai de "
+                      << from << " a " << to << (offset == 0 ? " de hoje" : offset == 1 ? " de amanha" : "")
+                      << "; dormindo " << (start - now) / 60 << " min.\n";
+
+            std::this_thread::sleep_until(std::chrono::system_clock::from_time_t(start));
+            return true;
+        }
+
+        throw std::runtime_error("Nenhum periodo com sol util no proximo ano nesta latitude.");
+    }
+
+    // Aqui o processo fica vivo e roda uma simulacao por intervalo.
+    // Como o Engine do SimGrid fica em cache no processo, so a primeira execucao
+    // paga a carga da plataforma.
+    int runDaemonCommand(const std::vector<std::string>& args,
+                         SimulationConfig config,
+                         const ProcessOptions& options)
+    {
+        int intervalSeconds = 60;
+        if (args.size() > 1)
+            intervalSeconds = std::stoi(args[1]);
+
+        if (intervalSeconds <= 0)
+            throw std::runtime_error("O intervalo do daemon precisa ser maior que zero.");
+
+        config.askJobInput = false;
+
+        // O exportador escreve o arquivo de metricas na thread dele.
+        // As execucoes so mexem em contadores atomicos e nunca esperam por ele.
+        std::unique_ptr<EventLog> eventLog = openEventLog(options);
+
+        std::unique_ptr<MetricsFileExporter> exporter;
+        if (!options.metricsPath.empty())
+            exporter = std::make_unique<MetricsFileExporter>(options.metricsPath,
+                                                             options.metricsIntervalSeconds);
+
+        // A leitura do medidor tambem roda na thread dela, o processo inteiro:
+        // o controller de cada execucao so drena o que chegou desde a anterior.
+        // O detector de rampas olha cada amostra ainda na thread do medidor
+        // e acorda o laco abaixo pelo rampSignal.
+        RampConfig detectorConfig = options.ramp;
+        if (!options.rampMinimumGiven) {
+            double peakKW = config.pv.panelAreaM2 * config.pv.baseEfficiency;
+            detectorConfig.minimumLevel = rampMinimumLevel(options.streamQuantity, peakKW);
+        }
+        RampDetector rampDetector(detectorConfig);
+        RampSignal rampSignal;
+
+        std::unique_ptr<IrradianceStream> stream;
+        if (!options.streamSource.empty()) {
+            StreamCallback onSample = nullptr;
+            if (options.ramp.thresholdFraction > 0.0) {
+                onSample = [&rampDetector, &rampSignal](const StreamSample& sample) {
+                    RampEvent ramp;
+                    if (!rampDetector.observe(sample, ramp))
+                        return;
+
+                    if (ramp.direction == RampDirection::Up)
+                        metrics().rampUps.inc();
+                    else
+                        metrics().rampDowns.inc();
+                    rampSignal.post(ramp);
+                };
+            }
+            stream = std::make_unique<IrradianceStream>(options.streamSource, options.streamQuantity, onSample);
+        }
+
+        auto runTick = [&](const SimulationConfig& tickConfig) {
+            try {
+                // Um controller novo por execucao: cada linha do CSV continua
+                // representando so o intervalo daquele job, igual ao modo normal.
+                SimulationController controller(tickConfig);
+                controller.setEventLog(eventLog.get());
+                controller.setIrradianceStream(stream.get());
+                controller.run();
+            }
+            catch (const std::exception& e) {
+                metrics().tickFailures.inc();
+                recordFailure(eventLog.get());
+                std::cerr << "Falha nesta execucao do daemon: " << e.what() << "\n";
+            }
+        };
+
+        SimulationConfig rampConfig = config;
+
+        // Eu agendo pelo relogio monotonico para a cadencia nao escorregar
+        // com o tempo gasto em cada execucao.
+        auto nextTick = std::chrono::steady_clock::now();
+        auto lastRampTick = nextTick - rampTickMinGap;
+
+        while (true) {
+            // Depois de dormir a noite, a cadencia recomeca do despertar. Uma rampa
+            // que ficou pendente do fim da tarde anterior nao vale mais nada.
+            if (options.solarWindow && sleepUntilSolarWindow(config)) {
+                nextTick = std::chrono::steady_clock::now();
+                rampSignal.clear();
+            }
+
+            runTick(config);
+            nextTick += std::chrono::seconds(intervalSeconds);
+
+            // Ate a proxima execucao da cadencia, uma rampa no medidor antecipa
+            // uma execucao extra, para a divisao PV/rede seguir a borda da nuvem.
+            // Nuvem picotada (rampa atras de rampa) vira no maximo uma extra por rampTickMinGap,
+            // e nenhuma quando a execucao normal ja vem antes disso.
+            RampEvent ramp;
+            while (rampSignal.waitUntil(nextTick, ramp)) {
+                auto earliest = lastRampTick + rampTickMinGap;
+                if (earliest >= nextTick)
+                    continue;
+
+                std::cerr << "Rampa de " << rampDirectionName(ramp.direction) << " no medidor: "
+                          << ramp.from << " -> " << ramp.to << " em "
+                          << static_cast<double>(ramp.endNs - ramp.startNs) / 1e9 << " s; reavaliando agora.\n";
+
+                std::this_thread::sleep_until(earliest);
+                lastRampTick = std::chrono::steady_clock::now();
+
+                // Na execucao extra, a media do medidor comeca na amostra que fechou a rampa:
+                // com a janela normal, o valor de antes da borda ainda pesaria na conta.
+                std::int64_t nowNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::system_clock::now().time_since_epoch()).count();
+                double sinceRamp = std::max(static_cast<double>(nowNs - ramp.endNs) / 1e9, 0.0);
+                rampConfig.streamWindowSeconds = std::min(config.streamWindowSeconds, sinceRamp + 0.001);
+
+                metrics().rampTicks.inc();
+                runTick(rampConfig);
+            }
+        }
+    }
+
+    // Aqui eu leio o log de eventos binario e mostro uma linha por execucao.
+    // Os filtros sao opcionais e podem ser combinados.
+    int runLogCommand(const std::vector<std::string>& args)
+    {
+        if (args.size() < 2) {
+            printUsage();
+            return 1;
+        }
+
+        bool filterType = false;
+        EventType type = EventType::TickOk;
+        std::int64_t since = 0;
+        std::size_t last = 0;
+
+        for (std::size_t i = 2; i < args.size(); i++) {
+            if (i + 1 >= args.size())
+                throw std::runtime_error("A opcao " + args[i] + " precisa de um valor.");
+
+            const std::string& option = args[i];
+            const std::string& value = args[++i];
+
+            if (option == "--tipo") {
+                if (!parseEventType(value, type))
+                    throw std::runtime_error("Tipo de evento desconhecido: " + value);
+                filterType = true;
+            }
+            else if (option == "--desde") {
+                std::tm day{};
+                if (std::sscanf(value.c_str(), "%d-%d-%d", &day.tm_year, &day.tm_mon, &day.tm_mday) != 3)
+                    throw std::runtime_error("Data invalida em --desde (use AAAA-MM-DD): " + value);
+                day.tm_year -= 1900;
+                day.tm_mon -= 1;
+                day.tm_isdst = -1;
+                since = static_cast<std::int64_t>(std::mktime(&day));
+            }
+            else if (option == "--ultimos") {
+                last = static_cast<std::size_t>(std::stoul(value));
+            }
+            else {
+                throw std::runtime_error("Opcao desconhecida no comando log: " + option);
+            }
+        }
+
+        EventLogReader reader(args[1]);
+
+        std::vector<std::string> lines;
+        reader.forEach([&](const EventRecord& record) {
+            if (filterType && record.type != static_cast<std::uint16_t>(type))
+                return;
+            if (record.timestamp < since)
+                return;
+
+            lines.push_back(EventLogReader::format(record));
+        });
+
+        std::size_t first = (last > 0 && lines.size() > last) ? lines.size() - last : 0;
+        for (std::size_t i = first; i < lines.size(); i++)
+            std::cout << lines[i] << "\n";
+
+        return 0;
+    }
+
+    // Confere se o .pva devolve exatamente as mesmas linhas do CSV.
+    bool archiveMatchesCsv(const std::string& archivePath, const std::string& csvPath)
+    {
+        ResultsCsvReader csv(csvPath);
+        ResultsArchiveReader archive(archivePath);
+
+        ResultRow csvRow;
+        ResultRow archiveRow;
+        std::string csvText;
+        std::string archiveText;
+
+        while (csv.next(csvRow)) {
+            if (!archive.next(archiveRow))
+                return false;
+
+            csvText.clear();
+            archiveText.clear();
+            ResultsCsvWriter::appendRow(csvText, csvRow);
+            ResultsCsvWriter::appendRow(archiveText, archiveRow);
+
+            if (csvText != archiveText)
+                return false;
+        }
+
+        return !archive.next(archiveRow);
+    }
+
+    // Compacta um CSV do dia. O CSV fica onde esta: quem apaga e quem decide.
+    void archiveOneCsv(const std::filesystem::path& csvPath)
+    {
+        std::filesystem::path archivePath = csvPath;
+        archivePath.replace_extension(".pva");
+
+        auto start = std::chrono::steady_clock::now();
+        std::size_t rows = ResultsArchiveWriter::archiveCsv(csvPath.string(), archivePath.string());
+        auto finish = std::chrono::steady_clock::now();
+
+        if (!archiveMatchesCsv(archivePath.string(), csvPath.string())) {
+            std::filesystem::remove(archivePath);
+            throw std::runtime_error("O arquivo compactado nao bateu com o CSV: " + csvPath.string());
+        }
+
+        double csvBytes = static_cast<double>(std::filesystem::file_size(csvPath));
+        double archiveBytes = static_cast<double>(std::filesystem::file_size(archivePath));
+
+        std::cout << archivePath.string() << ": " << rows << " linhas, "
+                  << csvBytes / 1024.0 << " KB -> " << archiveBytes / 1024.0 << " KB ("
+                  << 100.0 * archiveBytes / csvBytes << " %), "
+                  << std::chrono::duration<double, std::milli>(finish - start).count() << " ms\n";
+    }
+
+    // Com uma pasta, eu compacto todo RPVfirst*.csv que ainda nao tem .pva mais novo.
+    // O arquivo de hoje fica de fora: o dia ainda nao terminou.
+    int runArchiveCommand(const std::vector<std::string>& args)
+    {
+        if (args.size() < 2) {
+            printUsage();
+            return 1;
+        }
+
+        std::time_t now = std::time(nullptr);
+        ResultRow today;
+        std::tm localTime = *std::localtime(&now);
+        today.year = localTime.tm_year + 1900;
+        today.month = localTime.tm_mon + 1;
+        today.day = localTime.tm_mday;
+        std::string todayFile = ResultsCsvWriter::dailyFileName(today);
+
+        int failures = 0;
+
+        for (std::size_t i = 1; i < args.size(); i++) {
+            std::vector<std::filesystem::path> csvFiles;
+
+            if (std::filesystem::is_directory(args[i])) {
+                for (const auto& entry : std::filesystem::directory_iterator(args[i])) {
+                    std::string name = entry.path().filename().string();
+                    if (name.rfind("RPVfirst", 0) != 0 || entry.path().extension() != ".csv" || name == todayFile)
+                        continue;
+
+                    std::filesystem::path archivePath = entry.path();
+                    archivePath.replace_extension(".pva");
+                    if (std::filesystem::exists(archivePath) &&
+                        std::filesystem::last_write_time(archivePath) >= entry.last_write_time())
+                        continue;
+
+                    csvFiles.push_back(entry.path());
+                }
+            }
+            else {
+                csvFiles.push_back(args[i]);
+            }
+
+            for (const auto& csvPath : csvFiles) {
+                try {
+                    archiveOneCsv(csvPath);
+                }
+                catch (const std::exception& e) {
+                    std::cerr << "Nao compactei " << csvPath.string() << ": " << e.what() << "\n";
+                    failures++;
+                }
+            }
+        }
+
+        return failures == 0 ? 0 : 1;
+    }
+
+    int runUnarchiveCommand(const std::vector<std::string>& args)
+    {
+        if (args.size() < 2) {
+            printUsage();
+            return 1;
+        }
+
+        std::filesystem::path csvPath = args[1];
+        csvPath.replace_extension(".csv");
+        if (args.size() > 2)
+            csvPath = args[2];
+
+        if (args.size() <= 2 && std::filesystem::exists(csvPath))
+            throw std::runtime_error("O CSV ja existe, informe outro caminho de saida: " + csvPath.string());
+
+        std::size_t rows = ResultsArchiveReader::restoreCsv(args[1], csvPath.string());
+        std::cout << csvPath.string() << ": " << rows << " linhas\n";
+        return 0;
+    }
+
+    // Aqui eu carrego o historico por coluna e rodo a consulta em cima dele.
+    // A tabela sai no stdout separada por ';' e o tempo de cada parte vai para o stderr.
+    int runQueryCommand(const std::vector<std::string>& args)
+    {
+        std::string directory = "results";
+        std::string text;
+
+        for (std::size_t i = 1; i < args.size(); i++) {
+            if (args[i] == "--dados") {
+                if (i + 1 >= args.size())
+                    throw std::runtime_error("A opcao --dados precisa do caminho da pasta.");
+                directory = args[++i];
+            }
+            else if (text.empty()) {
+                text = args[i];
+            }
+            else {
+                text += " " + args[i];
+            }
+        }
+
+        if (text.empty()) {
+            printUsage();
+            return 1;
+        }
+
+        // Consulta errada para aqui, antes de ler o historico inteiro.
+        Query query = Query::parse(text);
+
+        auto loadStart = std::chrono::steady_clock::now();
+        ResultColumns columns = ResultColumns::loadHistory(directory, std::cerr);
+        auto queryStart = std::chrono::steady_clock::now();
+        QueryResult result = runQuery(query, columns);
+        auto queryFinish = std::chrono::steady_clock::now();
+
+        for (std::size_t i = 0; i < result.headers.size(); i++)
+            std::cout << (i == 0 ? "" : ";") << result.headers[i];
+        std::cout << "\n";
+
+        char number[32];
+        for (std::size_t g = 0; g < result.groups.size(); g++) {
+            std::cout << result.groups[g];
+            for (double value : result.values[g]) {
+                if (std::isnan(value))
+                    std::cout << ";";
+                else {
+                    std::snprintf(number, sizeof(number), "%g", value);
+                    std::cout << ";" << number;
+                }
+            }
+            std::cout << "\n";
+        }
+
+        std::cerr << columns.rowCount() << " linhas carregadas em "
+                  << std::chrono::duration<double, std::milli>(queryStart - loadStart).count() << " ms, "
+                  << result.matchedRows << " passaram no filtro, consulta em "
+                  << std::chrono::duration<double, std::milli>(queryFinish - queryStart).count() << " ms\n";
+        return 0;
+    }
+
+    // Uma passada pela frota: clima de todos os sitios em poucas consultas,
+    // painel de todos numa passada so e uma linha por sitio no CSV da frota.
+    // Sitio sem clima nesta passada usa o ultimo clima bom dele (ate 3 h) ou ceu limpo.
+    void runFleetPass(const std::vector<FleetSite>& sites,
+                      const PanelFleet& panels,
+                      const SimulationConfig& config,
+                      std::vector<WeatherImpact>& lastImpacts,
+                      std::vector<std::int64_t>& lastImpactTimes)
+    {
+        auto passStart = std::chrono::steady_clock::now();
+        auto deadline = passStart + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                        std::chrono::duration<double>(config.tickDeadlineSeconds));
+        std::int64_t now = static_cast<std::int64_t>(std::time(nullptr));
+
+        std::vector<double> latitudes(sites.size());
+        std::vector<double> longitudes(sites.size());
+        for (std::size_t i = 0; i < sites.size(); i++) {
+            latitudes[i] = sites[i].latitude;
+            longitudes[i] = sites[i].longitude;
+        }
+
+        std::vector<FleetSiteResult> results(sites.size());
+        std::vector<WeatherImpact> batch;
+        batch.reserve(fleetBatchSize);
+        MetarSensor weather;
+        std::size_t requests = 0;
+
+        for (std::size_t first = 0; first < sites.size(); first += fleetBatchSize) {
+            std::size_t count = std::min(fleetBatchSize, sites.size() - first);
+
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+            bool fetched = false;
+            batch.clear();
+            if (left >= SensorFallback::minimumAttempt) {
+                requests++;
+                fetched = weather.fetchWeatherBatch(&latitudes[first], &longitudes[first], count,
+                                                    std::min(left, SensorFallback::requestTimeout), batch);
+            }
+
+            for (std::size_t k = 0; k < count; k++) {
+                std::size_t i = first + k;
+                FleetSiteResult& result = results[i];
+
+                if (fetched) {
+                    result.impact = batch[k];
+                    result.weatherSource = SensorSource::Api;
+                    lastImpacts[i] = batch[k];
+                    lastImpactTimes[i] = now;
+                }
+                else if (lastImpactTimes[i] > 0 && now - lastImpactTimes[i] <= SensorFallback::lastWeatherMaxAgeSeconds) {
+                    result.impact = lastImpacts[i];
+                    result.weatherSource = SensorSource::LastKnown;
+                }
+                else {
+                    applyWeatherFactors(result.impact);
+                    result.weatherSource = SensorSource::Default;
+                }
+
+                metrics().weatherSources[static_cast<std::size_t>(result.weatherSource)].inc();
+            }
+        }
+
+        auto evaluateStart = std::chrono::steady_clock::now();
+        double totalKW = evaluateFleet(sites, panels, now, results);
+        auto evaluateEnd = std::chrono::steady_clock::now();
+
+        FleetCsvWriter writer(config.resultsDir);
+        std::filesystem::path file = writer.append(now, sites, results);
+
+        std::size_t fromApi = 0;
+        for (const FleetSiteResult& result : results) {
+            if (result.weatherSource == SensorSource::Api)
+                fromApi++;
+        }
+
+        double fetchMs = std::chrono::duration<double, std::milli>(evaluateStart - passStart).count();
+        double evaluateNs = std::chrono::duration<double, std::nano>(evaluateEnd - evaluateStart).count();
+
+        if (fromApi < sites.size())
+            std::cerr << "Clima da API para " << fromApi << " de " << sites.size()
+                      << " sitios; os outros usaram o ultimo clima bom ou o ceu limpo.\n";
+
+        if (config.output != OutputMode::Silent) {
+            std::cout << "Frota: " << sites.size() << " sitios, " << totalKW << " kW de PV no total; clima em "
+                      << requests << " consultas (" << fetchMs << " ms), painel em "
+                      << evaluateNs / static_cast<double>(sites.size()) << " ns por sitio -> "
+                      << file.string() << "\n";
+        }
+    }
+
+    // Aqui a mesma avaliacao do controller roda para varios sitios de uma vez, sem SimGrid:
+    // e a potencia PV de cada sitio que interessa. Sem intervalo, e uma passada so.
+    int runFleetCommand(const std::vector<std::string>& args, const SimulationConfig& config)
+    {
+        if (args.size() < 2 || args.size() > 3) {
+            printUsage();
+            return 1;
+        }
+
+        int intervalSeconds = 0;
+        if (args.size() > 2) {
+            intervalSeconds = std::stoi(args[2]);
+            if (intervalSeconds <= 0)
+                throw std::runtime_error("O intervalo da frota precisa ser maior que zero.");
+        }
+
+        std::vector<FleetSite> sites = loadFleetSites(args[1]);
+        PanelFleet panels = buildPanelFleet(sites);
+        std::vector<WeatherImpact> lastImpacts(sites.size());
+        std::vector<std::int64_t> lastImpactTimes(sites.size(), 0);
+
+        auto nextPass = std::chrono::steady_clock::now();
+        while (true) {
+            try {
+                runFleetPass(sites, panels, config, lastImpacts, lastImpactTimes);
+            }
+            catch (const std::exception& e) {
+                if (intervalSeconds == 0)
+                    throw;
+                metrics().tickFailures.inc();
+                std::cerr << "Falha nesta passada da frota: " << e.what() << "\n";
+            }
+
+            if (intervalSeconds == 0)
+                return 0;
+
+            nextPass += std::chrono::seconds(intervalSeconds);
+            std::this_thread::sleep_until(nextPass);
+        }
+    }
+
+    // Aqui eu decodifico um arquivo (ou pasta) de METAR e escrevo uma linha por relatorio.
+    // Com --estacao, a saida tem o formato do --clima do simulate-year (hora UTC),
+    // e o que faltar num relatorio repete o anterior da estacao.
+    int runMetarCommand(const std::vector<std::string>& args)
+    {
+        std::string path;
+        std::string station;
+
+        for (std::size_t i = 1; i < args.size(); i++) {
+            if (args[i] == "--estacao") {
+                if (i + 1 >= args.size())
+                    throw std::runtime_error("A opcao --estacao precisa do codigo ICAO (ex.: SBBE).");
+                station = args[++i];
+            }
+            else if (path.empty()) {
+                path = args[i];
+            }
+            else {
+                throw std::runtime_error("Argumento a mais no comando metar: " + args[i]);
+            }
+        }
+
+        if (path.empty()) {
+            printUsage();
+            return 1;
+        }
+
+        std::string out;
+        out.reserve(1 << 20);
+        out += station.empty() ? "station;" : "";
+        out += "datetime;cloud_cover_pct;rain_mm;temperature_c;wind_speed_kmh\n";
+
+        auto start = std::chrono::steady_clock::now();
+        MetarFeedReader reader(path, static_cast<std::int64_t>(std::time(nullptr)));
+        MetarReport report;
+        std::size_t reports = 0;
+        std::size_t written = 0;
+
+        std::int64_t lastTime = 0;
+        double temperature = 28.0;
+        double wind = 0.0;
+        double cloud = 0.0;
+
+        char line[160];
+        while (reader.next(report)) {
+            reports++;
+
+            ResultRow time;
+            setRowTime(time, report.time);
+            char stamp[24];
+            std::snprintf(stamp, sizeof(stamp), "%04d-%02d-%02d %02d:%02d",
+                          time.year, time.month, time.day, time.hour, time.minute);
+
+            if (station.empty()) {
+                // Todas as estacoes misturadas: o que faltou fica vazio.
+                char cloudText[16] = "";
+                char temperatureText[16] = "";
+                char windText[16] = "";
+                if (report.hasCloud)
+                    std::snprintf(cloudText, sizeof(cloudText), "%g", report.cloudCoverPct);
+                if (report.hasTemperature)
+                    std::snprintf(temperatureText, sizeof(temperatureText), "%g", report.temperatureC);
+                if (report.hasWind)
+                    std::snprintf(windText, sizeof(windText), "%g", report.windSpeedKmh);
+
+                std::snprintf(line, sizeof(line), "%s;%s;%s;%g;%s;%s\n",
+                              report.station, stamp, cloudText, report.rainMm, temperatureText, windText);
+            }
+            else {
+                // Correcao ou SPECI fora de ordem nao entra: a serie precisa andar para frente.
+                if (!report.isStation(station) || (written > 0 && report.time <= lastTime))
+                    continue;
+
+                if (report.hasCloud)
+                    cloud = report.cloudCoverPct;
+                if (report.hasTemperature)
+                    temperature = report.temperatureC;
+                if (report.hasWind)
+                    wind = report.windSpeedKmh;
+                lastTime = report.time;
+
+                std::snprintf(line, sizeof(line), "%s;%g;%g;%g;%g\n",
+                              stamp, cloud, report.rainMm, temperature, wind);
+            }
+
+            out += line;
+            written++;
+
+            if (out.size() > (1 << 20) - 256) {
+                std::cout.write(out.data(), static_cast<std::streamsize>(out.size()));
+                out.clear();
+            }
+        }
+
+        std::cout.write(out.data(), static_cast<std::streamsize>(out.size()));
+        std::cout.flush();
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cerr << reports << " relatorios lidos (" << reader.skippedLines() << " linhas puladas), "
+                  << written << " escritos em " << seconds * 1000.0 << " ms\n";
+        return 0;
+    }
+
+    // Aqui eu rodo o ano inteiro com o painel e o fator da rede da config (ou o perfil do --carbono).
+    // A demanda do job e constante; o clima vem do arquivo ou e ceu limpo.
+    int runSimulateYearCommand(const std::vector<std::string>& args, const SimulationConfig& config)
+    {
+        YearSimulationConfig yearConfig;
+        yearConfig.pv = config.pv;
+        yearConfig.gridCarbonIntensity = config.gridCarbonIntensity;
+
+        std::string weatherPath;
+        bool latitudeGiven = false;
+
+        for (std::size_t i = 1; i < args.size(); i++) {
+            if (args[i] == "--ghi-medido") {
+                yearConfig.useMeasuredIrradiance = true;
+                continue;
+            }
+
+            if (i + 1 >= args.size())
+                throw std::runtime_error("A opcao " + args[i] + " precisa de um valor.");
+
+            const std::string& option = args[i];
+            const std::string& value = args[++i];
+
+            if (option == "--ano")
+                yearConfig.year = std::stoi(value);
+            else if (option == "--clima")
+                weatherPath = value;
+            else if (option == "--lat") {
+                yearConfig.latitude = std::stod(value);
+                latitudeGiven = true;
+            }
+            else if (option == "--carga")
+                yearConfig.jobPowerKW = std::stod(value);
+            else if (option == "--passo")
+                yearConfig.stepSeconds = std::stoi(value);
+            else
+                throw std::runtime_error("Opcao desconhecida no comando simulate-year: " + option);
+        }
+
+        WeatherSeries weather;
+        if (!weatherPath.empty()) {
+            bool epw = std::filesystem::path(weatherPath).extension() == ".epw";
+            weather = epw ? WeatherSeries::loadEpw(weatherPath) : WeatherSeries::loadCsv(weatherPath);
+
+            if (weather.hasLocation && !latitudeGiven) {
+                yearConfig.latitude = weather.latitude;
+                std::cerr << "Clima de " << weather.city << " (latitude " << weather.latitude << ")\n";
+            }
+        }
+
+        std::optional<CarbonIntensityProfile> carbon;
+        if (!config.carbonProfilePath.empty())
+            carbon = CarbonIntensityProfile::loadCsv(config.carbonProfilePath);
+
+        YearSimulator simulator(yearConfig);
+
+        auto start = std::chrono::steady_clock::now();
+        YearSimulationResult result = simulator.run(weatherPath.empty() ? nullptr : &weather,
+                                                    carbon ? &*carbon : nullptr);
+        auto finish = std::chrono::steady_clock::now();
+
+        std::cout << "month;steps;sun_hours;irradiation_kwh_m2;pv_available_kwh;"
+                     "energy_total_kwh;energy_pv_kwh;energy_grid_kwh;co2_g;pv_share\n";
+
+        auto printTotals = [&](const std::string& label, const PeriodTotals& totals) {
+            char line[256];
+            double share = totals.energyTotalKWh > 0.0 ? totals.energyPvKWh / totals.energyTotalKWh : 0.0;
+            std::snprintf(line, sizeof(line), "%s;%llu;%g;%g;%g;%g;%g;%g;%g;%g\n",
+                          label.c_str(),
+                          static_cast<unsigned long long>(totals.steps),
+                          totals.sunSteps * yearConfig.stepSeconds / 3600.0,
+                          totals.irradiationKWhM2,
+                          totals.pvAvailableKWh,
+                          totals.energyTotalKWh,
+                          totals.energyPvKWh,
+                          totals.energyGridKWh,
+                          totals.co2G,
+                          share);
+            std::cout << line;
+        };
+
+        for (int month = 1; month <= 12; month++) {
+            char label[16];
+            std::snprintf(label, sizeof(label), "%04d-%02d", yearConfig.year, month);
+            printTotals(label, result.months[month - 1]);
+        }
+        printTotals("total", result.year);
+
+        double seconds = std::chrono::duration<double>(finish - start).count();
+        std::cerr << result.year.steps << " passos em " << seconds * 1000.0 << " ms ("
+                  << result.year.steps / seconds / 1e6 << " milhoes de passos/s)\n";
+        return 0;
+    }
+
+    // Numero inteiro de um argumento posicional, com mensagem clara em vez do
+    // "stoi" do std::invalid_argument.
+    int parsePositiveCount(const std::string& text, const std::string& what)
+    {
+        int value = 0;
+        try {
+            std::size_t used = 0;
+            value = std::stoi(text, &used);
+            if (used != text.size())
+                throw std::invalid_argument(text);
+        }
+        catch (const std::invalid_argument&) {
+            throw std::runtime_error("O " + what + " precisa ser um numero inteiro: " + text);
+        }
+        catch (const std::out_of_range&) {
+            throw std::runtime_error("O " + what + " e grande demais: " + text);
+        }
+
+        if (value < 1)
+            throw std::runtime_error("O " + what + " precisa ser pelo menos 1: " + text);
+        return value;
+    }
+
+    // Tempo do load_platform de um XML num processo filho: o SimGrid so aceita um
+    // Engine por processo, e o pai ja vai usar o dele para montar em codigo.
+    double measureXmlLoadMs(const std::string& xmlPath)
+    {
+        int channel[2];
+        if (pipe(channel) != 0)
+            throw std::runtime_error("Nao consegui criar o pipe para medir o XML.");
+
+        pid_t child = fork();
+        if (child < 0)
+            throw std::runtime_error("Nao consegui criar o processo para medir o XML.");
+
+        if (child == 0) {
+            close(channel[0]);
+            double elapsedMs = -1.0;
+            try {
+                int argc = 1;
+                char programName[] = "pvfirst";
+                char* argv[] = {programName, nullptr};
+
+                simgrid::s4u::Engine engine(&argc, argv);
+                sg_host_energy_plugin_init();
+
+                auto start = std::chrono::steady_clock::now();
+                engine.load_platform(xmlPath);
+                auto finish = std::chrono::steady_clock::now();
+                elapsedMs = std::chrono::duration<double, std::milli>(finish - start).count();
+            }
+            catch (...) {
+            }
+
+            ssize_t written = write(channel[1], &elapsedMs, sizeof(elapsedMs));
+            _exit(written == sizeof(elapsedMs) && elapsedMs >= 0.0 ? 0 : 1);
+        }
+
+        close(channel[1]);
+        double elapsedMs = -1.0;
+        ssize_t received = read(channel[0], &elapsedMs, sizeof(elapsedMs));
+        close(channel[0]);
+
+        int status = 0;
+        waitpid(child, &status, 0);
+
+        if (received != sizeof(elapsedMs) || elapsedMs < 0.0)
+            throw std::runtime_error("O SimGrid nao conseguiu carregar o XML gerado: " + xmlPath);
+        return elapsedMs;
+    }
+
+    // Aqui eu levanto o custo fixo de cada simulacao do SimGrid.
+    // A primeira execucao paga Engine, plugin de energia, parse da plataforma e busca do host.
+    // As seguintes reaproveitam tudo isso e so criam o ator e rodam o job.
+    // Com um numero de nos, a plataforma e uma estrela montada em codigo (PlatformBuilder)
+    // no lugar do simgrid/platform.xml, e o job roda no primeiro no.
+    int runSimGridBenchCommand(const std::vector<std::string>& args)
+    {
+        if (args.size() > 3) {
+            printUsage();
+            return 1;
+        }
+
+        int runs = 1000;
+        if (args.size() > 1)
+            runs = parsePositiveCount(args[1], "numero de execucoes");
+
+        if (runs < 2)
+            throw std::runtime_error("O benchmark precisa de pelo menos 2 execucoes.");
+
+        SimGridJobRunner runner;
+        SimGridJobConfig jobConfig;
+
+        if (args.size() > 2) {
+            jobConfig.useGeneratedPlatform = true;
+            jobConfig.platformSpec.nodeCount = parsePositiveCount(args[2], "numero de nos");
+        }
+
+        double firstMs   = 0.0;
+        double warmSumUs = 0.0;
+        double warmMinUs = 0.0;
+
+        for (int i = 0; i < runs; i++) {
+            auto start = std::chrono::steady_clock::now();
+            runner.run(jobConfig);
+            auto finish = std::chrono::steady_clock::now();
+
+            double elapsedUs = std::chrono::duration<double, std::micro>(finish - start).count();
+
+            if (i == 0) {
+                firstMs = elapsedUs / 1000.0;
+                continue;
+            }
+
+            warmSumUs += elapsedUs;
+            if (i == 1 || elapsedUs < warmMinUs)
+                warmMinUs = elapsedUs;
+        }
+
+        double warmAvgUs = warmSumUs / (runs - 1);
+
+        std::cout << "Custo fixo por simulacao do SimGrid (" << runs << " execucoes, plataforma "
+                  << (jobConfig.useGeneratedPlatform ? "gerada em codigo" : "do XML") << ")\n";
+        std::cout << "Primeira execucao (sem cache) : " << firstMs << " ms\n";
+        std::cout << "Seguintes, media (com cache)  : " << warmAvgUs << " us\n";
+        std::cout << "Seguintes, minimo (com cache) : " << warmMinUs << " us\n";
+        return 0;
+    }
+
+    // Aqui eu monto a plataforma pela API de zonas e mostro quanto tempo isso levou,
+    // ao lado do tempo do SimGrid carregando o XML equivalente (num processo filho).
+    // Se vier um caminho de saida, o XML fica salvo nele.
+    int runPlatformCommand(const std::vector<std::string>& args)
+    {
+        if (args.size() < 3 || args.size() > 4) {
+            printUsage();
+            return 1;
+        }
+
+        PlatformBuilder builder;
+        PlatformSpec spec;
+        spec.topology = PlatformBuilder::parseTopology(args[1]);
+
+        if (spec.topology == ClusterTopology::Star)
+            spec.nodeCount = parsePositiveCount(args[2], "numero de nos");
+        else
+            spec.topoParameters = args[2];
+
+        bool keepXml = args.size() > 3;
+        std::string xmlPath = keepXml ? args[3]
+                                      : (std::filesystem::temp_directory_path() /
+                                         ("pvfirst_platform_" + std::to_string(getpid()) + ".xml")).string();
+        {
+            std::ofstream xmlFile(xmlPath);
+            if (!xmlFile.is_open())
+                throw std::runtime_error("Nao consegui criar o arquivo XML em: " + xmlPath);
+            xmlFile << builder.toXml(spec);
+        }
+
+        // O filho sai antes do Engine do pai existir.
+        double xmlMs = 0.0;
+        try {
+            xmlMs = measureXmlLoadMs(xmlPath);
+        }
+        catch (...) {
+            if (!keepXml)
+                std::filesystem::remove(xmlPath);
+            throw;
+        }
+        if (!keepXml)
+            std::filesystem::remove(xmlPath);
+
+        int argc = 1;
+        char programName[] = "pvfirst";
+        char* argv[] = {programName, nullptr};
+
+        simgrid::s4u::Engine engine(&argc, argv);
+        sg_host_energy_plugin_init();
+
+        auto start = std::chrono::steady_clock::now();
+        builder.build(spec);
+        auto finish = std::chrono::steady_clock::now();
+
+        double elapsedMs = std::chrono::duration<double, std::milli>(finish - start).count();
+
+        std::cout << "Plataforma montada em codigo\n";
+        std::cout << "Nos criados        : " << engine.get_host_count() << "\n";
+        std::cout << "Tempo de montagem  : " << elapsedMs << " ms\n";
+        std::cout << "Carga do XML       : " << xmlMs << " ms (load_platform do XML equivalente)\n";
+        std::cout << "Primeiro host      : " << builder.hostName(spec, 0) << "\n";
+
+        if (keepXml)
+            std::cout << "XML salvo em       : " << xmlPath << "\n";
+
+        return 0;
+    }
+}
+
+int main(int argc, char* argv[])
 {
     // aqui eu abaixo o log do plugin de energia para nao poluir a saida
     xbt_log_control_set("host_energy.thres:critical");
 
+    SimulationConfig config;
+    ProcessOptions options;
+
     try {
-        SimulationController controller;
-        controller.run();
+        std::vector<std::string> args =
+            applyOptions(std::vector<std::string>(argv + 1, argv + argc), config, options);
+
+        // A janela solar so tem sentido no laco do daemon; numa execucao so ela seria ignorada.
+        if (options.solarWindow && (args.empty() || args[0] != "daemon"))
+            throw std::runtime_error("A opcao --janela-solar so vale para o daemon.");
+
+        if (args.empty()) {
+            runSingleCommand(config, options);
+        }
+        else if (args[0] == "daemon") {
+            return runDaemonCommand(args, config, options);
+        }
+        else if (args[0] == "log") {
+            return runLogCommand(args);
+        }
+        else if (args[0] == "archive") {
+            return runArchiveCommand(args);
+        }
+        else if (args[0] == "unarchive") {
+            return runUnarchiveCommand(args);
+        }
+        else if (args[0] == "query") {
+            return runQueryCommand(args);
+        }
+        else if (args[0] == "metar") {
+            return runMetarCommand(args);
+        }
+        else if (args[0] == "fleet") {
+            return runFleetCommand(args, config);
+        }
+        else if (args[0] == "simulate-year") {
+            return runSimulateYearCommand(args, config);
+        }
+        else if (args[0] == "bench-simgrid") {
+            return runSimGridBenchCommand(args);
+        }
+        else if (args[0] == "platform") {
+            return runPlatformCommand(args);
+        }
+        else {
+            printUsage();
+            return 1;
+        }
     }
     catch (const std::exception& e) {
         std::cerr << "\n============================================================\n";
@@ -28,4 +1324,4 @@ int main()
     }
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,337 @@
+#include "metrics/Metrics.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+namespace
+{
+    std::uint64_t toBits(double value)
+    {
+        std::uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    double fromBits(std::uint64_t bits)
+    {
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    // Numeros no texto do Prometheus: %.17g mantem o double sem perda.
+    void appendNumber(std::string& out, double value)
+    {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+        out += buffer;
+    }
+
+    void appendNumber(std::string& out, std::uint64_t value)
+    {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%llu", static_cast<unsigned long long>(value));
+        out += buffer;
+    }
+
+    void appendHeader(std::string& out, const char* name, const char* type, const char* help)
+    {
+        out += "# HELP ";
+        out += name;
+        out += ' ';
+        out += help;
+        out += "\n# TYPE ";
+        out += name;
+        out += ' ';
+        out += type;
+        out += '\n';
+    }
+
+    template <class Value>
+    void appendSample(std::string& out, const char* name, const char* labels, Value value)
+    {
+        out += name;
+        if (labels != nullptr && labels[0] != '\0') {
+            out += '{';
+            out += labels;
+            out += '}';
+        }
+        out += ' ';
+        appendNumber(out, value);
+        out += '\n';
+    }
+
+    void appendGauge(std::string& out, const char* name, const char* help, const Gauge& gauge)
+    {
+        appendHeader(out, name, "gauge", help);
+        appendSample(out, name, "", gauge.get());
+    }
+
+    void appendCounter(std::string& out, const char* name, const char* help, const Counter& counter)
+    {
+        appendHeader(out, name, "counter", help);
+        appendSample(out, name, "", counter.get());
+    }
+
+    void appendCounter(std::string& out, const char* name, const char* help, const DoubleCounter& counter)
+    {
+        appendHeader(out, name, "counter", help);
+        appendSample(out, name, "", counter.get());
+    }
+
+    // Escreve os baldes, a soma e o total de um histograma.
+    // extraLabel vai junto de "le" (por exemplo sensor="geo"); pode ser vazio.
+    void appendHistogram(std::string& out, const char* name, const std::string& extraLabel, const Histogram& histogram)
+    {
+        std::string bucketName = std::string(name) + "_bucket";
+        std::string labelPrefix = extraLabel.empty() ? std::string() : extraLabel + ",";
+
+        for (std::size_t bucket = 0; bucket < histogram.bucketCount(); bucket++) {
+            char bound[32];
+            std::snprintf(bound, sizeof(bound), "%g", histogram.upperBound(bucket));
+
+            std::string labels = labelPrefix + "le=\"" + bound + "\"";
+            appendSample(out, bucketName.c_str(), labels.c_str(), histogram.cumulativeCount(bucket));
+        }
+
+        std::string infLabels = labelPrefix + "le=\"+Inf\"";
+        appendSample(out, bucketName.c_str(), infLabels.c_str(), histogram.count());
+
+        std::string sumName = std::string(name) + "_sum";
+        std::string countName = std::string(name) + "_count";
+        appendSample(out, sumName.c_str(), extraLabel.c_str(), histogram.sum());
+        appendSample(out, countName.c_str(), extraLabel.c_str(), histogram.count());
+    }
+}
+
+void Gauge::set(double value)
+{
+    bits.store(toBits(value), std::memory_order_relaxed);
+}
+
+double Gauge::get() const
+{
+    return fromBits(bits.load(std::memory_order_relaxed));
+}
+
+void Counter::inc(std::uint64_t amount)
+{
+    value.fetch_add(amount, std::memory_order_relaxed);
+}
+
+std::uint64_t Counter::get() const
+{
+    return value.load(std::memory_order_relaxed);
+}
+
+void DoubleCounter::add(double amount)
+{
+    // Nao existe fetch_add para double em 64 bits portavel no C++17,
+    // entao eu faco o laco de compare_exchange. Com um escritor so, ele roda uma vez.
+    std::uint64_t expected = bits.load(std::memory_order_relaxed);
+    while (!bits.compare_exchange_weak(expected,
+                                       toBits(fromBits(expected) + amount),
+                                       std::memory_order_relaxed)) {
+    }
+}
+
+double DoubleCounter::get() const
+{
+    return fromBits(bits.load(std::memory_order_relaxed));
+}
+
+Histogram::Histogram(std::initializer_list<double> upperBounds)
+{
+    if (upperBounds.size() > maxBuckets)
+        throw std::runtime_error("Histograma com baldes demais");
+
+    for (double bound : upperBounds)
+        bounds[boundsCount++] = bound;
+}
+
+void Histogram::observe(double value)
+{
+    // Os limites sao poucos e ordenados: uma busca linear e mais barata que binaria aqui.
+    std::size_t bucket = 0;
+    while (bucket < boundsCount && value > bounds[bucket])
+        bucket++;
+
+    if (bucket < boundsCount)
+        buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+
+    total.fetch_add(1, std::memory_order_relaxed);
+    valueSum.add(value);
+}
+
+std::size_t Histogram::bucketCount() const
+{
+    return boundsCount;
+}
+
+double Histogram::upperBound(std::size_t bucket) const
+{
+    return bounds[bucket];
+}
+
+std::uint64_t Histogram::cumulativeCount(std::size_t bucket) const
+{
+    std::uint64_t cumulative = 0;
+    for (std::size_t i = 0; i <= bucket && i < boundsCount; i++)
+        cumulative += buckets[i].load(std::memory_order_relaxed);
+    return cumulative;
+}
+
+std::uint64_t Histogram::count() const
+{
+    return total.load(std::memory_order_relaxed);
+}
+
+double Histogram::sum() const
+{
+    return valueSum.get();
+}
+
+PvfirstMetrics& metrics()
+{
+    static PvfirstMetrics registry;
+    return registry;
+}
+
+std::string renderPrometheus(const PvfirstMetrics& values)
+{
+    std::string out;
+    out.reserve(4096);
+
+    appendGauge(out, "pvfirst_pv_power_kw",
+                "Potencia PV estimada na ultima execucao (kW).", values.pvPowerKW);
+    appendGauge(out, "pvfirst_irradiance_theoretical_w_m2",
+                "Irradiancia teorica na ultima execucao (W/m2).", values.irradianceTheoreticalWm2);
+    appendGauge(out, "pvfirst_irradiance_adjusted_w_m2",
+                "Irradiancia ajustada pelo clima na ultima execucao (W/m2).", values.irradianceAdjustedWm2);
+
+    appendCounter(out, "pvfirst_energy_total_kwh_total",
+                  "Energia total consumida pelos jobs desde o inicio do processo (kWh).", values.energyTotalKWh);
+    appendCounter(out, "pvfirst_energy_pv_kwh_total",
+                  "Energia dos jobs atendida pelo PV desde o inicio do processo (kWh).", values.energyPvKWh);
+    appendCounter(out, "pvfirst_energy_grid_kwh_total",
+                  "Energia dos jobs atendida pela rede desde o inicio do processo (kWh).", values.energyGridKWh);
+    appendCounter(out, "pvfirst_co2_grams_total",
+                  "CO2 emitido pela energia da rede desde o inicio do processo (g).", values.co2G);
+
+    appendCounter(out, "pvfirst_ticks_total",
+                  "Execucoes do controller iniciadas.", values.ticks);
+    appendCounter(out, "pvfirst_ticks_without_irradiance_total",
+                  "Execucoes encerradas por falta de irradiancia.", values.ticksWithoutIrradiance);
+    appendCounter(out, "pvfirst_tick_failures_total",
+                  "Execucoes que terminaram com erro.", values.tickFailures);
+
+    appendHeader(out, "pvfirst_sensor_retries_total", "counter",
+                 "Consultas dos sensores que falharam (cada uma e tentada de novo numa execucao seguinte).");
+    appendSample(out, "pvfirst_sensor_retries_total", "sensor=\"geo\"", values.geoRetries.get());
+    appendSample(out, "pvfirst_sensor_retries_total", "sensor=\"clima\"", values.weatherRetries.get());
+
+    appendHeader(out, "pvfirst_sensor_source_total", "counter",
+                 "Execucoes por fonte do local e do clima (api, previsao, ultimo, padrao, metar).");
+    for (std::size_t source = 1; source < sensorSourceCount; source++) {
+        const char* name = sensorSourceName(static_cast<SensorSource>(source));
+        std::string geoLabels = std::string("sensor=\"geo\",fonte=\"") + name + "\"";
+        std::string weatherLabels = std::string("sensor=\"clima\",fonte=\"") + name + "\"";
+        appendSample(out, "pvfirst_sensor_source_total", geoLabels.c_str(), values.geoSources[source].get());
+        appendSample(out, "pvfirst_sensor_source_total", weatherLabels.c_str(), values.weatherSources[source].get());
+    }
+
+    appendHeader(out, "pvfirst_sensor_breaker_open", "gauge",
+                 "1 enquanto o disjuntor da API do sensor esta aberto.");
+    appendSample(out, "pvfirst_sensor_breaker_open", "sensor=\"geo\"", values.geoBreakerOpen.get());
+    appendSample(out, "pvfirst_sensor_breaker_open", "sensor=\"clima\"", values.weatherBreakerOpen.get());
+
+    appendCounter(out, "pvfirst_stream_samples_total",
+                  "Amostras lidas do medidor local de irradiancia ou potencia.", values.streamSamples);
+    appendCounter(out, "pvfirst_stream_dropped_total",
+                  "Amostras do medidor local perdidas com a fila cheia.", values.streamDropped);
+    appendCounter(out, "pvfirst_stream_bad_lines_total",
+                  "Linhas do medidor local que nao eram uma amostra valida.", values.streamBadLines);
+    appendGauge(out, "pvfirst_stream_last_value",
+                "Ultima amostra do medidor local (W/m2 ou kW, conforme --stream-tipo).", values.streamLastValue);
+
+    appendHeader(out, "pvfirst_ramp_events_total", "counter",
+                 "Rampas detectadas no medidor local (bordas de nuvem).");
+    appendSample(out, "pvfirst_ramp_events_total", "sentido=\"subida\"", values.rampUps.get());
+    appendSample(out, "pvfirst_ramp_events_total", "sentido=\"descida\"", values.rampDowns.get());
+    appendCounter(out, "pvfirst_ramp_ticks_total",
+                  "Execucoes extras do daemon disparadas por uma rampa, fora da cadencia.", values.rampTicks);
+
+    appendHeader(out, "pvfirst_sensor_fetch_seconds", "histogram",
+                 "Tempo de cada consulta HTTP dos sensores (s).");
+    appendHistogram(out, "pvfirst_sensor_fetch_seconds", "sensor=\"geo\"", values.geoFetchSeconds);
+    appendHistogram(out, "pvfirst_sensor_fetch_seconds", "sensor=\"clima\"", values.weatherFetchSeconds);
+
+    appendHeader(out, "pvfirst_simgrid_run_seconds", "histogram",
+                 "Tempo de parede de cada simulacao do job no SimGrid (s).");
+    appendHistogram(out, "pvfirst_simgrid_run_seconds", "", values.simgridRunSeconds);
+
+    return out;
+}
+
+MetricsFileExporter::MetricsFileExporter(const std::string& path, int intervalSeconds)
+    : path(path),
+      intervalSeconds(intervalSeconds > 0 ? intervalSeconds : 15)
+{
+    writeNow();
+    worker = std::thread(&MetricsFileExporter::loop, this);
+}
+
+MetricsFileExporter::~MetricsFileExporter()
+{
+    {
+        std::lock_guard<std::mutex> lock(waitMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    if (worker.joinable())
+        worker.join();
+
+    writeNow();
+}
+
+void MetricsFileExporter::writeNow()
+{
+    std::string text = renderPrometheus(metrics());
+    std::string tmpPath = path + ".tmp";
+
+    {
+        std::ofstream file(tmpPath, std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "Nao consegui escrever as metricas em " << tmpPath << "\n";
+            return;
+        }
+        file << text;
+    }
+
+    // rename por cima do arquivo antigo e atomico no mesmo sistema de arquivos.
+    std::error_code error;
+    std::filesystem::rename(tmpPath, path, error);
+    if (error)
+        std::cerr << "Nao consegui publicar as metricas em " << path << ": " << error.message() << "\n";
+}
+
+void MetricsFileExporter::loop()
+{
+    std::unique_lock<std::mutex> lock(waitMutex);
+
+    while (!stopping) {
+        wake.wait_for(lock, std::chrono::seconds(intervalSeconds), [this]() { return stopping; });
+        if (stopping)
+            break;
+
+        lock.unlock();
+        writeNow();
+        lock.lock();
+    }
+}
@@ -0,0 +1,158 @@
+#pragma once
+
+#include "sensors/SensorState.hpp"
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Aqui ficam as metricas do processo longo (modo daemon) no formato do Prometheus.
+//
+// A regra e simples: quem esta no caminho quente (controller, sensores) so faz
+// operacoes atomicas, sem lock nenhum. Quem le e o exportador, numa thread propria,
+// entao gerar o texto das metricas nunca segura uma execucao.
+
+// Valor instantaneo (potencia PV agora, irradiancia agora).
+// O double fica guardado como bits num atomic de 64 bits.
+class Gauge
+{
+public:
+    void set(double value);
+    double get() const;
+
+private:
+    std::atomic<std::uint64_t> bits{0};
+};
+
+// Contador inteiro que so cresce (execucoes, tentativas de novo).
+class Counter
+{
+public:
+    void inc(std::uint64_t amount = 1);
+    std::uint64_t get() const;
+
+private:
+    std::atomic<std::uint64_t> value{0};
+};
+
+// Contador em double que so cresce (energia acumulada, CO2 acumulado).
+class DoubleCounter
+{
+public:
+    void add(double amount);
+    double get() const;
+
+private:
+    std::atomic<std::uint64_t> bits{0};
+};
+
+// Histograma com limites fixos, definidos na construcao.
+// observe() incrementa um balde, a soma e o total, tudo sem lock.
+class Histogram
+{
+public:
+    static constexpr std::size_t maxBuckets = 16;
+
+    Histogram(std::initializer_list<double> upperBounds);
+
+    void observe(double value);
+
+    std::size_t bucketCount() const;
+    double upperBound(std::size_t bucket) const;
+
+    // Quantidade de observacoes <= upperBound(bucket), ja acumulada como o Prometheus espera.
+    std::uint64_t cumulativeCount(std::size_t bucket) const;
+    std::uint64_t count() const;
+    double sum() const;
+
+private:
+    std::array<double, maxBuckets> bounds{};
+    std::size_t boundsCount = 0;
+
+    std::array<std::atomic<std::uint64_t>, maxBuckets> buckets{};
+    std::atomic<std::uint64_t> total{0};
+    DoubleCounter valueSum;
+};
+
+struct PvfirstMetrics
+{
+    Gauge pvPowerKW;
+    Gauge irradianceTheoreticalWm2;
+    Gauge irradianceAdjustedWm2;
+
+    DoubleCounter energyTotalKWh;
+    DoubleCounter energyPvKWh;
+    DoubleCounter energyGridKWh;
+    DoubleCounter co2G;
+
+    Counter ticks;
+    Counter ticksWithoutIrradiance;
+    Counter tickFailures;
+
+    Counter geoRetries;
+    Counter weatherRetries;
+
+    // Execucoes por fonte do local e do clima (o indice e o SensorSource).
+    std::array<Counter, sensorSourceCount> geoSources;
+    std::array<Counter, sensorSourceCount> weatherSources;
+
+    // 1 enquanto o disjuntor da API esta aberto (sem consultas), 0 fechado.
+    Gauge geoBreakerOpen;
+    Gauge weatherBreakerOpen;
+
+    // Medidor local (--stream): amostras lidas, perdidas com a fila cheia
+    // e linhas que nao eram numero. O gauge e a ultima amostra lida.
+    Counter streamSamples;
+    Counter streamDropped;
+    Counter streamBadLines;
+    Gauge streamLastValue;
+
+    // Rampas do medidor (ver RampDetector.hpp) e execucoes extras que elas dispararam.
+    Counter rampUps;
+    Counter rampDowns;
+    Counter rampTicks;
+
+    Histogram geoFetchSeconds{0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0};
+    Histogram weatherFetchSeconds{0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0};
+    Histogram simgridRunSeconds{0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.5, 1.0};
+};
+
+// Registro unico do processo.
+PvfirstMetrics& metrics();
+
+// Texto no formato de exposicao do Prometheus (text/plain; version=0.0.4).
+std::string renderPrometheus(const PvfirstMetrics& values);
+
+// Reescreve um arquivo .prom a cada intervalo, numa thread propria.
+// A escrita vai primeiro para um .tmp e depois e renomeada por cima,
+// entao quem le (node_exporter textfile, por exemplo) nunca ve arquivo pela metade.
+class MetricsFileExporter
+{
+public:
+    MetricsFileExporter(const std::string& path, int intervalSeconds);
+    ~MetricsFileExporter();
+
+    MetricsFileExporter(const MetricsFileExporter&) = delete;
+    MetricsFileExporter& operator=(const MetricsFileExporter&) = delete;
+
+    // Escreve o arquivo agora, fora do ciclo da thread.
+    void writeNow();
+
+private:
+    void loop();
+
+    std::string path;
+    int intervalSeconds;
+
+    std::mutex waitMutex;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    std::thread worker;
+};
@@ -0,0 +1,580 @@
+#include "Query.hpp"
+#include "storage/CivilTime.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+namespace
+{
+    // ================================ PARSER =================================
+
+    struct Token
+    {
+        enum Kind { Word, Number, Symbol, End } kind = End;
+        std::string text;
+        double number = 0.0;
+    };
+
+    std::vector<Token> tokenize(const std::string& text)
+    {
+        std::vector<Token> tokens;
+        std::size_t i = 0;
+
+        while (i < text.size()) {
+            char c = text[i];
+
+            if (std::isspace(static_cast<unsigned char>(c))) {
+                i++;
+                continue;
+            }
+
+            Token token;
+
+            if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+                std::size_t start = i;
+                while (i < text.size() && (std::isalnum(static_cast<unsigned char>(text[i])) || text[i] == '_'))
+                    i++;
+                token.kind = Token::Word;
+                token.text = text.substr(start, i - start);
+            }
+            else if (std::isdigit(static_cast<unsigned char>(c)) || c == '-' || c == '.') {
+                std::from_chars_result result = std::from_chars(text.data() + i, text.data() + text.size(), token.number);
+                if (result.ec != std::errc())
+                    throw std::runtime_error("Numero invalido na consulta perto de: " + text.substr(i));
+                token.kind = Token::Number;
+                token.text = text.substr(i, static_cast<std::size_t>(result.ptr - (text.data() + i)));
+                i = static_cast<std::size_t>(result.ptr - text.data());
+            }
+            else if ((c == '<' || c == '>' || c == '!') && i + 1 < text.size() && text[i + 1] == '=') {
+                token.kind = Token::Symbol;
+                token.text = text.substr(i, 2);
+                i += 2;
+            }
+            else if (c == '<' || c == '>' || c == '=' || c == '(' || c == ')' || c == ',') {
+                token.kind = Token::Symbol;
+                token.text = std::string(1, c);
+                i++;
+            }
+            else {
+                throw std::runtime_error(std::string("Caractere inesperado na consulta: ") + c);
+            }
+
+            tokens.push_back(token);
+        }
+
+        tokens.push_back(Token{});
+        return tokens;
+    }
+
+    class Parser
+    {
+    public:
+        explicit Parser(const std::string& text)
+            : tokens(tokenize(text))
+        {
+        }
+
+        Query parse()
+        {
+            Query query;
+
+            expectWord("select");
+            do {
+                query.aggregates.push_back(parseAggregate());
+            } while (acceptSymbol(","));
+
+            if (acceptWord("where")) {
+                do {
+                    query.conditions.push_back(parseCondition());
+                } while (acceptWord("and"));
+            }
+
+            if (acceptWord("group")) {
+                expectWord("by");
+                query.groupBy = parseGroupKey(take().text);
+            }
+
+            if (peek().kind != Token::End)
+                throw std::runtime_error("Sobrou texto no fim da consulta: " + peek().text);
+
+            return query;
+        }
+
+    private:
+        const Token& peek() const
+        {
+            return tokens[position];
+        }
+
+        const Token& take()
+        {
+            const Token& token = tokens[position];
+            if (token.kind != Token::End)
+                position++;
+            return token;
+        }
+
+        bool acceptWord(const char* word)
+        {
+            if (peek().kind == Token::Word && peek().text == word) {
+                position++;
+                return true;
+            }
+            return false;
+        }
+
+        bool acceptSymbol(const char* symbol)
+        {
+            if (peek().kind == Token::Symbol && peek().text == symbol) {
+                position++;
+                return true;
+            }
+            return false;
+        }
+
+        void expectWord(const char* word)
+        {
+            if (!acceptWord(word))
+                throw std::runtime_error(std::string("Esperava '") + word + "' na consulta");
+        }
+
+        void expectSymbol(const char* symbol)
+        {
+            if (!acceptSymbol(symbol))
+                throw std::runtime_error(std::string("Esperava '") + symbol + "' na consulta");
+        }
+
+        int parseColumn()
+        {
+            const Token& token = take();
+            int column = ResultColumns::columnIndex(token.text);
+            if (token.kind != Token::Word || column < 0)
+                throw std::runtime_error("Coluna desconhecida na consulta: " + token.text);
+            return column;
+        }
+
+        QueryAggregate parseAggregate()
+        {
+            const Token& name = take();
+            if (name.kind != Token::Word)
+                throw std::runtime_error("Esperava um agregado (count, sum, avg, min, max, share)");
+
+            QueryAggregate aggregate;
+            expectSymbol("(");
+
+            if (name.text == "count") {
+                aggregate.kind = AggregateKind::Count;
+                aggregate.label = "count()";
+                expectSymbol(")");
+                return aggregate;
+            }
+
+            if (name.text == "sum")
+                aggregate.kind = AggregateKind::Sum;
+            else if (name.text == "avg")
+                aggregate.kind = AggregateKind::Avg;
+            else if (name.text == "min")
+                aggregate.kind = AggregateKind::Min;
+            else if (name.text == "max")
+                aggregate.kind = AggregateKind::Max;
+            else if (name.text == "share")
+                aggregate.kind = AggregateKind::Share;
+            else
+                throw std::runtime_error("Agregado desconhecido na consulta: " + name.text);
+
+            aggregate.column = parseColumn();
+            aggregate.label = name.text + "(" + ResultColumns::columnNames()[aggregate.column];
+
+            if (aggregate.kind == AggregateKind::Share) {
+                expectSymbol(",");
+                aggregate.denominator = parseColumn();
+                aggregate.label += "," + ResultColumns::columnNames()[aggregate.denominator];
+            }
+
+            expectSymbol(")");
+            aggregate.label += ")";
+            return aggregate;
+        }
+
+        QueryCondition parseCondition()
+        {
+            QueryCondition condition;
+            condition.column = parseColumn();
+
+            const Token& op = take();
+            if (op.kind != Token::Symbol)
+                throw std::runtime_error("Esperava um comparador (< <= > >= = !=) na consulta");
+
+            if (op.text == "<")
+                condition.op = CompareOp::Less;
+            else if (op.text == "<=")
+                condition.op = CompareOp::LessEqual;
+            else if (op.text == ">")
+                condition.op = CompareOp::Greater;
+            else if (op.text == ">=")
+                condition.op = CompareOp::GreaterEqual;
+            else if (op.text == "=")
+                condition.op = CompareOp::Equal;
+            else if (op.text == "!=")
+                condition.op = CompareOp::NotEqual;
+            else
+                throw std::runtime_error("Comparador desconhecido na consulta: " + op.text);
+
+            const Token& value = take();
+            if (value.kind != Token::Number)
+                throw std::runtime_error("Esperava um numero depois de " + op.text + " na consulta");
+
+            condition.value = value.number;
+            return condition;
+        }
+
+        static GroupKey parseGroupKey(const std::string& text)
+        {
+            if (text == "month")
+                return GroupKey::Month;
+            if (text == "day")
+                return GroupKey::Day;
+            if (text == "hour")
+                return GroupKey::Hour;
+            if (text == "hour_of_day")
+                return GroupKey::HourOfDay;
+            throw std::runtime_error("Grupo desconhecido na consulta (use month, day, hour ou hour_of_day): " + text);
+        }
+
+        std::vector<Token> tokens;
+        std::size_t position = 0;
+    };
+
+    // =============================== EXECUCAO ================================
+
+    // Acumuladores de uma particao, um vetor por grupo.
+    struct PartitionState
+    {
+        std::vector<std::uint64_t> counts;
+        std::vector<std::vector<double>> sums;
+        std::vector<std::vector<double>> denominators;
+        std::vector<std::vector<double>> mins;
+        std::vector<std::vector<double>> maxs;
+    };
+
+    std::int64_t groupKeyOf(GroupKey key, const ResultColumns& columns, std::size_t row,
+                            const double* years, const double* months, const double* hours)
+    {
+        switch (key) {
+        case GroupKey::None:
+            return 0;
+        case GroupKey::Month:
+            return static_cast<std::int64_t>(years[row]) * 12 + static_cast<std::int64_t>(months[row]) - 1;
+        case GroupKey::Day:
+            return floorDiv(columns.timestamps()[row], 86400);
+        case GroupKey::Hour:
+            return floorDiv(columns.timestamps()[row], 3600);
+        case GroupKey::HourOfDay:
+            return static_cast<std::int64_t>(hours[row]);
+        }
+        return 0;
+    }
+
+    std::string groupLabel(GroupKey key, std::int64_t value)
+    {
+        std::string text;
+        int year = 0;
+        int month = 0;
+        int day = 0;
+
+        switch (key) {
+        case GroupKey::None:
+            return "total";
+        case GroupKey::Month:
+            appendCivilField(text, static_cast<int>(floorDiv(value, 12)), 0);
+            text += '-';
+            appendCivilField(text, static_cast<int>(value - floorDiv(value, 12) * 12 + 1), 2);
+            return text;
+        case GroupKey::Day:
+            civilFromDays(value, year, month, day);
+            appendDate(text, year, month, day);
+            return text;
+        case GroupKey::Hour:
+            civilFromDays(floorDiv(value, 24), year, month, day);
+            appendDate(text, year, month, day);
+            text += ' ';
+            appendCivilField(text, static_cast<int>(value - floorDiv(value, 24) * 24), 2);
+            text += 'h';
+            return text;
+        case GroupKey::HourOfDay:
+            appendCivilField(text, static_cast<int>(value), 2);
+            return text;
+        }
+        return text;
+    }
+
+    // Marca em mask as linhas que passam na condicao.
+    // Um laco por operador, sem desvio dentro: o compilador consegue vetorizar.
+    void applyCondition(const QueryCondition& condition, const double* values,
+                        std::uint8_t* mask, std::size_t count)
+    {
+        const double limit = condition.value;
+
+        switch (condition.op) {
+        case CompareOp::Less:
+            for (std::size_t i = 0; i < count; i++)
+                mask[i] &= static_cast<std::uint8_t>(values[i] < limit);
+            break;
+        case CompareOp::LessEqual:
+            for (std::size_t i = 0; i < count; i++)
+                mask[i] &= static_cast<std::uint8_t>(values[i] <= limit);
+            break;
+        case CompareOp::Greater:
+            for (std::size_t i = 0; i < count; i++)
+                mask[i] &= static_cast<std::uint8_t>(values[i] > limit);
+            break;
+        case CompareOp::GreaterEqual:
+            for (std::size_t i = 0; i < count; i++)
+                mask[i] &= static_cast<std::uint8_t>(values[i] >= limit);
+            break;
+        case CompareOp::Equal:
+            for (std::size_t i = 0; i < count; i++)
+                mask[i] &= static_cast<std::uint8_t>(values[i] == limit);
+            break;
+        case CompareOp::NotEqual:
+            for (std::size_t i = 0; i < count; i++)
+                mask[i] &= static_cast<std::uint8_t>(values[i] != limit);
+            break;
+        }
+    }
+
+    // Soma mascarada sem grupo, com quatro acumuladores independentes
+    // para nao ficar preso na latencia de uma soma so.
+    double maskedSum(const double* values, const std::uint8_t* mask, std::size_t count)
+    {
+        double lanes[4] = {0.0, 0.0, 0.0, 0.0};
+        std::size_t i = 0;
+
+        for (; i + 4 <= count; i += 4) {
+            lanes[0] += mask[i]     ? values[i]     : 0.0;
+            lanes[1] += mask[i + 1] ? values[i + 1] : 0.0;
+            lanes[2] += mask[i + 2] ? values[i + 2] : 0.0;
+            lanes[3] += mask[i + 3] ? values[i + 3] : 0.0;
+        }
+        for (; i < count; i++)
+            lanes[0] += mask[i] ? values[i] : 0.0;
+
+        return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    }
+
+    bool needsSum(AggregateKind kind)
+    {
+        return kind == AggregateKind::Sum || kind == AggregateKind::Avg || kind == AggregateKind::Share;
+    }
+
+    void runPartition(const Query& query, const ResultColumns& columns,
+                      std::size_t begin, std::size_t end,
+                      std::int64_t firstKey, std::size_t groupCount,
+                      PartitionState& state)
+    {
+        const std::size_t count = end - begin;
+        const std::size_t aggregateCount = query.aggregates.size();
+
+        state.counts.assign(groupCount, 0);
+        state.sums.assign(aggregateCount, std::vector<double>(groupCount, 0.0));
+        state.denominators.assign(aggregateCount, std::vector<double>(groupCount, 0.0));
+        state.mins.assign(aggregateCount, std::vector<double>(groupCount, std::numeric_limits<double>::infinity()));
+        state.maxs.assign(aggregateCount, std::vector<double>(groupCount, -std::numeric_limits<double>::infinity()));
+
+        // 1) filtro: uma varredura por condicao.
+        std::vector<std::uint8_t> mask(count, 1);
+        for (const QueryCondition& condition : query.conditions)
+            applyCondition(condition, columns.column(condition.column).data() + begin, mask.data(), count);
+
+        // 2) grupo de cada linha, ja como indice direto no vetor de acumuladores.
+        const double* years  = columns.column(ResultColumns::columnIndex("year")).data();
+        const double* months = columns.column(ResultColumns::columnIndex("month")).data();
+        const double* hours  = columns.column(ResultColumns::columnIndex("hour")).data();
+
+        std::vector<std::uint32_t> groups(count, 0);
+        if (query.groupBy != GroupKey::None) {
+            for (std::size_t i = 0; i < count; i++)
+                groups[i] = static_cast<std::uint32_t>(
+                    groupKeyOf(query.groupBy, columns, begin + i, years, months, hours) - firstKey);
+        }
+
+        for (std::size_t i = 0; i < count; i++)
+            state.counts[groups[i]] += mask[i];
+
+        // 3) agregados, uma coluna de cada vez.
+        for (std::size_t a = 0; a < aggregateCount; a++) {
+            const QueryAggregate& aggregate = query.aggregates[a];
+            if (aggregate.kind == AggregateKind::Count)
+                continue;
+
+            const double* values = columns.column(aggregate.column).data() + begin;
+
+            if (needsSum(aggregate.kind)) {
+                if (query.groupBy == GroupKey::None) {
+                    state.sums[a][0] = maskedSum(values, mask.data(), count);
+                }
+                else {
+                    double* sums = state.sums[a].data();
+                    for (std::size_t i = 0; i < count; i++)
+                        sums[groups[i]] += mask[i] ? values[i] : 0.0;
+                }
+            }
+
+            if (aggregate.kind == AggregateKind::Share) {
+                const double* denominator = columns.column(aggregate.denominator).data() + begin;
+                if (query.groupBy == GroupKey::None) {
+                    state.denominators[a][0] = maskedSum(denominator, mask.data(), count);
+                }
+                else {
+                    double* sums = state.denominators[a].data();
+                    for (std::size_t i = 0; i < count; i++)
+                        sums[groups[i]] += mask[i] ? denominator[i] : 0.0;
+                }
+            }
+
+            if (aggregate.kind == AggregateKind::Min) {
+                double* mins = state.mins[a].data();
+                for (std::size_t i = 0; i < count; i++) {
+                    if (mask[i])
+                        mins[groups[i]] = std::min(mins[groups[i]], values[i]);
+                }
+            }
+
+            if (aggregate.kind == AggregateKind::Max) {
+                double* maxs = state.maxs[a].data();
+                for (std::size_t i = 0; i < count; i++) {
+                    if (mask[i])
+                        maxs[groups[i]] = std::max(maxs[groups[i]], values[i]);
+                }
+            }
+        }
+    }
+}
+
+Query Query::parse(const std::string& text)
+{
+    Parser parser(text);
+    return parser.parse();
+}
+
+QueryResult runQuery(const Query& query, const ResultColumns& columns, unsigned threads)
+{
+    const std::size_t rows = columns.rowCount();
+
+    QueryResult result;
+    result.headers.push_back("grupo");
+    for (const QueryAggregate& aggregate : query.aggregates)
+        result.headers.push_back(aggregate.label);
+
+    if (rows == 0)
+        return result;
+
+    // Faixa de chaves de grupo: os acumuladores viram vetores indexados direto pela chave.
+    const double* years  = columns.column(ResultColumns::columnIndex("year")).data();
+    const double* months = columns.column(ResultColumns::columnIndex("month")).data();
+    const double* hours  = columns.column(ResultColumns::columnIndex("hour")).data();
+
+    std::int64_t firstKey = 0;
+    std::int64_t lastKey = 0;
+    if (query.groupBy != GroupKey::None) {
+        firstKey = std::numeric_limits<std::int64_t>::max();
+        lastKey = std::numeric_limits<std::int64_t>::min();
+        for (std::size_t i = 0; i < rows; i++) {
+            std::int64_t key = groupKeyOf(query.groupBy, columns, i, years, months, hours);
+            firstKey = std::min(firstKey, key);
+            lastKey = std::max(lastKey, key);
+        }
+    }
+
+    std::size_t groupCount = static_cast<std::size_t>(lastKey - firstKey + 1);
+    if (groupCount > 10000000)
+        throw std::runtime_error("Grupos demais para a consulta (datas muito espalhadas no historico).");
+
+    // Particoes de pelo menos 64 mil linhas: abaixo disso criar thread custa mais que ganha.
+    const std::size_t minimumPartition = 65536;
+    unsigned partitions = threads;
+    if (partitions == 0) {
+        unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+        partitions = static_cast<unsigned>(std::min<std::size_t>(cores, std::max<std::size_t>(1, rows / minimumPartition)));
+    }
+
+    std::vector<PartitionState> states(partitions);
+    std::vector<std::thread> workers;
+
+    for (unsigned p = 0; p < partitions; p++) {
+        std::size_t begin = rows * p / partitions;
+        std::size_t end = rows * (p + 1) / partitions;
+
+        if (p + 1 == partitions) {
+            runPartition(query, columns, begin, end, firstKey, groupCount, states[p]);
+        }
+        else {
+            workers.emplace_back(runPartition, std::cref(query), std::cref(columns),
+                                 begin, end, firstKey, groupCount, std::ref(states[p]));
+        }
+    }
+
+    for (std::thread& worker : workers)
+        worker.join();
+
+    // Junta as particoes na primeira.
+    PartitionState& total = states[0];
+    for (unsigned p = 1; p < partitions; p++) {
+        for (std::size_t g = 0; g < groupCount; g++)
+            total.counts[g] += states[p].counts[g];
+
+        for (std::size_t a = 0; a < query.aggregates.size(); a++) {
+            for (std::size_t g = 0; g < groupCount; g++) {
+                total.sums[a][g] += states[p].sums[a][g];
+                total.denominators[a][g] += states[p].denominators[a][g];
+                total.mins[a][g] = std::min(total.mins[a][g], states[p].mins[a][g]);
+                total.maxs[a][g] = std::max(total.maxs[a][g], states[p].maxs[a][g]);
+            }
+        }
+    }
+
+    const double missing = std::numeric_limits<double>::quiet_NaN();
+
+    for (std::size_t g = 0; g < groupCount; g++) {
+        if (total.counts[g] == 0)
+            continue;
+
+        result.matchedRows += total.counts[g];
+        result.groups.push_back(groupLabel(query.groupBy, firstKey + static_cast<std::int64_t>(g)));
+
+        std::vector<double> line;
+        for (std::size_t a = 0; a < query.aggregates.size(); a++) {
+            double count = static_cast<double>(total.counts[g]);
+
+            switch (query.aggregates[a].kind) {
+            case AggregateKind::Count:
+                line.push_back(count);
+                break;
+            case AggregateKind::Sum:
+                line.push_back(total.sums[a][g]);
+                break;
+            case AggregateKind::Avg:
+                line.push_back(total.sums[a][g] / count);
+                break;
+            case AggregateKind::Min:
+                line.push_back(total.mins[a][g]);
+                break;
+            case AggregateKind::Max:
+                line.push_back(total.maxs[a][g]);
+                break;
+            case AggregateKind::Share:
+                line.push_back(total.denominators[a][g] != 0.0 ? total.sums[a][g] / total.denominators[a][g] : missing);
+                break;
+            }
+        }
+        result.values.push_back(line);
+    }
+
+    return result;
+}
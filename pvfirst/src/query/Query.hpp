@@ -0,0 +1,91 @@
+#pragma once
+
+#include "ResultColumns.hpp"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Linguagem pequena de consulta do "pvfirst query":
+//
+//   select <agregado>[, <agregado>...] [where <condicao> [and <condicao>...]] [group by <grupo>]
+//
+// agregados: count(), sum(coluna), avg(coluna), min(coluna), max(coluna),
+//            share(coluna_a, coluna_b) = sum(coluna_a) / sum(coluna_b)
+// condicao:  coluna <op> numero, com op em < <= > >= = !=
+// grupo:     month, day, hour (hora de cada dia) ou hour_of_day (00 a 23 somando os dias)
+//
+// Exemplos:
+//   select share(energy_pv_kwh, energy_total_kwh) where month = 6 group by day
+//   select sum(co2_avoided_g) group by hour_of_day
+//   select avg(pv_power_kw), count() where cloud_cover_pct > 50
+
+enum class AggregateKind
+{
+    Count,
+    Sum,
+    Avg,
+    Min,
+    Max,
+    Share
+};
+
+enum class CompareOp
+{
+    Less,
+    LessEqual,
+    Greater,
+    GreaterEqual,
+    Equal,
+    NotEqual
+};
+
+enum class GroupKey
+{
+    None,
+    Month,
+    Day,
+    Hour,
+    HourOfDay
+};
+
+struct QueryAggregate
+{
+    AggregateKind kind = AggregateKind::Count;
+    int column = -1;
+    int denominator = -1; // so no share
+    std::string label;
+};
+
+struct QueryCondition
+{
+    int column = -1;
+    CompareOp op = CompareOp::Equal;
+    double value = 0.0;
+};
+
+struct Query
+{
+    std::vector<QueryAggregate> aggregates;
+    std::vector<QueryCondition> conditions;
+    GroupKey groupBy = GroupKey::None;
+
+    // Lanca std::runtime_error com a explicacao quando a consulta nao faz sentido.
+    static Query parse(const std::string& text);
+};
+
+struct QueryResult
+{
+    // Primeira coluna e o grupo; depois um cabecalho por agregado.
+    std::vector<std::string> headers;
+
+    // Uma linha por grupo que teve pelo menos uma linha do historico.
+    std::vector<std::string> groups;
+    std::vector<std::vector<double>> values;
+
+    std::size_t matchedRows = 0;
+};
+
+// Roda a consulta dividindo as linhas entre threads.
+// threads = 0 escolhe sozinho (uma thread por bloco grande de linhas, ate o numero de nucleos).
+QueryResult runQuery(const Query& query, const ResultColumns& columns, unsigned threads = 0);
@@ -0,0 +1,207 @@
+#include "ResultColumns.hpp"
+#include "storage/CivilTime.hpp"
+#include "storage/ResultsArchive.hpp"
+#include "storage/ResultsCsvReader.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <map>
+#include <ostream>
+
+namespace
+{
+    // Indices das colunas derivadas, logo depois das colunas do CSV.
+    const std::size_t co2AvoidedColumn = resultRowDoubleCount;
+    const std::size_t yearColumn       = resultRowDoubleCount + 1;
+    const std::size_t monthColumn      = resultRowDoubleCount + 2;
+    const std::size_t dayColumn        = resultRowDoubleCount + 3;
+    const std::size_t hourColumn       = resultRowDoubleCount + 4;
+    const std::size_t minuteColumn     = resultRowDoubleCount + 5;
+    const std::size_t dayOfYearColumn  = resultRowDoubleCount + 6;
+
+    // RPVfirstDDMMAA -> AAMMDD, para ordenar os dias.
+    bool dayKeyFromName(const std::string& stem, std::string& key)
+    {
+        const std::string prefix = "RPVfirst";
+        if (stem.size() != prefix.size() + 6 || stem.compare(0, prefix.size(), prefix) != 0)
+            return false;
+
+        std::string digits = stem.substr(prefix.size());
+        if (!std::all_of(digits.begin(), digits.end(), [](char c) { return c >= '0' && c <= '9'; }))
+            return false;
+
+        key = digits.substr(4, 2) + digits.substr(2, 2) + digits.substr(0, 2);
+        return true;
+    }
+}
+
+const std::vector<std::string>& ResultColumns::columnNames()
+{
+    static const std::vector<std::string> names = [] {
+        std::vector<std::string> list(std::begin(resultRowDoubleNames), std::end(resultRowDoubleNames));
+        list.push_back("co2_avoided_g");
+        list.push_back("year");
+        list.push_back("month");
+        list.push_back("day");
+        list.push_back("hour");
+        list.push_back("minute");
+        list.push_back("day_of_year");
+        return list;
+    }();
+    return names;
+}
+
+int ResultColumns::columnIndex(const std::string& name)
+{
+    const std::vector<std::string>& names = columnNames();
+    for (std::size_t i = 0; i < names.size(); i++) {
+        if (names[i] == name)
+            return static_cast<int>(i);
+    }
+    return -1;
+}
+
+void ResultColumns::reserve(std::size_t rows)
+{
+    times.reserve(rows);
+    for (auto& column : values)
+        column.reserve(rows);
+}
+
+void ResultColumns::append(const ResultRow& row)
+{
+    times.push_back(rowSeconds(row));
+
+    for (std::size_t i = 0; i < resultRowDoubleCount; i++)
+        values[i].push_back(row.*resultRowDoubleFields[i]);
+
+    values[co2AvoidedColumn].push_back(row.energyPvKWh * row.gridCarbonIntensity);
+    values[yearColumn].push_back(row.year);
+    values[monthColumn].push_back(row.month);
+    values[dayColumn].push_back(row.day);
+    values[hourColumn].push_back(row.hour);
+    values[minuteColumn].push_back(row.minute);
+    values[dayOfYearColumn].push_back(row.dayOfYear);
+}
+
+void ResultColumns::resizeRows(std::size_t rows)
+{
+    times.resize(rows);
+    for (auto& column : values)
+        column.resize(rows);
+}
+
+void ResultColumns::appendCsv(const std::string& path, std::ostream& warnings)
+{
+    ResultsCsvReader reader(path);
+
+    std::size_t first = rowCount();
+    std::size_t capacity = reader.rowCapacity();
+    std::vector<int> daysOfYear(capacity);
+
+    resizeRows(first + capacity);
+
+    ResultCsvColumns target;
+    target.seconds = times.data() + first;
+    target.dayOfYear = daysOfYear.data();
+    for (std::size_t i = 0; i < resultRowDoubleCount; i++)
+        target.values[i] = values[i].data() + first;
+
+    std::size_t rows = reader.readColumns(target, capacity);
+    resizeRows(first + rows);
+
+    if (reader.skippedLines() > 0)
+        warnings << "Pulei " << reader.skippedLines() << " linha(s) invalida(s) de " << path
+                 << " (a primeira e a linha " << reader.firstSkippedLine() << ")\n";
+
+    // Colunas derivadas, uma de cada vez.
+    const double* energyPv = values[ResultColumns::columnIndex("energy_pv_kwh")].data();
+    const double* carbon = values[ResultColumns::columnIndex("grid_carbon_intensity_gco2_kwh")].data();
+    for (std::size_t i = first; i < first + rows; i++)
+        values[co2AvoidedColumn][i] = energyPv[i] * carbon[i];
+
+    ResultRow time;
+    for (std::size_t i = first; i < first + rows; i++) {
+        setRowTime(time, times[i]);
+        values[yearColumn][i] = time.year;
+        values[monthColumn][i] = time.month;
+        values[dayColumn][i] = time.day;
+        values[hourColumn][i] = time.hour;
+        values[minuteColumn][i] = time.minute;
+        values[dayOfYearColumn][i] = daysOfYear[i - first];
+    }
+}
+
+std::size_t ResultColumns::rowCount() const
+{
+    return times.size();
+}
+
+const std::vector<std::int64_t>& ResultColumns::timestamps() const
+{
+    return times;
+}
+
+const std::vector<double>& ResultColumns::column(std::size_t index) const
+{
+    return values[index];
+}
+
+ResultColumns ResultColumns::loadHistory(const std::string& directory, std::ostream& warnings)
+{
+    // Um caminho por dia: o .pva quando ele estiver em dia com o CSV, senao o CSV.
+    std::map<std::string, std::filesystem::path> days;
+
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(directory)) {
+        if (!entry.is_regular_file())
+            continue;
+
+        const std::filesystem::path& path = entry.path();
+        std::string extension = path.extension().string();
+        if (extension != ".csv" && extension != ".pva")
+            continue;
+
+        std::string key;
+        if (!dayKeyFromName(path.stem().string(), key))
+            continue;
+
+        auto existing = days.find(key);
+        if (existing == days.end()) {
+            days[key] = path;
+            continue;
+        }
+
+        std::filesystem::path archive = extension == ".pva" ? path : existing->second;
+        std::filesystem::path csv = extension == ".csv" ? path : existing->second;
+        days[key] = std::filesystem::last_write_time(archive) >= std::filesystem::last_write_time(csv)
+                        ? archive
+                        : csv;
+    }
+
+    ResultColumns columns;
+    ResultRow row;
+
+    for (const auto& [key, path] : days) {
+        std::size_t rowsBefore = columns.rowCount();
+
+        try {
+            if (path.extension() == ".pva") {
+                ResultsArchiveReader reader(path.string());
+                columns.reserve(rowsBefore + reader.rowCount());
+                while (reader.next(row))
+                    columns.append(row);
+            }
+            else {
+                columns.appendCsv(path.string(), warnings);
+            }
+        }
+        catch (const std::exception& e) {
+            // Arquivo que nao abre (ou .pva corrompido): eu desfaco o que ja tinha sido lido dele.
+            columns.resizeRows(rowsBefore);
+
+            warnings << "Pulei " << path.string() << ": " << e.what() << "\n";
+        }
+    }
+
+    return columns;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "storage/ResultRow.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// Historico de resultados guardado por coluna, para as consultas do "pvfirst query".
+//
+// Cada coluna numerica e um vetor de double contiguo: filtro e soma varrem
+// a memoria em sequencia, sem pular de linha em linha.
+//
+// Alem das colunas do CSV, eu deixo prontas algumas colunas derivadas:
+// - co2_avoided_g: o CO2 que a energia da PV evitou (energy_pv_kwh * fator da rede)
+// - year, month, day, hour, minute, day_of_year: para filtrar por data sem conta nenhuma
+class ResultColumns
+{
+public:
+    // Nomes de todas as colunas, na ordem dos indices.
+    static const std::vector<std::string>& columnNames();
+
+    // -1 se o nome nao existir.
+    static int columnIndex(const std::string& name);
+
+    void append(const ResultRow& row);
+    void reserve(std::size_t rows);
+
+    std::size_t rowCount() const;
+
+    // Segundos corridos da hora local de cada linha (ver CivilTime.hpp).
+    const std::vector<std::int64_t>& timestamps() const;
+    const std::vector<double>& column(std::size_t index) const;
+
+    // Carrega todos os dias de uma pasta (e subpastas), em ordem de data.
+    // Se o dia tiver .pva atualizado, ele e usado no lugar do CSV.
+    // Arquivos que nao abrem sao pulados com um aviso em warnings.
+    static ResultColumns loadHistory(const std::string& directory, std::ostream& warnings);
+
+private:
+    // Le o CSV do dia direto para o fim das colunas, sem passar por ResultRow.
+    // Linhas invalidas sao puladas, com um aviso so por arquivo em warnings.
+    void appendCsv(const std::string& path, std::ostream& warnings);
+    void resizeRows(std::size_t rows);
+
+    std::vector<std::int64_t> times;
+    std::vector<std::vector<double>> values = std::vector<std::vector<double>>(columnNames().size());
+};
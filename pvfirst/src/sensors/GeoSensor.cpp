@@ -1,101 +1,35 @@
 #include "GeoSensor.hpp"
-
-#include <curl/curl.h>
+#include "SensorPayloads.hpp"
+#include "metrics/Metrics.hpp"
 
 #include <chrono>
-#include <iostream>
 #include <string>
-#include <thread>
+#include <utility>
 
-static size_t WriteCallback(void* contents,
-                            size_t size,
-                            size_t nmemb,
-                            std::string* output)
+GeoSensor::GeoSensor()
+    : fetcher(curlHttpGet)
 {
-    size_t total = size * nmemb;
-    output->append(static_cast<char*>(contents), total);
-    return total;
 }
 
-static double extractNumber(const std::string& json, const std::string& key, double defaultValue)
+GeoSensor::GeoSensor(HttpFetcher fetcher)
+    : fetcher(std::move(fetcher))
 {
-    auto keyPos = json.find(key);
-    if (keyPos == std::string::npos)
-        return defaultValue;
-
-    auto start = json.find(":", keyPos);
-    if (start == std::string::npos)
-        return defaultValue;
-
-    start++;
-    auto end = json.find_first_of(",}", start);
-
-    try {
-        return std::stod(json.substr(start, end - start));
-    }
-    catch (...) {
-        return defaultValue;
-    }
 }
 
-static std::string extractText(const std::string& json, const std::string& keyPrefix, const std::string& defaultValue)
+bool GeoSensor::fetchLocation(std::chrono::milliseconds timeout, GPSData& gps)
 {
-    auto keyPos = json.find(keyPrefix);
-    if (keyPos == std::string::npos)
-        return defaultValue;
+    std::string response;
 
-    auto start = keyPos + keyPrefix.size();
-    auto end = json.find('"', start);
-    if (end == std::string::npos)
-        return defaultValue;
+    auto fetchStart = std::chrono::steady_clock::now();
+    HttpStatus status = fetcher("http://ip-api.com/json/", response, timeout);
+    metrics().geoFetchSeconds.observe(
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - fetchStart).count());
 
-    return json.substr(start, end - start);
-}
+    if (status != HttpStatus::Ok || !hasValidLocationPayload(response)) {
+        metrics().geoRetries.inc();
+        return false;
+    }
 
-static bool hasValidLocationPayload(const std::string& response)
-{
-    return response.find("\"lat\"") != std::string::npos &&
-           response.find("\"lon\"") != std::string::npos;
+    gps = parseLocationPayload(response, gps);
+    return true;
 }
-
-GPSData GeoSensor::getLocation()
-{
-    GPSData gps;
-
-    while (true)
-    {
-        CURL* curl = curl_easy_init();
-        if (curl == nullptr) {
-            std::cout << "Nao consegui iniciar o CURL para geolocalizacao. Vou tentar novamente em 10 segundos.\n";
-            std::this_thread::sleep_for(std::chrono::seconds(10));
-            continue;
-        }
-
-        std::string response;
-
-        curl_easy_setopt(curl, CURLOPT_URL, "http://ip-api.com/json/");
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
-        curl_easy_setopt(curl, CURLOPT_TIMEOUT, 10L);
-        curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 5L);
-        curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-        curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
-
-        CURLcode res = curl_easy_perform(curl);
-
-        long httpCode = 0;
-        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
-
-        curl_easy_cleanup(curl);
-
-        if (res == CURLE_OK && httpCode >= 200 && httpCode < 300 && hasValidLocationPayload(response)) {
-            gps.latitude  = extractNumber(response, "\"lat\"", gps.latitude);
-            gps.longitude = extractNumber(response, "\"lon\"", gps.longitude);
-            gps.city      = extractText(response, "\"city\":\"", gps.city);
-            return gps;
-        }
-
-        std::cout << "Sem conectividade valida para geolocalizacao. Vou tentar novamente em 10 segundos.\n";
-        std::this_thread::sleep_for(std::chrono::seconds(10));
-    }
-}
\ No newline at end of file
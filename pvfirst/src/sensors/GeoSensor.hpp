@@ -1,4 +1,7 @@
 #pragma once
+#include "HttpClient.hpp"
+
+#include <chrono>
 #include <string>
 
 struct GPSData {
@@ -9,5 +12,13 @@ struct GPSData {
 
 class GeoSensor {
 public:
-    GPSData getLocation();
+    GeoSensor();
+    explicit GeoSensor(HttpFetcher fetcher);
+
+    // Uma consulta so ao ip-api, esperando no maximo timeout.
+    // false se a API nao respondeu ou a resposta nao tem lat/lon.
+    bool fetchLocation(std::chrono::milliseconds timeout, GPSData& gps);
+
+private:
+    HttpFetcher fetcher;
 };
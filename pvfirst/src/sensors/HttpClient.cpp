@@ -0,0 +1,48 @@
+#include "HttpClient.hpp"
+
+#include <algorithm>
+
+#include <curl/curl.h>
+
+static size_t WriteCallback(void* contents,
+                            size_t size,
+                            size_t nmemb,
+                            std::string* output)
+{
+    size_t total = size * nmemb;
+    output->append(static_cast<char*>(contents), total);
+    return total;
+}
+
+HttpStatus curlHttpGet(const std::string& url, std::string& response, std::chrono::milliseconds timeout)
+{
+    CURL* curl = curl_easy_init();
+    if (curl == nullptr)
+        return HttpStatus::InitFailed;
+
+    response.clear();
+
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
+
+    // O CURL trata 0 como "sem limite", entao o minimo aqui e 1 ms.
+    long timeoutMs = std::max<long>(1, static_cast<long>(timeout.count()));
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, timeoutMs);
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, std::min<long>(timeoutMs, 5000L));
+
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+
+    CURLcode res = curl_easy_perform(curl);
+
+    long httpCode = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
+
+    curl_easy_cleanup(curl);
+
+    if (res == CURLE_OK && httpCode >= 200 && httpCode < 300)
+        return HttpStatus::Ok;
+
+    return HttpStatus::Failed;
+}
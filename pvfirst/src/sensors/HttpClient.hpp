@@ -0,0 +1,27 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <string>
+
+// Aqui eu isolei o transporte HTTP dos sensores.
+// Os sensores so pedem "me traga o texto dessa URL"; quem busca de verdade e o CURL.
+// Em benchmark eu troco esse transporte por respostas gravadas, sem rede.
+//
+// Quem chama passa o tempo maximo da consulta: e assim que cada execucao
+// cabe no prazo dela (ver SimulationConfig::tickDeadlineSeconds).
+
+enum class HttpStatus
+{
+    Ok,
+    InitFailed,
+    Failed
+};
+
+using HttpFetcher = std::function<HttpStatus(const std::string& url,
+                                             std::string& response,
+                                             std::chrono::milliseconds timeout)>;
+
+// GET com CURL. So devolve Ok se a resposta veio com codigo 2xx.
+// Estourando o timeout (conexao incluida), devolve Failed.
+HttpStatus curlHttpGet(const std::string& url, std::string& response, std::chrono::milliseconds timeout);
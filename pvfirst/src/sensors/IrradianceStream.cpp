@@ -0,0 +1,408 @@
+#include "IrradianceStream.hpp"
+#include "metrics/Metrics.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace
+{
+    const char* const socketPrefix = "unix:";
+
+    // Sem linha inteira ate aqui, o que chegou e lixo.
+    const std::size_t maxLineLength = 256;
+
+    bool isSpace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+    }
+
+    std::string_view trim(std::string_view text)
+    {
+        while (!text.empty() && isSpace(text.front()))
+            text.remove_prefix(1);
+        while (!text.empty() && isSpace(text.back()))
+            text.remove_suffix(1);
+        return text;
+    }
+
+    bool parseDouble(std::string_view text, double& value)
+    {
+        std::from_chars_result result = std::from_chars(text.data(), text.data() + text.size(), value);
+        return result.ec == std::errc() && result.ptr == text.data() + text.size() && std::isfinite(value);
+    }
+
+    std::int64_t systemNowNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    int connectSocket(const std::string& path)
+    {
+        sockaddr_un address{};
+        if (path.size() >= sizeof(address.sun_path)) {
+            errno = ENAMETOOLONG;
+            return -1;
+        }
+
+        int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0)
+            return -1;
+
+        address.sun_family = AF_UNIX;
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+        if (::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+            int error = errno;
+            ::close(fd);
+            errno = error;
+            return -1;
+        }
+
+        return fd;
+    }
+}
+
+bool parseStreamQuantity(const std::string& text, StreamQuantity& quantity)
+{
+    if (text == "irradiancia") {
+        quantity = StreamQuantity::Irradiance;
+        return true;
+    }
+    if (text == "potencia") {
+        quantity = StreamQuantity::PvPower;
+        return true;
+    }
+    return false;
+}
+
+bool parseStreamLine(std::string_view line, std::int64_t receivedNs, StreamSample& sample)
+{
+    line = trim(line);
+    if (line.empty() || line.front() == '#')
+        return false;
+
+    std::size_t split = line.find_first_of(";, \t");
+
+    double value = 0.0;
+    std::int64_t timeNs = receivedNs;
+
+    if (split == std::string_view::npos) {
+        if (!parseDouble(line, value))
+            return false;
+    }
+    else {
+        double seconds = 0.0;
+        if (!parseDouble(line.substr(0, split), seconds) || seconds <= 0.0 ||
+            !parseDouble(trim(line.substr(split + 1)), value))
+            return false;
+        timeNs = static_cast<std::int64_t>(std::llround(seconds * 1e9));
+    }
+
+    sample.timeNs = timeNs;
+    sample.value = value < 0.0 ? 0.0 : value;
+    return true;
+}
+
+IrradianceStream::IrradianceStream(const std::string& source, StreamQuantity quantity, StreamCallback onSample)
+    : sourcePath(source),
+      streamQuantity(quantity),
+      onSample(std::move(onSample)),
+      history(historyCapacity)
+{
+    worker = std::thread(&IrradianceStream::loop, this);
+}
+
+IrradianceStream::~IrradianceStream()
+{
+    {
+        std::lock_guard<std::mutex> lock(waitMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    if (worker.joinable())
+        worker.join();
+}
+
+StreamQuantity IrradianceStream::quantity() const
+{
+    return streamQuantity;
+}
+
+const std::string& IrradianceStream::source() const
+{
+    return sourcePath;
+}
+
+std::size_t IrradianceStream::drain()
+{
+    std::size_t count = 0;
+    StreamSample sample;
+
+    while (ring.pop(sample)) {
+        std::size_t slot = (historyStart + historySize) % historyCapacity;
+        history[slot] = sample;
+
+        if (historySize < historyCapacity)
+            historySize++;
+        else
+            historyStart = (historyStart + 1) % historyCapacity;
+
+        count++;
+    }
+
+    return count;
+}
+
+bool IrradianceStream::latest(StreamSample& sample) const
+{
+    if (historySize == 0)
+        return false;
+
+    sample = history[(historyStart + historySize - 1) % historyCapacity];
+    return true;
+}
+
+StreamWindow IrradianceStream::window(std::int64_t nowNs, double seconds) const
+{
+    StreamWindow result;
+    std::int64_t startNs = nowNs - static_cast<std::int64_t>(seconds * 1e9);
+    double sum = 0.0;
+
+    // Do mais novo para o mais velho: a janela costuma ser bem menor que o historico.
+    for (std::size_t i = historySize; i > 0; i--) {
+        const StreamSample& sample = history[(historyStart + i - 1) % historyCapacity];
+        if (sample.timeNs > nowNs)
+            continue;
+        if (sample.timeNs <= startNs)
+            break;
+
+        if (result.count == 0) {
+            result.last = sample.value;
+            result.lastTimeNs = sample.timeNs;
+            result.min = sample.value;
+            result.max = sample.value;
+        }
+
+        result.min = std::min(result.min, sample.value);
+        result.max = std::max(result.max, sample.value);
+        sum += sample.value;
+        result.count++;
+    }
+
+    if (result.count > 0)
+        result.mean = sum / static_cast<double>(result.count);
+    return result;
+}
+
+bool IrradianceStream::waitFor(int milliseconds)
+{
+    std::unique_lock<std::mutex> lock(waitMutex);
+    wake.wait_for(lock, std::chrono::milliseconds(milliseconds), [this]() { return stopping.load(); });
+    return !stopping;
+}
+
+int IrradianceStream::openSource()
+{
+    partialLine.clear();
+
+    // So a primeira abertura que deu certo pula o que ja estava no arquivo;
+    // um arquivo que ainda nao existia no inicio e lido desde o comeco.
+    bool skipExisting = firstOpen;
+    firstOpen = false;
+
+    if (sourcePath.compare(0, std::strlen(socketPrefix), socketPrefix) == 0) {
+        tailFile = false;
+        return connectSocket(sourcePath.substr(std::strlen(socketPrefix)));
+    }
+
+    // Sem O_NONBLOCK, abrir um FIFO sem ninguem escrevendo prende a thread aqui.
+    int fd = ::open(sourcePath.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0)
+        return -1;
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        return -1;
+    }
+
+    if (S_ISFIFO(info.st_mode) || S_ISSOCK(info.st_mode) || S_ISCHR(info.st_mode)) {
+        tailFile = false;
+        return fd;
+    }
+
+    if (!S_ISREG(info.st_mode)) {
+        ::close(fd);
+        errno = EINVAL;
+        return -1;
+    }
+
+    // Arquivo comum: o que ja estava la e passado, fica de fora.
+    // Depois de um logrotate, o arquivo novo e lido desde o comeco.
+    tailFile = true;
+    tailInode = static_cast<std::uint64_t>(info.st_ino);
+    tailOffset = skipExisting ? static_cast<std::int64_t>(info.st_size) : 0;
+    ::lseek(fd, static_cast<off_t>(tailOffset), SEEK_SET);
+    return fd;
+}
+
+long IrradianceStream::readChunk(int fd)
+{
+    char buffer[4096];
+    ssize_t bytes = ::read(fd, buffer, sizeof(buffer));
+    if (bytes <= 0)
+        return static_cast<long>(bytes);
+
+    tailOffset += bytes;
+
+    const char* cursor = buffer;
+    const char* end = buffer + bytes;
+
+    while (cursor < end) {
+        const char* newline = static_cast<const char*>(std::memchr(cursor, '\n', static_cast<std::size_t>(end - cursor)));
+        if (newline == nullptr) {
+            partialLine.append(cursor, static_cast<std::size_t>(end - cursor));
+            if (partialLine.size() > maxLineLength) {
+                metrics().streamBadLines.inc();
+                partialLine.clear();
+            }
+            break;
+        }
+
+        if (partialLine.empty()) {
+            handleLine(std::string_view(cursor, static_cast<std::size_t>(newline - cursor)));
+        }
+        else {
+            partialLine.append(cursor, static_cast<std::size_t>(newline - cursor));
+            handleLine(partialLine);
+            partialLine.clear();
+        }
+
+        cursor = newline + 1;
+    }
+
+    return static_cast<long>(bytes);
+}
+
+void IrradianceStream::handleLine(std::string_view line)
+{
+    PvfirstMetrics& processMetrics = metrics();
+
+    std::string_view text = trim(line);
+    if (text.empty() || text.front() == '#')
+        return;
+
+    StreamSample sample;
+    if (!parseStreamLine(text, systemNowNs(), sample)) {
+        processMetrics.streamBadLines.inc();
+        return;
+    }
+
+    processMetrics.streamSamples.inc();
+    processMetrics.streamLastValue.set(sample.value);
+
+    // Fila cheia quer dizer que ninguem drenou por mais de uma hora: a amostra nova fica de fora.
+    if (!ring.push(sample))
+        processMetrics.streamDropped.inc();
+
+    // Depois do push: quem for acordado pelo callback ja acha a amostra na fila.
+    if (onSample)
+        onSample(sample);
+}
+
+void IrradianceStream::readFrom(int fd)
+{
+    while (!stopping) {
+        if (tailFile) {
+            long bytes = readChunk(fd);
+            if (bytes > 0)
+                continue;
+            if (bytes < 0 && errno != EINTR)
+                return;
+
+            // Fim do arquivo por enquanto. Se ele foi trocado, reabro;
+            // se foi truncado, volto ao comeco.
+            struct stat info;
+            if (::stat(sourcePath.c_str(), &info) != 0 ||
+                static_cast<std::uint64_t>(info.st_ino) != tailInode)
+                return;
+
+            if (static_cast<std::int64_t>(info.st_size) < tailOffset) {
+                ::lseek(fd, 0, SEEK_SET);
+                tailOffset = 0;
+                partialLine.clear();
+            }
+
+            if (!waitFor(100))
+                return;
+            continue;
+        }
+
+        // FIFO e socket: espero dado novo com poll, acordando de tempos em tempos para ver se e hora de parar.
+        pollfd ready{};
+        ready.fd = fd;
+        ready.events = POLLIN;
+
+        int result = ::poll(&ready, 1, 200);
+        if (result < 0) {
+            if (errno == EINTR)
+                continue;
+            return;
+        }
+        if (result == 0)
+            continue;
+
+        long bytes = readChunk(fd);
+        if (bytes == 0)
+            return; // quem escrevia fechou
+        if (bytes < 0 && errno != EAGAIN && errno != EINTR)
+            return;
+    }
+}
+
+void IrradianceStream::loop()
+{
+    while (!stopping) {
+        int fd = openSource();
+
+        if (fd < 0) {
+            // Aviso uma vez so por queda, para nao encher o terminal a cada segundo.
+            if (!reportedFailure) {
+                std::cerr << "Medidor local indisponivel em " << sourcePath << " (" << std::strerror(errno)
+                          << "); tentando de novo a cada 1 s.\n";
+                reportedFailure = true;
+            }
+            if (!waitFor(1000))
+                break;
+            continue;
+        }
+
+        if (reportedFailure) {
+            std::cerr << "Medidor local conectado em " << sourcePath << ".\n";
+            reportedFailure = false;
+        }
+
+        readFrom(fd);
+        ::close(fd);
+
+        // O FIFO pode ser reaberto na hora; o socket espera um pouco para nao martelar o servidor.
+        bool socket = sourcePath.compare(0, std::strlen(socketPrefix), socketPrefix) == 0;
+        if (socket && !waitFor(1000))
+            break;
+    }
+}
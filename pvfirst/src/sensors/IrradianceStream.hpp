@@ -0,0 +1,131 @@
+#pragma once
+
+#include "SpscRing.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// O que o medidor local manda: irradiancia do piranometro (W/m2)
+// ou potencia do inversor (kW).
+enum class StreamQuantity : std::uint8_t
+{
+    Irradiance,
+    PvPower
+};
+
+// "irradiancia" ou "potencia".
+bool parseStreamQuantity(const std::string& text, StreamQuantity& quantity);
+
+struct StreamSample
+{
+    std::int64_t timeNs = 0; // nanossegundos desde 1970 (UTC)
+    double value = 0.0;
+};
+
+// Resumo das amostras de uma janela que termina agora.
+struct StreamWindow
+{
+    std::size_t count = 0;
+    double mean = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+
+    // Amostra mais nova da janela.
+    double last = 0.0;
+    std::int64_t lastTimeNs = 0;
+};
+
+// Uma linha do medidor: "valor" ou "timestamp;valor" (tambem com ',' ou espaco).
+// O timestamp e em segundos desde 1970, pode ter fracao; sem ele vale receivedNs.
+// Valor negativo (o piranometro marca um pouco abaixo de zero a noite) vira zero.
+// false para linha vazia, comentario (#) ou numero invalido.
+bool parseStreamLine(std::string_view line, std::int64_t receivedNs, StreamSample& sample);
+
+// Chamada na thread de leitura, a cada amostra valida, logo depois de ela entrar na fila.
+// Tem que ser rapida: enquanto ela roda, a leitura do medidor esta parada.
+using StreamCallback = std::function<void(const StreamSample&)>;
+
+// Leitura continua do medidor local (1 Hz ou mais), numa thread propria.
+//
+// A fonte pode ser:
+// - "unix:/caminho": socket UNIX de stream, conectado como cliente;
+// - um FIFO (mkfifo): o medidor escreve, eu leio;
+// - um arquivo comum: leio so o que for sendo acrescentado, como o tail -f,
+//   e volto ao comeco se ele for truncado ou trocado (logrotate).
+// Se a fonte cair, a thread tenta de novo sozinha a cada segundo.
+//
+// A thread de leitura so empurra amostras numa SpscRing; quem consome
+// (o controller, uma thread so) chama drain() e depois latest()/window(),
+// que olham um historico do lado do consumidor. Nenhum dos dois lados espera o outro.
+// Amostras, fila cheia e linhas invalidas vao para as metricas do processo.
+class IrradianceStream
+{
+public:
+    // Cerca de uma hora a 1 Hz: da para o consumidor ficar um tick inteiro sem drenar.
+    static constexpr std::size_t ringCapacity = 4096;
+
+    // Historico guardado do lado do consumidor, para as janelas.
+    static constexpr std::size_t historyCapacity = 3600;
+
+    IrradianceStream(const std::string& source, StreamQuantity quantity, StreamCallback onSample = nullptr);
+    ~IrradianceStream();
+
+    IrradianceStream(const IrradianceStream&) = delete;
+    IrradianceStream& operator=(const IrradianceStream&) = delete;
+
+    StreamQuantity quantity() const;
+    const std::string& source() const;
+
+    // --- So a thread consumidora chama daqui para baixo. ---
+
+    // Passa o que chegou da fila para o historico. Devolve quantas amostras vieram.
+    std::size_t drain();
+
+    // Amostra mais nova do historico. false se ainda nao chegou nenhuma.
+    bool latest(StreamSample& sample) const;
+
+    // Amostras com tempo em (nowNs - seconds, nowNs].
+    StreamWindow window(std::int64_t nowNs, double seconds) const;
+
+private:
+    void loop();
+    int openSource();
+    void readFrom(int fd);
+    long readChunk(int fd);
+    void handleLine(std::string_view line);
+    bool waitFor(int milliseconds);
+
+    std::string sourcePath;
+    StreamQuantity streamQuantity;
+    StreamCallback onSample;
+
+    SpscRing<StreamSample, ringCapacity> ring;
+
+    // Lado da thread de leitura.
+    std::string partialLine;
+    bool tailFile = false;
+    std::uint64_t tailInode = 0;
+    std::int64_t tailOffset = 0;
+    bool firstOpen = true;
+
+    bool reportedFailure = false;
+
+    // Lado do consumidor: circular, history[(historyStart + i) % historyCapacity].
+    std::vector<StreamSample> history;
+    std::size_t historyStart = 0;
+    std::size_t historySize = 0;
+
+    std::mutex waitMutex;
+    std::condition_variable wake;
+    std::atomic<bool> stopping{false};
+
+    std::thread worker;
+};
@@ -0,0 +1,623 @@
+#include "MetarReport.hpp"
+#include "SensorPayloads.hpp"
+#include "storage/CivilTime.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+
+namespace
+{
+    const double knotsToKmh = 1.852;
+    const double metersPerSecondToKmh = 3.6;
+    const double hundredthsOfInchToMm = 0.254;
+
+    bool isDigit(char c)
+    {
+        return c >= '0' && c <= '9';
+    }
+
+    bool isUpper(char c)
+    {
+        return c >= 'A' && c <= 'Z';
+    }
+
+    bool allDigits(std::string_view text)
+    {
+        for (char c : text) {
+            if (!isDigit(c))
+                return false;
+        }
+        return !text.empty();
+    }
+
+    // So digitos, sem sinal: o METAR usa o 'M' para negativo e eu trato antes.
+    int digitsValue(std::string_view text)
+    {
+        int value = 0;
+        for (char c : text)
+            value = value * 10 + (c - '0');
+        return value;
+    }
+
+    std::string_view nextToken(std::string_view text, std::size_t& pos)
+    {
+        while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t'))
+            pos++;
+
+        std::size_t start = pos;
+        while (pos < text.size() && text[pos] != ' ' && text[pos] != '\t')
+            pos++;
+
+        return text.substr(start, pos - start);
+    }
+
+    // dddff(Gff)KT, VRBffKT, tambem em MPS e KMH.
+    bool parseWind(std::string_view token, MetarReport& report)
+    {
+        double factor = 0.0;
+        std::size_t unitSize = 0;
+
+        if (token.size() > 2 && token.substr(token.size() - 2) == "KT") {
+            factor = knotsToKmh;
+            unitSize = 2;
+        }
+        else if (token.size() > 3 && token.substr(token.size() - 3) == "MPS") {
+            factor = metersPerSecondToKmh;
+            unitSize = 3;
+        }
+        else if (token.size() > 3 && token.substr(token.size() - 3) == "KMH") {
+            factor = 1.0;
+            unitSize = 3;
+        }
+        else {
+            return false;
+        }
+
+        std::string_view body = token.substr(0, token.size() - unitSize);
+        if (body.size() < 5)
+            return false;
+
+        std::string_view direction = body.substr(0, 3);
+        if (direction != "VRB" && direction != "///" && !allDigits(direction))
+            return false;
+
+        std::string_view speeds = body.substr(3);
+        std::size_t gustPos = speeds.find('G');
+        std::string_view speed = speeds.substr(0, gustPos);
+        std::string_view gust = gustPos == std::string_view::npos ? std::string_view() : speeds.substr(gustPos + 1);
+
+        // "/////KT": estacao sem sensor de vento.
+        if (speed == "//")
+            return true;
+
+        if (speed.size() < 2 || speed.size() > 3 || !allDigits(speed))
+            return false;
+        if (gustPos != std::string_view::npos && (gust.size() < 2 || gust.size() > 3 || !allDigits(gust)))
+            return false;
+
+        report.hasWind = true;
+        report.windSpeedKmh = digitsValue(speed) * factor;
+        report.windGustKmh = gust.empty() ? 0.0 : digitsValue(gust) * factor;
+        return true;
+    }
+
+    // Oitavos do ceu pelo codigo da camada, ou -1 se nao for camada de nuvem.
+    double layerOktas(std::string_view token)
+    {
+        if (token.size() < 5)
+            return -1.0;
+
+        std::string_view amount = token.substr(0, 3);
+        std::string_view height = token.substr(3, 3);
+
+        if (amount.substr(0, 2) == "VV") {
+            height = token.substr(2, 3);
+            return height == "///" || allDigits(height) ? 8.0 : -1.0;
+        }
+
+        if (token.size() < 6 || (height != "///" && !allDigits(height)))
+            return -1.0;
+
+        if (amount == "FEW")
+            return 1.5;
+        if (amount == "SCT")
+            return 3.5;
+        if (amount == "BKN")
+            return 6.0;
+        if (amount == "OVC")
+            return 8.0;
+        return -1.0;
+    }
+
+    bool isClearSky(std::string_view token)
+    {
+        return token == "CAVOK" || token == "SKC" || token == "CLR" || token == "NSC" || token == "NCD";
+    }
+
+    // Chuva estimada (mm/h) de um fenomeno com a intensidade dada:
+    // 0 fraca (-), 1 moderada, 2 forte (+). As faixas casam com as de
+    // applyWeatherFactors: chuvisco fica sempre ate 1 mm, chuva vai de 0.5 a 8.
+    double precipitationRate(std::string_view code, int intensity)
+    {
+        static const double drizzle[3] = {0.1, 0.3, 0.8};
+        static const double rain[3] = {0.5, 2.5, 8.0};
+
+        if (code == "DZ")
+            return drizzle[intensity];
+        if (code == "RA" || code == "SN" || code == "SG" || code == "PL" ||
+            code == "GR" || code == "GS" || code == "UP" || code == "IC")
+            return rain[intensity];
+        return -1.0;
+    }
+
+    bool isWeatherCode(std::string_view code)
+    {
+        static const char* const codes[] = {
+            "MI", "BC", "PR", "DR", "BL", "SH", "TS", "FZ",
+            "DZ", "RA", "SN", "SG", "IC", "PL", "GR", "GS", "UP",
+            "BR", "FG", "FU", "VA", "DU", "SA", "HZ", "PY",
+            "PO", "SQ", "FC", "SS", "DS"};
+
+        for (const char* known : codes) {
+            if (code[0] == known[0] && code[1] == known[1])
+                return true;
+        }
+        return false;
+    }
+
+    // Tempo presente: [-|+|VC] e pares de letras (descritor e fenomenos), ex. -SHRA, +TSRA, BR.
+    bool parsePresentWeather(std::string_view token, MetarReport& report)
+    {
+        int intensity = 1;
+        if (token.size() > 0 && token[0] == '-') {
+            intensity = 0;
+            token.remove_prefix(1);
+        }
+        else if (token.size() > 0 && token[0] == '+') {
+            intensity = 2;
+            token.remove_prefix(1);
+        }
+        else if (token.size() > 2 && token.substr(0, 2) == "VC") {
+            // Nas vizinhancas, nao na estacao: nao conta como chuva aqui.
+            intensity = -1;
+            token.remove_prefix(2);
+        }
+
+        if (token.empty() || token.size() % 2 != 0 || token.size() > 8)
+            return false;
+
+        for (std::size_t i = 0; i < token.size(); i += 2) {
+            if (!isWeatherCode(token.substr(i, 2)))
+                return false;
+        }
+
+        if (intensity < 0)
+            return true;
+
+        for (std::size_t i = 0; i < token.size(); i += 2) {
+            double rate = precipitationRate(token.substr(i, 2), intensity);
+            if (rate > 0.0) {
+                report.precipitation = true;
+                if (!report.measuredRain)
+                    report.rainMm = std::max(report.rainMm, rate);
+            }
+        }
+        return true;
+    }
+
+    // "M05" -> -5, "27" -> 27. false se nao for assim.
+    bool parseSignedTemperature(std::string_view text, double& value)
+    {
+        bool negative = !text.empty() && text[0] == 'M';
+        if (negative)
+            text.remove_prefix(1);
+        if (text.size() != 2 || !allDigits(text))
+            return false;
+        value = negative ? -digitsValue(text) : digitsValue(text);
+        return true;
+    }
+
+    // TT/DD, com M para negativo. O ponto de orvalho pode faltar ("27/").
+    bool parseTemperature(std::string_view token, MetarReport& report)
+    {
+        std::size_t slash = token.find('/');
+        if (slash == std::string_view::npos || slash < 2 || slash > 3)
+            return false;
+
+        double temperature = 0.0;
+        if (!parseSignedTemperature(token.substr(0, slash), temperature))
+            return false;
+
+        std::string_view dew = token.substr(slash + 1);
+        double dewPoint = 0.0;
+        if (!dew.empty() && dew != "//" && !parseSignedTemperature(dew, dewPoint))
+            return false;
+
+        report.hasTemperature = true;
+        report.temperatureC = temperature;
+        report.dewPointC = dewPoint;
+        return true;
+    }
+
+    // Grupos do RMK: Pnnnn (chuva da ultima hora) e Tsnnnsnnn (temperatura em decimos).
+    void parseRemark(std::string_view token, MetarReport& report)
+    {
+        if (token.size() == 5 && token[0] == 'P' && allDigits(token.substr(1))) {
+            report.measuredRain = true;
+            report.rainMm = digitsValue(token.substr(1)) * hundredthsOfInchToMm;
+            if (report.rainMm > 0.0)
+                report.precipitation = true;
+            return;
+        }
+
+        if (token.size() == 9 && token[0] == 'T' && allDigits(token.substr(1))) {
+            double temperature = digitsValue(token.substr(2, 3)) / 10.0;
+            double dewPoint = digitsValue(token.substr(6, 3)) / 10.0;
+            report.hasTemperature = true;
+            report.temperatureC = token[1] == '1' ? -temperature : temperature;
+            report.dewPointC = token[5] == '1' ? -dewPoint : dewPoint;
+        }
+    }
+
+    // "AAAA/MM/DD" ou "AAAA-MM-DD" no comeco do texto.
+    bool parseDate(std::string_view text, int& year, int& month, int& day)
+    {
+        if (text.size() < 10 || (text[4] != '/' && text[4] != '-') || text[7] != text[4] ||
+            !allDigits(text.substr(0, 4)) || !allDigits(text.substr(5, 2)) || !allDigits(text.substr(8, 2)))
+            return false;
+
+        year = digitsValue(text.substr(0, 4));
+        month = digitsValue(text.substr(5, 2));
+        day = digitsValue(text.substr(8, 2));
+        return month >= 1 && month <= 12 && day >= 1 && day <= 31;
+    }
+}
+
+bool MetarReport::isStation(std::string_view code) const
+{
+    return code.size() == std::strlen(station) && code == std::string_view(station);
+}
+
+bool parseMetar(std::string_view text, MetarReport& report)
+{
+    report = MetarReport{};
+
+    while (!text.empty() && (text.back() == '=' || text.back() == ' ' || text.back() == '\r'))
+        text.remove_suffix(1);
+
+    std::size_t pos = 0;
+    std::string_view token = nextToken(text, pos);
+
+    if (token == "METAR" || token == "SPECI")
+        token = nextToken(text, pos);
+    if (token == "COR")
+        token = nextToken(text, pos);
+
+    // Estacao: 4 letras/digitos comecando com letra (SBBE, KJFK, K1V4...).
+    if (token.size() != 4 || !isUpper(token[0]))
+        return false;
+    for (char c : token) {
+        if (!isUpper(c) && !isDigit(c))
+            return false;
+    }
+    std::memcpy(report.station, token.data(), 4);
+
+    token = nextToken(text, pos);
+    if (token.size() != 7 || token[6] != 'Z' || !allDigits(token.substr(0, 6)))
+        return false;
+
+    report.day = digitsValue(token.substr(0, 2));
+    report.hour = digitsValue(token.substr(2, 2));
+    report.minute = digitsValue(token.substr(4, 2));
+    if (report.day < 1 || report.day > 31 || report.hour > 23 || report.minute > 59)
+        return false;
+
+    bool remarks = false;
+    bool trend = false;
+
+    for (token = nextToken(text, pos); !token.empty(); token = nextToken(text, pos)) {
+        if (token == "NIL")
+            return false;
+
+        if (token == "RMK") {
+            remarks = true;
+            continue;
+        }
+
+        if (remarks) {
+            parseRemark(token, report);
+            continue;
+        }
+
+        // Depois da tendencia vem a previsao para as proximas horas, nao a observacao.
+        if (token == "NOSIG" || token == "BECMG" || token == "TEMPO") {
+            trend = true;
+            continue;
+        }
+        if (trend)
+            continue;
+
+        if (token == "AUTO" || token == "COR")
+            continue;
+
+        if (!report.hasWind && parseWind(token, report))
+            continue;
+
+        if (isClearSky(token)) {
+            report.hasCloud = true;
+            continue;
+        }
+
+        double oktas = layerOktas(token);
+        if (oktas >= 0.0) {
+            report.hasCloud = true;
+            report.cloudLayers++;
+            report.cloudCoverPct = std::max(report.cloudCoverPct, oktas / 8.0 * 100.0);
+            continue;
+        }
+
+        if (!report.hasTemperature && parseTemperature(token, report))
+            continue;
+
+        parsePresentWeather(token, report);
+    }
+
+    return true;
+}
+
+WeatherImpact metarWeatherImpact(const MetarReport& report)
+{
+    WeatherImpact impact;
+    if (report.hasCloud)
+        impact.cloudCover = report.cloudCoverPct;
+    impact.rainAmount = report.rainMm;
+    if (report.hasTemperature)
+        impact.temperature = report.temperatureC;
+    if (report.hasWind)
+        impact.windSpeed = report.windSpeedKmh;
+
+    applyWeatherFactors(impact);
+    return impact;
+}
+
+MetarFeedReader::MetarFeedReader(const std::string& path, std::int64_t referenceTime)
+{
+    if (std::filesystem::is_directory(path)) {
+        for (const auto& entry : std::filesystem::directory_iterator(path)) {
+            if (entry.is_regular_file())
+                files.push_back(entry.path().string());
+        }
+        std::sort(files.begin(), files.end());
+    }
+    else {
+        files.push_back(path);
+    }
+
+    setReference(floorDiv(referenceTime, 86400));
+}
+
+std::size_t MetarFeedReader::skippedLines() const
+{
+    return skipped;
+}
+
+void MetarFeedReader::setReference(std::int64_t days)
+{
+    civilFromDays(days, referenceYear, referenceMonth, referenceDay);
+}
+
+bool MetarFeedReader::nextLine(std::string_view& line)
+{
+    while (offset >= text.size()) {
+        if (fileIndex >= files.size())
+            return false;
+
+        file = std::make_unique<MappedFile>(files[fileIndex++]);
+        text = file->text();
+        offset = 0;
+    }
+
+    const char* start = text.data() + offset;
+    const void* newline = std::memchr(start, '\n', text.size() - offset);
+    std::size_t length = newline == nullptr ? text.size() - offset
+                                            : static_cast<std::size_t>(static_cast<const char*>(newline) - start);
+
+    line = std::string_view(start, length);
+    offset += length + 1;
+
+    if (!line.empty() && line.back() == '\r')
+        line.remove_suffix(1);
+    return true;
+}
+
+std::int64_t MetarFeedReader::resolveTime(const MetarReport& report) const
+{
+    int year = referenceYear;
+    int month = referenceMonth;
+
+    // Um dia de folga para relatorio de logo depois da meia-noite UTC.
+    if (report.day > referenceDay + 1) {
+        month--;
+        if (month == 0) {
+            month = 12;
+            year--;
+        }
+    }
+
+    return daysFromCivil(year, static_cast<unsigned>(month), static_cast<unsigned>(report.day)) * 86400 +
+           report.hour * 3600 + report.minute * 60;
+}
+
+bool MetarFeedReader::next(MetarReport& report)
+{
+    std::string_view line;
+
+    while (nextLine(line)) {
+        if (line.empty())
+            continue;
+
+        // CSV: o relatorio e o ultimo campo; a data, o primeiro campo que parecer data.
+        std::size_t lastComma = line.rfind(',');
+        if (lastComma != std::string_view::npos) {
+            std::string_view fields = line.substr(0, lastComma);
+            line = line.substr(lastComma + 1);
+
+            std::size_t start = 0;
+            while (start <= fields.size()) {
+                std::size_t comma = fields.find(',', start);
+                std::string_view field = fields.substr(start, comma == std::string_view::npos ? std::string_view::npos : comma - start);
+                if (!field.empty() && field.front() == '"')
+                    field.remove_prefix(1);
+
+                int year = 0;
+                int month = 0;
+                int day = 0;
+                if (parseDate(field, year, month, day)) {
+                    setReference(daysFromCivil(year, static_cast<unsigned>(month), static_cast<unsigned>(day)));
+                    break;
+                }
+                if (comma == std::string_view::npos)
+                    break;
+                start = comma + 1;
+            }
+
+            if (!line.empty() && line.front() == '"')
+                line.remove_prefix(1);
+            if (!line.empty() && line.back() == '"')
+                line.remove_suffix(1);
+        }
+        else {
+            // NOAA: "AAAA/MM/DD HH:MM" sozinha numa linha, antes do relatorio.
+            int year = 0;
+            int month = 0;
+            int day = 0;
+            if (parseDate(line, year, month, day)) {
+                setReference(daysFromCivil(year, static_cast<unsigned>(month), static_cast<unsigned>(day)));
+                continue;
+            }
+        }
+
+        if (!parseMetar(line, report)) {
+            skipped++;
+            continue;
+        }
+
+        report.time = resolveTime(report);
+        return true;
+    }
+
+    return false;
+}
+
+namespace
+{
+    // Tamanho e data de modificacao de um arquivo do feed.
+    struct MetarFileStamp
+    {
+        std::string name;
+        std::uintmax_t size = 0;
+        std::filesystem::file_time_type modified;
+
+        bool operator==(const MetarFileStamp& other) const
+        {
+            return name == other.name && size == other.size && modified == other.modified;
+        }
+    };
+
+    // O daemon pergunta pelo mesmo feed a cada execucao, e o arquivo (ou a pasta)
+    // so muda quando chega relatorio novo, de 30 em 30 minutos. Entao eu guardo os
+    // relatorios da estacao da ultima varredura e so leio tudo de novo quando muda
+    // a lista de arquivos, o tamanho ou a data de algum, ou o dia de referencia
+    // (que decide o mes e o ano dos relatorios sem data).
+    struct MetarScanCache
+    {
+        std::string path;
+        std::string station;
+        std::int64_t referenceDays = 0;
+        std::vector<MetarFileStamp> stamps;
+        std::vector<MetarReport> reports;
+        bool valid = false;
+    };
+
+    std::mutex metarCacheMutex;
+    MetarScanCache metarCache;
+
+    // false se algum arquivo nao der para ler: ai eu nao uso cache e a
+    // varredura completa reclama do jeito de sempre.
+    bool stampFeed(const std::string& path, std::vector<MetarFileStamp>& stamps)
+    {
+        std::error_code error;
+        std::vector<std::string> names;
+        if (std::filesystem::is_directory(path, error)) {
+            for (const auto& entry : std::filesystem::directory_iterator(path, error)) {
+                if (entry.is_regular_file(error))
+                    names.push_back(entry.path().string());
+            }
+            if (error)
+                return false;
+            std::sort(names.begin(), names.end());
+        }
+        else {
+            names.push_back(path);
+        }
+
+        stamps.clear();
+        for (const std::string& name : names) {
+            MetarFileStamp stamp;
+            stamp.name = name;
+            stamp.size = std::filesystem::file_size(name, error);
+            if (error)
+                return false;
+            stamp.modified = std::filesystem::last_write_time(name, error);
+            if (error)
+                return false;
+            stamps.push_back(std::move(stamp));
+        }
+        return true;
+    }
+}
+
+bool latestMetar(const std::string& path, std::string_view station, std::int64_t now, MetarReport& report)
+{
+    std::lock_guard<std::mutex> lock(metarCacheMutex);
+
+    std::int64_t referenceDays = floorDiv(now, 86400);
+    std::vector<MetarFileStamp> stamps;
+    bool stamped = stampFeed(path, stamps);
+
+    bool fresh = stamped && metarCache.valid && metarCache.path == path &&
+                 metarCache.station == station && metarCache.referenceDays == referenceDays &&
+                 metarCache.stamps == stamps;
+
+    if (!fresh) {
+        metarCache.valid = false;
+        metarCache.reports.clear();
+
+        MetarFeedReader reader(path, now);
+        MetarReport candidate;
+        while (reader.next(candidate)) {
+            if (candidate.isStation(station))
+                metarCache.reports.push_back(candidate);
+        }
+
+        metarCache.path = path;
+        metarCache.station = std::string(station);
+        metarCache.referenceDays = referenceDays;
+        metarCache.stamps = std::move(stamps);
+        metarCache.valid = stamped;
+    }
+
+    bool found = false;
+    for (const MetarReport& candidate : metarCache.reports) {
+        if (candidate.time > now + 300)
+            continue;
+        if (!found || candidate.time >= report.time) {
+            report = candidate;
+            found = true;
+        }
+    }
+
+    return found;
+}
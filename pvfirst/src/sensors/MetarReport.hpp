@@ -0,0 +1,112 @@
+#pragma once
+
+#include "MetarSensor.hpp"
+#include "storage/MappedFile.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Leitura de METAR/SPECI de verdade, o texto que os aeroportos publicam
+// a cada 30 ou 60 minutos:
+//
+//   SBBE 211200Z 09008KT 9999 -RA FEW015 SCT030CB BKN100 27/24 Q1012
+//
+// Do relatorio eu uso vento, tempo presente, camadas de nuvem e temperatura.
+// Nos grupos de RMK (estacoes americanas), Pnnnn e a chuva da ultima hora
+// em centesimos de polegada e Tsnnnsnnn a temperatura em decimos.
+//
+// O parser anda pelo texto com string_view, sem alocar nada: da para passar
+// arquivos historicos inteiros (backtest) na casa dos milhoes de relatorios
+// por segundo.
+struct MetarReport
+{
+    char station[5] = {}; // codigo ICAO com '\0' no fim
+
+    // Grupo DDHHMMZ, em UTC. O mes e o ano nao vem no relatorio.
+    int day = 0;
+    int hour = 0;
+    int minute = 0;
+
+    // Segundos desde 1970 (UTC). So o MetarFeedReader preenche,
+    // porque precisa de uma data de referencia para achar mes e ano.
+    std::int64_t time = 0;
+
+    bool hasWind = false;
+    double windSpeedKmh = 0.0;
+    double windGustKmh = 0.0;
+
+    bool hasTemperature = false;
+    double temperatureC = 0.0;
+    double dewPointC = 0.0;
+
+    // Cobertura total do ceu (%). As camadas do METAR ja sao acumuladas
+    // (cada uma diz quanto do ceu esta coberto ate aquela altura), entao
+    // o total e a maior delas: FEW 1-2 oitavos, SCT 3-4, BKN 5-7, OVC e VV 8.
+    // CAVOK, SKC, CLR, NSC e NCD contam como ceu limpo.
+    bool hasCloud = false;
+    double cloudCoverPct = 0.0;
+    int cloudLayers = 0;
+
+    // Chuva em mm/h. Sem o grupo P do RMK, e uma estimativa pela intensidade
+    // do tempo presente (-RA, RA, +RA...) nas mesmas faixas de applyWeatherFactors.
+    bool precipitation = false;
+    bool measuredRain = false;
+    double rainMm = 0.0;
+
+    // Compara o codigo da estacao (ex.: "SBBE").
+    bool isStation(std::string_view code) const;
+};
+
+// Le um relatorio. Aceita o prefixo METAR/SPECI e o '=' do fim.
+// false se nao tiver estacao e hora, ou se for NIL.
+bool parseMetar(std::string_view text, MetarReport& report);
+
+// Leituras do relatorio no formato do modelo, com os fatores ja calculados.
+// O que o relatorio nao trouxe fica com o valor padrao de WeatherImpact.
+WeatherImpact metarWeatherImpact(const MetarReport& report);
+
+// Relatorios de um arquivo ou de uma pasta (todos os arquivos dela, em ordem de nome).
+//
+// Um relatorio por linha. Tambem entende os dois formatos mais comuns de arquivo historico:
+// - NOAA (tgftp): uma linha "AAAA/MM/DD HH:MM" antes de cada relatorio;
+// - CSV (Iowa Mesonet, Ogimet): o relatorio no ultimo campo, a data num campo anterior.
+// A data dessas linhas da o mes e o ano; sem ela, vale a data de referencia do construtor.
+// O dia do relatorio maior que o dia da referencia quer dizer mes anterior.
+class MetarFeedReader
+{
+public:
+    MetarFeedReader(const std::string& path, std::int64_t referenceTime);
+
+    // false no fim do ultimo arquivo. Linhas que nao sao relatorio sao puladas.
+    bool next(MetarReport& report);
+
+    std::size_t skippedLines() const;
+
+private:
+    bool nextLine(std::string_view& line);
+    void setReference(std::int64_t days);
+    std::int64_t resolveTime(const MetarReport& report) const;
+
+    std::vector<std::string> files;
+    std::size_t fileIndex = 0;
+    std::unique_ptr<MappedFile> file;
+    std::string_view text;
+    std::size_t offset = 0;
+
+    int referenceYear = 1970;
+    int referenceMonth = 1;
+    int referenceDay = 1;
+
+    std::size_t skipped = 0;
+};
+
+// Relatorio mais novo da estacao ate now (com 5 minutos de folga para relogio adiantado).
+// false se a estacao nao aparece no arquivo ou na pasta.
+//
+// Os relatorios da estacao ficam em cache no processo: enquanto nenhum arquivo
+// mudar de tamanho ou de data (e o dia for o mesmo), nao le o feed de novo.
+bool latestMetar(const std::string& path, std::string_view station, std::int64_t now, MetarReport& report);
@@ -1,4 +1,10 @@
 #pragma once
+#include "HttpClient.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
 
 struct WeatherImpact
 {
@@ -13,8 +19,43 @@ struct WeatherImpact
     double windSpeed   = 0.0;
 };
 
+// Uma hora da previsao do open-meteo.
+struct ForecastHour
+{
+    std::int64_t time = 0; // inicio da hora, segundos desde 1970 (UTC)
+    double cloudCoverPct = 0.0;
+    double rainMm = 0.0;
+    double temperatureC = 0.0;
+    double windSpeedKmh = 0.0;
+};
+
+// Apesar do nome, aqui o clima vem do open-meteo (modelo numerico), nao de um
+// METAR. O relatorio de verdade da estacao e lido em MetarReport.hpp.
 class MetarSensor {
 public:
-    WeatherImpact getWeatherImpact(double latitude,
-                                   double longitude);
+    MetarSensor();
+    explicit MetarSensor(HttpFetcher fetcher);
+
+    // Uma consulta so ao open-meteo, esperando no maximo timeout.
+    // Com forecast preenchido, pede junto a previsao horaria dos proximos dias;
+    // a lista fica vazia se a previsao nao vier inteira.
+    // false se a API nao respondeu ou a resposta nao tem o bloco "current".
+    bool fetchWeather(double latitude,
+                      double longitude,
+                      std::chrono::milliseconds timeout,
+                      WeatherImpact& impact,
+                      std::vector<ForecastHour>* forecast = nullptr);
+
+    // Uma consulta so para count coordenadas (o open-meteo aceita as listas separadas por virgula).
+    // Acrescenta em impacts um WeatherImpact por coordenada, na mesma ordem.
+    // false se a API nao respondeu ou nao veio um bloco "current" para cada coordenada;
+    // nesse caso impacts fica como estava.
+    bool fetchWeatherBatch(const double* latitudes,
+                           const double* longitudes,
+                           std::size_t count,
+                           std::chrono::milliseconds timeout,
+                           std::vector<WeatherImpact>& impacts);
+
+private:
+    HttpFetcher fetcher;
 };
@@ -0,0 +1,210 @@
+#include "PlaneOfArray.hpp"
+
+#include "storage/CsvScanner.hpp"
+#include "storage/MappedFile.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <stdexcept>
+#include <string_view>
+
+namespace
+{
+    const double solarConstantWm2 = 1367.0;
+
+    bool parseNumber(std::string_view text, double& value)
+    {
+        std::from_chars_result result = std::from_chars(text.data(), text.data() + text.size(), value);
+        return result.ec == std::errc() && result.ptr == text.data() + text.size();
+    }
+
+    // Um ponto do perfil do horizonte: ate onde tapa (top) e de onde comeca (base).
+    struct HorizonPoint
+    {
+        double azimuth = 0.0;
+        double top = 0.0;
+        double base = 0.0;
+    };
+
+    // Fracao da luz global que chega difusa, pelo indice de claridade (Erbs, 1982).
+    double erbsDiffuseFraction(double clearnessIndex)
+    {
+        if (clearnessIndex <= 0.22)
+            return 1.0 - 0.09 * clearnessIndex;
+
+        if (clearnessIndex <= 0.80) {
+            double k = clearnessIndex;
+            return 0.9511 + k * (-0.1604 + k * (4.388 + k * (-16.638 + k * 12.336)));
+        }
+
+        return 0.165;
+    }
+
+    double squaredSinDeg(double degrees)
+    {
+        double s = std::sin(degrees * M_PI / 180.0);
+        return s * s;
+    }
+}
+
+HorizonMask HorizonMask::loadCsv(const std::string& path)
+{
+    MappedFile file(path);
+    std::string_view text = file.text();
+
+    std::size_t headerEnd = text.find('\n');
+    if (headerEnd == std::string_view::npos || text.substr(0, headerEnd).find("azimuth;elevation") != 0)
+        throw std::runtime_error("O arquivo de horizonte nao tem o cabecalho azimuth;elevation: " + path);
+
+    std::vector<HorizonPoint> points;
+    CsvScanner scanner(text.substr(headerEnd + 1));
+    std::string_view fields[3];
+    std::size_t fieldCount = 0;
+    std::size_t line = 1;
+
+    while (scanner.nextLine(fields, 3, fieldCount)) {
+        line++;
+
+        if (fieldCount == 1 && fields[0].empty())
+            continue;
+
+        HorizonPoint point;
+        bool valid = (fieldCount == 2 || fieldCount == 3) &&
+                     parseNumber(fields[0], point.azimuth) && parseNumber(fields[1], point.top) &&
+                     (fieldCount == 2 || fields[2].empty() || parseNumber(fields[2], point.base)) &&
+                     point.azimuth >= 0.0 && point.azimuth < 360.0 &&
+                     point.base >= 0.0 && point.top >= point.base && point.top <= 90.0;
+
+        if (!valid)
+            throw std::runtime_error("Linha invalida no arquivo de horizonte " + path +
+                                     " (linha " + std::to_string(line) + ")");
+
+        if (!points.empty() && point.azimuth <= points.back().azimuth)
+            throw std::runtime_error("O arquivo de horizonte precisa estar em ordem de azimute " + path +
+                                     " (linha " + std::to_string(line) + ")");
+
+        points.push_back(point);
+    }
+
+    if (points.empty())
+        throw std::runtime_error("O arquivo de horizonte nao tem nenhum ponto: " + path);
+
+    HorizonMask mask;
+    mask.bits.assign(azimuthBins * 2, 0);
+
+    double blocked = 0.0;
+    std::size_t next = 0;
+
+    for (int azimuth = 0; azimuth < azimuthBins; azimuth++) {
+        // Centro da faixa de 1 grau; o trecho do perfil e o que comeca no ultimo ponto antes dele.
+        double center = azimuth + 0.5;
+        while (next < points.size() && points[next].azimuth <= center)
+            next++;
+
+        const HorizonPoint& before = points[(next + points.size() - 1) % points.size()];
+        const HorizonPoint& after = points[next % points.size()];
+
+        double from = before.azimuth;
+        double to = after.azimuth;
+        double at = center;
+        if (next == 0)
+            from -= 360.0;
+        if (next == points.size())
+            to += 360.0;
+
+        double weight = to > from ? (at - from) / (to - from) : 0.0;
+        double top = before.top + (after.top - before.top) * weight;
+        double base = before.base + (after.base - before.base) * weight;
+
+        for (int elevation = 0; elevation < elevationBins; elevation++) {
+            double middle = elevation + 0.5;
+            if (middle < base || middle > top)
+                continue;
+
+            mask.bits[azimuth * 2 + elevation / 64] |= std::uint64_t(1) << (elevation % 64);
+
+            // Peso de uma faixa do ceu isotropico numa superficie horizontal: d(sen^2 da altura).
+            blocked += (squaredSinDeg(elevation + 1.0) - squaredSinDeg(elevation)) / azimuthBins;
+        }
+    }
+
+    mask.skyView = 1.0 - blocked;
+    return mask;
+}
+
+bool HorizonMask::empty() const
+{
+    return bits.empty();
+}
+
+bool HorizonMask::shades(const SunVector& sun) const
+{
+    if (bits.empty())
+        return false;
+
+    double azimuthDeg = std::atan2(sun.east, sun.north) * 180.0 / M_PI;
+    if (azimuthDeg < 0.0)
+        azimuthDeg += 360.0;
+    double elevationDeg = std::asin(std::min(sun.up, 1.0)) * 180.0 / M_PI;
+
+    int azimuth = std::min(static_cast<int>(azimuthDeg), azimuthBins - 1);
+    int elevation = std::min(static_cast<int>(elevationDeg), elevationBins - 1);
+
+    return (bits[azimuth * 2 + elevation / 64] >> (elevation % 64)) & 1;
+}
+
+double HorizonMask::skyViewFactor() const
+{
+    return skyView;
+}
+
+PlaneOfArray::PlaneOfArray(const ArrayOrientation& orientation, const HorizonMask* mask)
+    : mask(mask != nullptr && !mask->empty() ? mask : nullptr)
+{
+    double tilt = orientation.tiltDeg * M_PI / 180.0;
+    double azimuth = orientation.azimuthDeg * M_PI / 180.0;
+
+    normal.east = std::sin(tilt) * std::sin(azimuth);
+    normal.north = std::sin(tilt) * std::cos(azimuth);
+    normal.up = std::cos(tilt);
+
+    diffuseFactor = (1.0 + normal.up) / 2.0;
+    groundFactor = orientation.albedo * (1.0 - normal.up) / 2.0;
+    if (this->mask != nullptr)
+        diffuseFactor *= this->mask->skyViewFactor();
+
+    flat = orientation.tiltDeg == 0.0 && this->mask == nullptr;
+}
+
+bool PlaneOfArray::horizontal() const
+{
+    return flat;
+}
+
+PoaIrradiance PlaneOfArray::transpose(double ghiWm2, const SunVector& sun, int dayOfYear) const
+{
+    PoaIrradiance poa;
+    if (ghiWm2 <= 0.0 || sun.up <= 0.0)
+        return poa;
+
+    // Extraterrestre na direcao do sol, com a distancia Terra-Sol do dia.
+    double extraterrestrialWm2 = solarConstantWm2 * (1.0 + 0.033 * std::cos(2.0 * M_PI * dayOfYear / 365.0));
+    double clearnessIndex = ghiWm2 / (extraterrestrialWm2 * sun.up);
+
+    double diffuseHorizontalWm2 = ghiWm2 * erbsDiffuseFraction(clearnessIndex);
+
+    // Com o sol rasante, dividir por sun.up explode: a direta nunca passa da extraterrestre.
+    double directNormalWm2 = std::min((ghiWm2 - diffuseHorizontalWm2) / sun.up, extraterrestrialWm2);
+
+    double cosIncidence = normal.east * sun.east + normal.north * sun.north + normal.up * sun.up;
+
+    poa.shaded = mask != nullptr && mask->shades(sun);
+    if (cosIncidence > 0.0 && !poa.shaded)
+        poa.beamWm2 = directNormalWm2 * cosIncidence;
+
+    poa.diffuseWm2 = diffuseHorizontalWm2 * diffuseFactor;
+    poa.groundWm2 = ghiWm2 * groundFactor;
+    poa.totalWm2 = poa.beamWm2 + poa.diffuseWm2 + poa.groundWm2;
+    return poa;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "SolarModel.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Onde o sol fica escondido para um sitio: predios, morros, arvores, beiral.
+//
+// Arquivo de ponto e virgula, azimute e altura em graus (azimute a partir do
+// norte, sentido horario: 90 e leste, 180 e sul):
+//   azimuth;elevation;elevation_base
+//   59;0
+//   60;25                  (predio a leste: de 60 a 120 graus, tapa do horizonte ate 25 graus)
+//   120;25
+//   121;0
+//   180;0
+//   181;70;40              (beiral ao sul: tapa so a faixa de 40 a 70 graus)
+//   240;70;40
+//   241;0
+//
+// Entre dois pontos a altura muda em linha reta, dando a volta no norte
+// (do ultimo ponto para o primeiro). elevation_base e opcional
+// (0: a obstrucao vai ate o horizonte). Azimutes em ordem crescente.
+//
+// O perfil e resolvido uma vez so numa tabela de bits de 1 grau por 1 grau
+// (360 azimutes x 90 alturas, 5,6 KB): ver se o sol esta tapado e uma leitura
+// de tabela, sem procurar nada no perfil.
+class HorizonMask
+{
+public:
+    static HorizonMask loadCsv(const std::string& path);
+
+    // Sem tabela: nada tapa o sol.
+    bool empty() const;
+
+    // O sol precisa estar acima do horizonte (sun.up > 0).
+    bool shades(const SunVector& sun) const;
+
+    // Parte do ceu (difuso isotropico, visto de uma superficie horizontal) que
+    // continua visivel com as obstrucoes. 1 sem mascara.
+    double skyViewFactor() const;
+
+private:
+    static const int azimuthBins = 360;
+    static const int elevationBins = 90;
+
+    // Dois words por azimute: bit e da altura e (0 a 89 graus).
+    std::vector<std::uint64_t> bits;
+    double skyView = 1.0;
+};
+
+// Orientacao do arranjo e refletancia do chao em volta dele.
+// Inclinacao 0 e o painel deitado, que e o que o SolarModel sempre calculou.
+struct ArrayOrientation
+{
+    double tiltDeg = 0.0;
+    double azimuthDeg = 0.0;
+    double albedo = 0.2;
+};
+
+struct PoaIrradiance
+{
+    double beamWm2 = 0.0;
+    double diffuseWm2 = 0.0;
+    double groundWm2 = 0.0;
+    double totalWm2 = 0.0;
+    bool shaded = false;
+};
+
+// Irradiancia no plano do arranjo a partir da global horizontal (GHI).
+//
+// A GHI e separada em direta e difusa pela correlacao de Erbs (o quanto da luz
+// e difusa depende do indice de claridade, GHI / extraterrestre). Depois:
+// - direta: DNI x cosseno do angulo entre o sol e a normal do painel,
+//   zerada quando a mascara de horizonte tapa o sol;
+// - difusa: ceu isotropico, (1 + cos inclinacao) / 2, vezes o ceu que a mascara deixa ver;
+// - chao: GHI x albedo x (1 - cos inclinacao) / 2.
+//
+// Tudo o que depende so do arranjo (normal, fatores de vista) e calculado no
+// construtor; por amostra sobram umas multiplicacoes, o polinomio de Erbs e,
+// com mascara, a leitura da tabela.
+class PlaneOfArray
+{
+public:
+    // mask pode ser nulo. Se nao for, precisa durar tanto quanto este objeto.
+    explicit PlaneOfArray(const ArrayOrientation& orientation, const HorizonMask* mask = nullptr);
+
+    // Painel deitado e sem mascara: a conta devolveria a propria GHI,
+    // entao quem chama pode pular a transposicao.
+    bool horizontal() const;
+
+    PoaIrradiance transpose(double ghiWm2, const SunVector& sun, int dayOfYear) const;
+
+private:
+    SunVector normal;
+    double diffuseFactor = 1.0;
+    double groundFactor = 0.0;
+    const HorizonMask* mask = nullptr;
+    bool flat = true;
+};
@@ -0,0 +1,98 @@
+#include "RampDetector.hpp"
+
+#include <algorithm>
+
+const char* rampDirectionName(RampDirection direction)
+{
+    return direction == RampDirection::Up ? "subida" : "descida";
+}
+
+double rampMinimumLevel(StreamQuantity quantity, double peakKW)
+{
+    const double minimumWm2 = 50.0;
+    if (quantity == StreamQuantity::PvPower)
+        return peakKW * minimumWm2 / 1000.0;
+    return minimumWm2;
+}
+
+// Janela de pelo menos 1 ns: com zero, a propria amostra nova sairia das filas
+// e o front() abaixo leria uma fila vazia.
+RampDetector::RampDetector(const RampConfig& config)
+    : config(config),
+      windowNs(std::max<std::int64_t>(static_cast<std::int64_t>(config.windowSeconds * 1e9), 1))
+{
+}
+
+bool RampDetector::observe(const StreamSample& sample, RampEvent& event)
+{
+    // Quem e menor ou igual a amostra nova nunca mais vai ser o maximo da janela.
+    while (!maxQueue.empty() && maxQueue.back().value <= sample.value)
+        maxQueue.pop_back();
+    maxQueue.push_back(sample);
+
+    while (!minQueue.empty() && minQueue.back().value >= sample.value)
+        minQueue.pop_back();
+    minQueue.push_back(sample);
+
+    std::int64_t startNs = sample.timeNs - windowNs;
+    while (maxQueue.front().timeNs <= startNs)
+        maxQueue.pop_front();
+    while (minQueue.front().timeNs <= startNs)
+        minQueue.pop_front();
+
+    const StreamSample& highest = maxQueue.front();
+    const StreamSample& lowest = minQueue.front();
+
+    bool down = highest.timeNs < sample.timeNs &&
+                highest.value >= config.minimumLevel &&
+                highest.value - sample.value >= config.thresholdFraction * highest.value;
+
+    bool up = !down &&
+              lowest.timeNs < sample.timeNs &&
+              sample.value >= config.minimumLevel &&
+              sample.value - lowest.value >= config.thresholdFraction * sample.value;
+
+    if (!down && !up)
+        return false;
+
+    const StreamSample& from = down ? highest : lowest;
+    event.direction = down ? RampDirection::Down : RampDirection::Up;
+    event.startNs = from.timeNs;
+    event.endNs = sample.timeNs;
+    event.from = from.value;
+    event.to = sample.value;
+
+    // A janela recomeca daqui: a proxima rampa tem que partir do valor novo.
+    maxQueue.clear();
+    minQueue.clear();
+    maxQueue.push_back(sample);
+    minQueue.push_back(sample);
+    return true;
+}
+
+void RampSignal::post(const RampEvent& event)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending = true;
+        last = event;
+    }
+    wake.notify_all();
+}
+
+bool RampSignal::waitUntil(std::chrono::steady_clock::time_point deadline, RampEvent& event)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!wake.wait_until(lock, deadline, [this]() { return pending; }))
+        return false;
+
+    pending = false;
+    event = last;
+    return true;
+}
+
+void RampSignal::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    pending = false;
+}
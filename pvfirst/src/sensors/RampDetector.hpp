@@ -0,0 +1,97 @@
+#pragma once
+
+#include "IrradianceStream.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+enum class RampDirection : std::uint8_t
+{
+    Up,
+    Down
+};
+
+// "subida" ou "descida".
+const char* rampDirectionName(RampDirection direction);
+
+// Uma borda de nuvem: o valor saiu de from para to entre startNs e endNs.
+struct RampEvent
+{
+    RampDirection direction = RampDirection::Down;
+    std::int64_t startNs = 0;
+    std::int64_t endNs = 0;
+    double from = 0.0;
+    double to = 0.0;
+};
+
+struct RampConfig
+{
+    // Tamanho da janela olhada para tras a cada amostra.
+    double windowSeconds = 30.0;
+
+    // Variacao minima, como fracao do maior dos dois valores (0,3 = 30%).
+    double thresholdFraction = 0.3;
+
+    // Abaixo disso (W/m2 ou kW, a mesma unidade do medidor) e amanhecer,
+    // anoitecer ou ruido do sensor: nao conta como rampa.
+    // O padrao e de irradiancia; para o inversor, ver rampMinimumLevel.
+    double minimumLevel = 50.0;
+};
+
+// Piso padrao das rampas na unidade do medidor: 50 W/m2 na irradiancia, ou
+// a potencia que um arranjo de peakKW (a 1000 W/m2) daria com 50 W/m2.
+double rampMinimumLevel(StreamQuantity quantity, double peakKW);
+
+// Detector de rampas no medidor local, uma amostra por vez.
+//
+// Uma borda de nuvem sobre Belem derruba a PV em 70% em poucos segundos, e o
+// clima de minuto em minuto nao ve isso. Aqui cada amostra e comparada com o
+// maior e o menor valor da janela: caiu threshold abaixo do maximo, e rampa de
+// descida; subiu threshold acima do minimo, e rampa de subida.
+//
+// Maximo e minimo vem de duas filas monotonicas (a do maximo so guarda valores
+// decrescentes, a do minimo crescentes): cada amostra entra e sai de cada fila
+// uma vez so, entao o custo por amostra e O(1) amortizado, qualquer que seja a janela.
+//
+// Depois de uma rampa a janela recomeca da amostra atual, entao a mesma borda
+// nao dispara de novo a cada amostra seguinte.
+class RampDetector
+{
+public:
+    explicit RampDetector(const RampConfig& config);
+
+    // true quando esta amostra fecha uma rampa (preenche event).
+    bool observe(const StreamSample& sample, RampEvent& event);
+
+private:
+    RampConfig config;
+    std::int64_t windowNs;
+
+    std::deque<StreamSample> maxQueue;
+    std::deque<StreamSample> minQueue;
+};
+
+// Aviso de rampa para quem esta esperando (o laco do daemon).
+// post() e chamado da thread do medidor; o daemon espera em waitUntil()
+// no lugar do sleep_until, e acorda na hora quando chega uma rampa.
+class RampSignal
+{
+public:
+    void post(const RampEvent& event);
+
+    // true se acordou por uma rampa (a mais recente vai em event),
+    // false quando chegou em deadline sem nenhuma.
+    bool waitUntil(std::chrono::steady_clock::time_point deadline, RampEvent& event);
+
+    // Descarta a rampa ainda nao atendida (ex.: a do fim da tarde, depois da noite).
+    void clear();
+
+private:
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool pending = false;
+    RampEvent last;
+};
@@ -0,0 +1,159 @@
+#include "SensorFallback.hpp"
+#include "SensorPayloads.hpp"
+#include "metrics/Metrics.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    std::chrono::milliseconds timeLeft(std::chrono::steady_clock::time_point deadline)
+    {
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now());
+        return std::max(left, std::chrono::milliseconds(0));
+    }
+
+    void countSource(std::array<Counter, sensorSourceCount>& counters, SensorSource source)
+    {
+        counters[static_cast<std::size_t>(source)].inc();
+    }
+}
+
+SensorFallback::SensorFallback(HttpFetcher fetcher, const std::string& statePath)
+    : fetcher(std::move(fetcher)),
+      statePath(statePath),
+      state(SensorState::load(statePath))
+{
+}
+
+void SensorFallback::setMetarFeed(const std::string& path, const std::string& station)
+{
+    metarPath = path;
+    metarStation = station;
+}
+
+LocationReading SensorFallback::location(std::int64_t now, std::chrono::steady_clock::time_point deadline)
+{
+    LocationReading reading;
+    PvfirstMetrics& processMetrics = metrics();
+
+    std::chrono::milliseconds budget = std::min(timeLeft(deadline) / 2, requestTimeout);
+
+    if (state.geoBreaker.allowRequest(now) && budget >= minimumAttempt) {
+        GeoSensor geo(fetcher);
+        GPSData gps;
+
+        if (geo.fetchLocation(budget, gps)) {
+            state.geoBreaker.recordSuccess();
+            state.hasLocation = true;
+            state.locationTime = now;
+            state.location = gps;
+
+            reading.gps = gps;
+            reading.source = SensorSource::Api;
+        }
+        else {
+            state.geoBreaker.recordFailure(now);
+        }
+    }
+
+    if (reading.source == SensorSource::None) {
+        if (state.hasLocation) {
+            reading.gps = state.location;
+            reading.source = SensorSource::LastKnown;
+        }
+        else {
+            reading.source = SensorSource::Default;
+        }
+
+        std::cerr << "Geolocalizacao indisponivel; usando o local "
+                  << sensorSourceName(reading.source) << " (" << reading.gps.city << ").\n";
+    }
+
+    processMetrics.geoBreakerOpen.set(state.geoBreaker.isOpen(now) ? 1.0 : 0.0);
+    countSource(processMetrics.geoSources, reading.source);
+    return reading;
+}
+
+WeatherReading SensorFallback::weather(double latitude,
+                                       double longitude,
+                                       std::int64_t now,
+                                       std::chrono::steady_clock::time_point deadline)
+{
+    WeatherReading reading;
+    PvfirstMetrics& processMetrics = metrics();
+
+    MetarReport report;
+    if (!metarPath.empty() && latestMetar(metarPath, metarStation, now, report) &&
+        now - report.time <= metarMaxAgeSeconds) {
+        reading.impact = metarWeatherImpact(report);
+        reading.source = SensorSource::Metar;
+
+        state.hasWeather = true;
+        state.weatherTime = report.time;
+        state.weather = reading.impact;
+
+        countSource(processMetrics.weatherSources, reading.source);
+        return reading;
+    }
+
+    std::chrono::milliseconds budget = std::min(timeLeft(deadline), requestTimeout);
+
+    if (state.weatherBreaker.allowRequest(now) && budget >= minimumAttempt) {
+        MetarSensor metar(fetcher);
+        WeatherImpact impact;
+
+        // A previsao so e pedida quando a guardada ja envelheceu:
+        // na maior parte das execucoes a resposta continua pequena.
+        bool refreshForecast = state.forecast.empty() || now - state.forecastTime >= forecastRefreshSeconds;
+        std::vector<ForecastHour> forecast;
+
+        if (metar.fetchWeather(latitude, longitude, budget, impact, refreshForecast ? &forecast : nullptr)) {
+            state.weatherBreaker.recordSuccess();
+            state.hasWeather = true;
+            state.weatherTime = now;
+            state.weather = impact;
+
+            if (!forecast.empty()) {
+                state.forecast = std::move(forecast);
+                state.forecastTime = now;
+            }
+
+            reading.impact = impact;
+            reading.source = SensorSource::Api;
+        }
+        else {
+            state.weatherBreaker.recordFailure(now);
+        }
+    }
+
+    if (reading.source == SensorSource::None) {
+        if (state.forecastAt(now, reading.impact)) {
+            reading.source = SensorSource::Forecast;
+        }
+        else if (state.hasWeather && now - state.weatherTime <= lastWeatherMaxAgeSeconds) {
+            reading.impact = state.weather;
+            reading.source = SensorSource::LastKnown;
+        }
+        else {
+            // Ceu limpo: sem nuvem nem chuva, a irradiancia fica a do SolarModel.
+            reading.impact = WeatherImpact{};
+            applyWeatherFactors(reading.impact);
+            reading.source = SensorSource::Default;
+        }
+
+        std::cerr << "Clima indisponivel; usando a fonte " << sensorSourceName(reading.source) << ".\n";
+    }
+
+    processMetrics.weatherBreakerOpen.set(state.weatherBreaker.isOpen(now) ? 1.0 : 0.0);
+    countSource(processMetrics.weatherSources, reading.source);
+    return reading;
+}
+
+void SensorFallback::save() const
+{
+    state.save(statePath);
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "GeoSensor.hpp"
+#include "HttpClient.hpp"
+#include "MetarReport.hpp"
+#include "MetarSensor.hpp"
+#include "SensorState.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+struct LocationReading
+{
+    GPSData gps;
+    SensorSource source = SensorSource::None;
+};
+
+struct WeatherReading
+{
+    WeatherImpact impact;
+    SensorSource source = SensorSource::None;
+};
+
+// Aqui fica a cadeia de reserva dos sensores.
+//
+// Antes, uma API fora do ar prendia a execucao num laco de 10 em 10 segundos
+// ate ela voltar, e a cadencia de 60 s do experimento escorregava. Agora cada
+// sensor tenta a API uma vez so, dentro do prazo da execucao, e cai para a
+// proxima fonte quando ela nao responde:
+//
+//   local: API -> ultimo local bom -> local padrao do GPSData
+//   clima: API -> previsao horaria guardada -> ultimo clima bom (ate 3 h) -> ceu limpo
+//
+// Com um arquivo (ou pasta) de METAR configurado, o relatorio mais novo da
+// estacao vem antes de tudo no clima, enquanto tiver ate 90 minutos:
+// e uma observacao de verdade e nao depende de rede.
+//
+// Cada API tem um disjuntor (ver CircuitBreaker): depois de algumas falhas
+// seguidas, as execucoes seguintes nem tentam, ate o tempo de espera vencer.
+// O estado fica no arquivo de SensorState, porque cada execucao e um
+// controller novo (e, no run_solar_window.sh, um processo novo).
+class SensorFallback
+{
+public:
+    // Nenhuma consulta espera mais que isso, mesmo com prazo sobrando.
+    static constexpr std::chrono::milliseconds requestTimeout{10000};
+
+    // Com menos tempo que isso ate o prazo, nem vale abrir a conexao.
+    static constexpr std::chrono::milliseconds minimumAttempt{100};
+
+    // Clima mais velho que isso nao serve mais como "ultimo valor".
+    static constexpr std::int64_t lastWeatherMaxAgeSeconds = 3 * 3600;
+
+    // A previsao e pedida de novo quando a guardada tem mais que isso.
+    static constexpr std::int64_t forecastRefreshSeconds = 3600;
+
+    // METAR sai a cada 30 ou 60 minutos; mais velho que isso, a estacao parou de publicar.
+    static constexpr std::int64_t metarMaxAgeSeconds = 90 * 60;
+
+    SensorFallback(HttpFetcher fetcher, const std::string& statePath);
+
+    // Arquivo ou pasta com os METAR e o codigo ICAO da estacao (ver MetarReport.hpp).
+    void setMetarFeed(const std::string& path, const std::string& station);
+
+    // now e a hora da maquina (time_t); deadline e o prazo da execucao.
+    // O local usa no maximo metade do tempo que falta, para sobrar para o clima.
+    LocationReading location(std::int64_t now, std::chrono::steady_clock::time_point deadline);
+    WeatherReading weather(double latitude,
+                           double longitude,
+                           std::int64_t now,
+                           std::chrono::steady_clock::time_point deadline);
+
+    // Grava disjuntores, ultimos valores e previsao para a proxima execucao.
+    void save() const;
+
+private:
+    HttpFetcher fetcher;
+    std::string statePath;
+    SensorState state;
+
+    std::string metarPath;
+    std::string metarStation;
+};
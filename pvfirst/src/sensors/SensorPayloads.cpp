@@ -0,0 +1,275 @@
+#include "SensorPayloads.hpp"
+
+#include <charconv>
+#include <cmath>
+#include <limits>
+#include <string_view>
+
+namespace
+{
+    // Le a lista de numeros de "key":[...] a partir de from.
+    // null entra como NaN; quem chama decide o que fazer com ele.
+    bool extractArray(const std::string& json, std::size_t from, const std::string& key, std::vector<double>& values)
+    {
+        values.clear();
+
+        std::string pattern = "\"" + key + "\":[";
+        std::size_t pos = json.find(pattern, from);
+        if (pos == std::string::npos)
+            return false;
+        pos += pattern.size();
+
+        const char* end = json.data() + json.size();
+        const char* cursor = json.data() + pos;
+
+        while (cursor < end) {
+            while (cursor < end && (*cursor == ' ' || *cursor == ','))
+                cursor++;
+            if (cursor >= end)
+                return false;
+            if (*cursor == ']')
+                return true;
+
+            if (end - cursor >= 4 && std::string_view(cursor, 4) == "null") {
+                values.push_back(std::numeric_limits<double>::quiet_NaN());
+                cursor += 4;
+                continue;
+            }
+
+            double value = 0.0;
+            std::from_chars_result result = std::from_chars(cursor, end, value);
+            if (result.ec != std::errc())
+                return false;
+            values.push_back(value);
+            cursor = result.ptr;
+        }
+
+        return false;
+    }
+
+    // Numero de "key": dentro de [from, to) da resposta.
+    double extractValueIn(const std::string& json, std::size_t from, std::size_t to,
+                          std::string_view key, double defaultValue)
+    {
+        // A busca fica presa no bloco: chave que falta nao faz ler o resto da resposta.
+        std::string_view block(json.data() + from, to - from);
+
+        std::size_t keyPos = block.find(key);
+        if (keyPos == std::string_view::npos)
+            return defaultValue;
+
+        std::size_t start = block.find(':', keyPos + key.size());
+        if (start == std::string_view::npos)
+            return defaultValue;
+        start++;
+
+        while (start < block.size() && block[start] == ' ')
+            start++;
+
+        double value = defaultValue;
+        std::from_chars_result result = std::from_chars(block.data() + start, block.data() + block.size(), value);
+        return result.ec == std::errc() ? value : defaultValue;
+    }
+}
+
+double extractNumber(const std::string& json, const std::string& key, double defaultValue)
+{
+    auto keyPos = json.find(key);
+    if (keyPos == std::string::npos)
+        return defaultValue;
+
+    auto start = json.find(":", keyPos);
+    if (start == std::string::npos)
+        return defaultValue;
+
+    start++;
+    auto end = json.find_first_of(",}", start);
+
+    try {
+        return std::stod(json.substr(start, end - start));
+    }
+    catch (...) {
+        return defaultValue;
+    }
+}
+
+std::string extractText(const std::string& json, const std::string& keyPrefix, const std::string& defaultValue)
+{
+    auto keyPos = json.find(keyPrefix);
+    if (keyPos == std::string::npos)
+        return defaultValue;
+
+    auto start = keyPos + keyPrefix.size();
+    auto end = json.find('"', start);
+    if (end == std::string::npos)
+        return defaultValue;
+
+    return json.substr(start, end - start);
+}
+
+double extractCurrentValue(const std::string& json,
+                           const std::string& key,
+                           double defaultValue)
+{
+    auto currentPos = json.find("\"current\"");
+    if (currentPos == std::string::npos)
+        return defaultValue;
+
+    auto keyPos = json.find(key, currentPos);
+    if (keyPos == std::string::npos)
+        return defaultValue;
+
+    auto start = json.find(":", keyPos);
+    if (start == std::string::npos)
+        return defaultValue;
+
+    start++;
+    auto end = json.find_first_of(",}", start);
+
+    try {
+        return std::stod(json.substr(start, end - start));
+    }
+    catch (...) {
+        return defaultValue;
+    }
+}
+
+bool hasValidLocationPayload(const std::string& response)
+{
+    return response.find("\"lat\"") != std::string::npos &&
+           response.find("\"lon\"") != std::string::npos;
+}
+
+bool hasValidWeatherPayload(const std::string& response)
+{
+    return response.find("\"current\"") != std::string::npos &&
+           response.find("temperature_2m") != std::string::npos;
+}
+
+GPSData parseLocationPayload(const std::string& response, const GPSData& fallback)
+{
+    GPSData gps = fallback;
+    gps.latitude  = extractNumber(response, "\"lat\"", gps.latitude);
+    gps.longitude = extractNumber(response, "\"lon\"", gps.longitude);
+    gps.city      = extractText(response, "\"city\":\"", gps.city);
+    return gps;
+}
+
+WeatherImpact parseWeatherPayload(const std::string& response)
+{
+    WeatherImpact impact;
+    impact.temperature = extractCurrentValue(response, "temperature_2m", impact.temperature);
+    impact.cloudCover  = extractCurrentValue(response, "cloudcover", impact.cloudCover);
+    impact.rainAmount  = extractCurrentValue(response, "precipitation", impact.rainAmount);
+    impact.windSpeed   = extractCurrentValue(response, "windspeed_10m", impact.windSpeed);
+
+    applyWeatherFactors(impact);
+    return impact;
+}
+
+std::size_t parseWeatherBatchPayload(const std::string& response, std::vector<WeatherImpact>& impacts)
+{
+    // "current": com as aspas e os dois pontos nao casa com "current_units".
+    // Cada busca continua de onde a anterior parou: a resposta e lida uma vez so,
+    // qualquer que seja o numero de sitios.
+    const std::string marker = "\"current\":{";
+    std::size_t count = 0;
+    std::size_t pos = response.find(marker);
+
+    while (pos != std::string::npos) {
+        std::size_t blockStart = pos + marker.size();
+        std::size_t blockEnd = response.find('}', blockStart);
+        if (blockEnd == std::string::npos)
+            break;
+
+        WeatherImpact impact;
+        impact.temperature = extractValueIn(response, blockStart, blockEnd, "\"temperature_2m\"", impact.temperature);
+        impact.cloudCover  = extractValueIn(response, blockStart, blockEnd, "\"cloudcover\"", impact.cloudCover);
+        impact.rainAmount  = extractValueIn(response, blockStart, blockEnd, "\"precipitation\"", impact.rainAmount);
+        impact.windSpeed   = extractValueIn(response, blockStart, blockEnd, "\"windspeed_10m\"", impact.windSpeed);
+        applyWeatherFactors(impact);
+
+        impacts.push_back(impact);
+        count++;
+        pos = response.find(marker, blockEnd);
+    }
+
+    return count;
+}
+
+bool parseForecastPayload(const std::string& response, std::vector<ForecastHour>& forecast)
+{
+    forecast.clear();
+
+    std::size_t hourlyPos = response.find("\"hourly\":");
+    if (hourlyPos == std::string::npos)
+        return false;
+
+    std::vector<double> times;
+    std::vector<double> columns[4];
+    const char* keys[4] = {"cloudcover", "precipitation", "temperature_2m", "windspeed_10m"};
+
+    if (!extractArray(response, hourlyPos, "time", times) || times.empty())
+        return false;
+
+    for (int k = 0; k < 4; k++) {
+        if (!extractArray(response, hourlyPos, keys[k], columns[k]) || columns[k].size() != times.size())
+            return false;
+    }
+
+    // Ultimo valor lido de cada coluna, para as horas que vierem null.
+    double previous[4] = {0.0, 0.0, 0.0, 0.0};
+
+    forecast.reserve(times.size());
+    for (std::size_t i = 0; i < times.size(); i++) {
+        if (std::isnan(times[i]))
+            return false;
+
+        ForecastHour hour;
+        hour.time = static_cast<std::int64_t>(times[i]);
+        if (!forecast.empty() && hour.time <= forecast.back().time)
+            return false;
+
+        for (int k = 0; k < 4; k++) {
+            if (!std::isnan(columns[k][i]))
+                previous[k] = columns[k][i];
+        }
+
+        hour.cloudCoverPct = previous[0];
+        hour.rainMm        = previous[1];
+        hour.temperatureC  = previous[2];
+        hour.windSpeedKmh  = previous[3];
+
+        forecast.push_back(hour);
+    }
+
+    return true;
+}
+
+void applyWeatherFactors(WeatherImpact& impact)
+{
+    impact.cloudFactor = 1.0 - 0.75 * (impact.cloudCover / 100.0);
+    if (impact.cloudFactor < 0.25)
+        impact.cloudFactor = 0.25;
+
+    impact.rainFactor = 1.0;
+    if (impact.rainAmount > 0.0 && impact.rainAmount <= 1.0)
+        impact.rainFactor = 0.95;
+    else if (impact.rainAmount > 1.0 && impact.rainAmount <= 5.0)
+        impact.rainFactor = 0.85;
+    else if (impact.rainAmount > 5.0)
+        impact.rainFactor = 0.70;
+
+    impact.tempFactor = 1.0;
+    if (impact.temperature > 25.0)
+    {
+        double coef   = -0.0045;
+        double deltaT = impact.temperature - 25.0;
+        impact.tempFactor = 1.0 + coef * deltaT;
+
+        if (impact.tempFactor < 0.85)
+            impact.tempFactor = 0.85;
+    }
+
+    impact.windCoolingFactor = 1.0 + (impact.windSpeed * 0.0008);
+}
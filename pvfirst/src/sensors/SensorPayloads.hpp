@@ -0,0 +1,41 @@
+#pragma once
+
+#include "GeoSensor.hpp"
+#include "MetarSensor.hpp"
+#include "SensorState.hpp"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Aqui eu separei a leitura das respostas das APIs da parte de rede (CURL).
+// Assim essas funcoes entram no pvfirst_core e podem ser medidas e reaproveitadas
+// sem precisar de conexao nenhuma.
+
+double extractNumber(const std::string& json, const std::string& key, double defaultValue);
+
+std::string extractText(const std::string& json, const std::string& keyPrefix, const std::string& defaultValue);
+
+// Procura a chave so depois do bloco "current" da resposta do open-meteo.
+double extractCurrentValue(const std::string& json, const std::string& key, double defaultValue);
+
+bool hasValidLocationPayload(const std::string& response);
+bool hasValidWeatherPayload(const std::string& response);
+
+// Le a resposta do ip-api. O que nao vier na resposta continua com o valor de fallback.
+GPSData parseLocationPayload(const std::string& response, const GPSData& fallback);
+
+// Le a resposta do open-meteo e ja devolve os fatores calculados.
+WeatherImpact parseWeatherPayload(const std::string& response);
+
+// Resposta do open-meteo com varias coordenadas (latitude=a,b,c&longitude=x,y,z):
+// uma lista de objetos, cada um com o seu bloco "current", na ordem das coordenadas.
+// Acrescenta em impacts um WeatherImpact por bloco e devolve quantos leu.
+std::size_t parseWeatherBatchPayload(const std::string& response, std::vector<WeatherImpact>& impacts);
+
+// Le o bloco "hourly" do open-meteo, pedido com timeformat=unixtime.
+// Hora sem valor (null) repete a anterior. false se o bloco nao veio inteiro.
+bool parseForecastPayload(const std::string& response, std::vector<ForecastHour>& forecast);
+
+// Converte as leituras brutas (nuvem, chuva, temperatura, vento) nos fatores do modelo.
+void applyWeatherFactors(WeatherImpact& impact);
@@ -0,0 +1,322 @@
+#include "SensorState.hpp"
+#include "SensorPayloads.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string_view>
+
+namespace
+{
+    const char sep = ';';
+    const char* const stateVersion = "1";
+
+    // Mesmo cuidado do arquivo de totais: o numero volta exatamente igual.
+    void appendNumber(std::string& out, double value)
+    {
+        char text[32];
+        std::to_chars_result result = std::to_chars(text, text + sizeof(text), value);
+        out += sep;
+        out.append(text, static_cast<size_t>(result.ptr - text));
+    }
+
+    void appendInteger(std::string& out, std::int64_t value)
+    {
+        char text[24];
+        std::to_chars_result result = std::to_chars(text, text + sizeof(text), value);
+        out += sep;
+        out.append(text, static_cast<size_t>(result.ptr - text));
+    }
+
+    template <class Number>
+    bool parseNumber(std::string_view text, Number& value)
+    {
+        std::from_chars_result result = std::from_chars(text.data(), text.data() + text.size(), value);
+        return result.ec == std::errc() && result.ptr == text.data() + text.size();
+    }
+
+    std::size_t splitFields(std::string_view line, std::string_view* fields, std::size_t maxFields)
+    {
+        std::size_t count = 0;
+        std::size_t start = 0;
+
+        while (count < maxFields) {
+            std::size_t end = line.find(sep, start);
+            fields[count++] = line.substr(start, end == std::string_view::npos ? std::string_view::npos : end - start);
+            if (end == std::string_view::npos)
+                return count;
+            start = end + 1;
+        }
+
+        // Sobrou campo: a linha nao esta no formato.
+        return maxFields + 1;
+    }
+
+    bool parseBreaker(const std::string_view* fields, std::size_t count, CircuitBreaker& breaker)
+    {
+        int failures = 0;
+        std::int64_t openUntil = 0;
+        if (count != 4 || !parseNumber(fields[2], failures) || !parseNumber(fields[3], openUntil))
+            return false;
+        breaker.restore(failures, openUntil);
+        return true;
+    }
+
+    bool parseWeatherFields(const std::string_view* fields, std::int64_t& time,
+                            double& cloud, double& rain, double& temperature, double& wind)
+    {
+        return parseNumber(fields[1], time) &&
+               parseNumber(fields[2], cloud) &&
+               parseNumber(fields[3], rain) &&
+               parseNumber(fields[4], temperature) &&
+               parseNumber(fields[5], wind);
+    }
+
+    bool parseLine(std::string_view line, SensorState& state)
+    {
+        std::string_view fields[8];
+        std::size_t count = splitFields(line, fields, 8);
+        if (count > 8)
+            return false;
+
+        std::string_view kind = fields[0];
+
+        if (kind == "versao")
+            return count == 2 && fields[1] == stateVersion;
+
+        if (kind == "disjuntor" && count == 4) {
+            if (fields[1] == "geo")
+                return parseBreaker(fields, count, state.geoBreaker);
+            if (fields[1] == "clima")
+                return parseBreaker(fields, count, state.weatherBreaker);
+            return false;
+        }
+
+        if (kind == "local" && count == 5) {
+            state.hasLocation = parseNumber(fields[1], state.locationTime) &&
+                                parseNumber(fields[2], state.location.latitude) &&
+                                parseNumber(fields[3], state.location.longitude);
+            state.location.city = std::string(fields[4]);
+            return state.hasLocation;
+        }
+
+        if (kind == "clima" && count == 6) {
+            WeatherImpact& impact = state.weather;
+            state.hasWeather = parseWeatherFields(fields, state.weatherTime, impact.cloudCover,
+                                                  impact.rainAmount, impact.temperature, impact.windSpeed);
+            applyWeatherFactors(impact);
+            return state.hasWeather;
+        }
+
+        if (kind == "previsao_baixada" && count == 2)
+            return parseNumber(fields[1], state.forecastTime);
+
+        if (kind == "previsao" && count == 6) {
+            ForecastHour hour;
+            if (!parseWeatherFields(fields, hour.time, hour.cloudCoverPct, hour.rainMm,
+                                    hour.temperatureC, hour.windSpeedKmh))
+                return false;
+            if (!state.forecast.empty() && hour.time <= state.forecast.back().time)
+                return false;
+            state.forecast.push_back(hour);
+            return true;
+        }
+
+        return false;
+    }
+
+    // O nome da cidade vai num campo do arquivo; separador e quebra de linha viram espaco.
+    std::string cleanField(const std::string& text)
+    {
+        std::string out = text;
+        for (char& c : out) {
+            if (c == sep || c == '\n' || c == '\r')
+                c = ' ';
+        }
+        return out;
+    }
+}
+
+const char* sensorSourceName(SensorSource source)
+{
+    switch (source) {
+    case SensorSource::Api:
+        return "api";
+    case SensorSource::Forecast:
+        return "previsao";
+    case SensorSource::LastKnown:
+        return "ultimo";
+    case SensorSource::Default:
+        return "padrao";
+    case SensorSource::Metar:
+        return "metar";
+    case SensorSource::None:
+        break;
+    }
+    return "?";
+}
+
+bool CircuitBreaker::allowRequest(std::int64_t now) const
+{
+    return !isOpen(now);
+}
+
+bool CircuitBreaker::isOpen(std::int64_t now) const
+{
+    return consecutiveFailures >= failureThreshold && now < openUntilTime;
+}
+
+void CircuitBreaker::recordSuccess()
+{
+    consecutiveFailures = 0;
+    openUntilTime = 0;
+}
+
+void CircuitBreaker::recordFailure(std::int64_t now)
+{
+    consecutiveFailures++;
+    if (consecutiveFailures < failureThreshold)
+        return;
+
+    // 30 s na terceira falha, 60 s na quarta... O deslocamento para em 16
+    // so para nao estourar o inteiro; o teto de 1800 s chega bem antes.
+    int doublings = std::min(consecutiveFailures - failureThreshold, 16);
+    std::int64_t backoff = std::min(backoffBaseSeconds << doublings, backoffMaxSeconds);
+    openUntilTime = now + backoff;
+}
+
+int CircuitBreaker::failures() const
+{
+    return consecutiveFailures;
+}
+
+std::int64_t CircuitBreaker::openUntil() const
+{
+    return openUntilTime;
+}
+
+void CircuitBreaker::restore(int failures, std::int64_t openUntil)
+{
+    consecutiveFailures = std::max(failures, 0);
+    openUntilTime = openUntil;
+}
+
+bool SensorState::forecastAt(std::int64_t now, WeatherImpact& impact) const
+{
+    if (forecast.empty() || now < forecast.front().time || now >= forecast.back().time + 3600)
+        return false;
+
+    auto next = std::upper_bound(forecast.begin(), forecast.end(), now,
+                                 [](std::int64_t time, const ForecastHour& hour) { return time < hour.time; });
+    const ForecastHour& before = *(next - 1);
+
+    impact = WeatherImpact{};
+    if (next == forecast.end()) {
+        // Ultima hora da previsao: vale ela mesma ate o fim da hora.
+        impact.cloudCover  = before.cloudCoverPct;
+        impact.rainAmount  = before.rainMm;
+        impact.temperature = before.temperatureC;
+        impact.windSpeed   = before.windSpeedKmh;
+    }
+    else {
+        const ForecastHour& after = *next;
+        double fraction = static_cast<double>(now - before.time) / static_cast<double>(after.time - before.time);
+        impact.cloudCover  = before.cloudCoverPct + fraction * (after.cloudCoverPct - before.cloudCoverPct);
+        impact.rainAmount  = before.rainMm + fraction * (after.rainMm - before.rainMm);
+        impact.temperature = before.temperatureC + fraction * (after.temperatureC - before.temperatureC);
+        impact.windSpeed   = before.windSpeedKmh + fraction * (after.windSpeedKmh - before.windSpeedKmh);
+    }
+
+    applyWeatherFactors(impact);
+    return true;
+}
+
+SensorState SensorState::load(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+        return SensorState{};
+
+    SensorState state;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!parseLine(line, state))
+            return SensorState{};
+    }
+
+    return state;
+}
+
+void SensorState::save(const std::string& path) const
+{
+    std::string out;
+    out.reserve(256 + forecast.size() * 64);
+
+    out += "versao;";
+    out += stateVersion;
+    out += '\n';
+
+    out += "disjuntor;geo";
+    appendInteger(out, geoBreaker.failures());
+    appendInteger(out, geoBreaker.openUntil());
+    out += '\n';
+
+    out += "disjuntor;clima";
+    appendInteger(out, weatherBreaker.failures());
+    appendInteger(out, weatherBreaker.openUntil());
+    out += '\n';
+
+    if (hasLocation) {
+        out += "local";
+        appendInteger(out, locationTime);
+        appendNumber(out, location.latitude);
+        appendNumber(out, location.longitude);
+        out += sep;
+        out += cleanField(location.city);
+        out += '\n';
+    }
+
+    if (hasWeather) {
+        out += "clima";
+        appendInteger(out, weatherTime);
+        appendNumber(out, weather.cloudCover);
+        appendNumber(out, weather.rainAmount);
+        appendNumber(out, weather.temperature);
+        appendNumber(out, weather.windSpeed);
+        out += '\n';
+    }
+
+    if (!forecast.empty()) {
+        out += "previsao_baixada";
+        appendInteger(out, forecastTime);
+        out += '\n';
+
+        for (const ForecastHour& hour : forecast) {
+            out += "previsao";
+            appendInteger(out, hour.time);
+            appendNumber(out, hour.cloudCoverPct);
+            appendNumber(out, hour.rainMm);
+            appendNumber(out, hour.temperatureC);
+            appendNumber(out, hour.windSpeedKmh);
+            out += '\n';
+        }
+    }
+
+    std::filesystem::path target(path);
+    if (target.has_parent_path())
+        std::filesystem::create_directories(target.parent_path());
+
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            throw std::runtime_error("Nao consegui gravar o estado dos sensores em: " + temporary);
+        }
+        file.write(out.data(), static_cast<std::streamsize>(out.size()));
+    }
+
+    std::filesystem::rename(temporary, path);
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "GeoSensor.hpp"
+#include "MetarSensor.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// De onde veio o local ou o clima de uma execucao.
+// O numero vai para o log de eventos, entao fonte nova entra sempre no fim.
+enum class SensorSource : std::uint8_t
+{
+    None      = 0, // registros antigos, de antes da cadeia de reserva
+    Api       = 1, // resposta da API nesta execucao
+    Forecast  = 2, // previsao horaria guardada da ultima resposta boa (so clima)
+    LastKnown = 3, // ultimo valor bom, sem previsao para a hora
+    Default   = 4, // nada guardado: local padrao do GPSData ou ceu limpo
+    Metar     = 5  // relatorio METAR do arquivo local (so clima, vem antes da API)
+};
+
+constexpr std::size_t sensorSourceCount = 6;
+
+// "api", "previsao", "ultimo", "padrao", "metar" ("?" para None).
+const char* sensorSourceName(SensorSource source);
+
+// Disjuntor de uma API.
+//
+// Depois de failureThreshold falhas seguidas, a API fica sem consulta por um
+// tempo que dobra a cada falha nova (backoffBase, 2x, 4x... ate backoffMax).
+// Vencido esse tempo, a proxima execucao tenta uma vez: se der certo, o
+// disjuntor fecha e zera; se falhar, abre de novo pelo dobro do tempo.
+//
+// Os tempos sao do relogio da maquina (time_t), porque o estado passa de
+// um processo para o outro pelo arquivo de SensorState.
+class CircuitBreaker
+{
+public:
+    static constexpr int failureThreshold = 3;
+    static constexpr std::int64_t backoffBaseSeconds = 30;
+    static constexpr std::int64_t backoffMaxSeconds = 1800;
+
+    bool allowRequest(std::int64_t now) const;
+    bool isOpen(std::int64_t now) const;
+
+    void recordSuccess();
+    void recordFailure(std::int64_t now);
+
+    int failures() const;
+    std::int64_t openUntil() const;
+
+    // Volta o estado lido do arquivo.
+    void restore(int failures, std::int64_t openUntil);
+
+private:
+    int consecutiveFailures = 0;
+    std::int64_t openUntilTime = 0;
+};
+
+// Tudo o que os sensores guardam entre uma execucao e outra:
+// os dois disjuntores, o ultimo local e clima bons e a previsao horaria.
+//
+// Fica num arquivo de texto pequeno na pasta de resultados
+// (results/SPVfirst_sensores.txt), reescrito por inteiro a cada execucao.
+// Um arquivo ilegivel nao para o experimento: eu comeco do zero.
+struct SensorState
+{
+    CircuitBreaker geoBreaker;
+    CircuitBreaker weatherBreaker;
+
+    bool hasLocation = false;
+    std::int64_t locationTime = 0;
+    GPSData location;
+
+    bool hasWeather = false;
+    std::int64_t weatherTime = 0;
+    WeatherImpact weather;
+
+    // Quando a previsao foi baixada, e as horas dela em ordem.
+    std::int64_t forecastTime = 0;
+    std::vector<ForecastHour> forecast;
+
+    // Clima da previsao no instante now, em linha reta entre as horas.
+    // false se a previsao nao cobre esse instante.
+    bool forecastAt(std::int64_t now, WeatherImpact& impact) const;
+
+    static SensorState load(const std::string& path);
+
+    // Escreve num .tmp e renomeia por cima, para nunca deixar o arquivo pela metade.
+    void save(const std::string& path) const;
+};
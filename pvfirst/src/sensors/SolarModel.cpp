@@ -1,4 +1,5 @@
 #include "SolarModel.hpp"
+#include <algorithm>
 #include <cmath>
 
 double SolarModel::computeIrradiance(double latitude,
@@ -35,3 +36,121 @@ double SolarModel::computeIrradiance(double latitude,
 
     return Gmax * sinAlpha;
 }
+
+SunVector SolarModel::sunVector(double latitude,
+                                int dayOfYear,
+                                double hour)
+{
+    double decl =
+        23.45 * std::sin((360.0 / 365.0) *
+        (284 + dayOfYear) *
+        M_PI / 180.0);
+
+    double latRad = latitude * M_PI / 180.0;
+    double decRad = decl * M_PI / 180.0;
+
+    double hourAngle =
+        (hour - 12.0) * 15.0 * M_PI / 180.0;
+
+    // De manha o angulo horario e negativo e o sol esta a leste.
+    SunVector sun;
+    sun.east  = -std::cos(decRad) * std::sin(hourAngle);
+    sun.north = std::cos(latRad) * std::sin(decRad) -
+                std::sin(latRad) * std::cos(decRad) * std::cos(hourAngle);
+    sun.up    = std::sin(latRad) * std::sin(decRad) +
+                std::cos(latRad) * std::cos(decRad) *
+                std::cos(hourAngle);
+    return sun;
+}
+
+double SolarModel::integrateIrradiance(double latitude,
+                                       int dayOfYear,
+                                       double hourStart,
+                                       double hourEnd)
+{
+    if (hourEnd <= hourStart)
+        return 0.0;
+
+    double Gmax = 1000.0;
+
+    double decl =
+        23.45 * std::sin((360.0 / 365.0) *
+        (284 + dayOfYear) *
+        M_PI / 180.0);
+
+    double latRad = latitude * M_PI / 180.0;
+    double decRad = decl * M_PI / 180.0;
+
+    // Irradiancia = Gmax x (a + b cos h), com h o angulo horario.
+    double a = std::sin(latRad) * std::sin(decRad);
+    double b = std::cos(latRad) * std::cos(decRad);
+
+    // Meio arco diurno, em horas a partir do meio-dia: a + b cos h = 0 no nascer e no por.
+    double halfDayHours = 12.0;
+    if (b > 0.0) {
+        double cosSunset = -a / b;
+        if (cosSunset >= 1.0)
+            return 0.0;
+        if (cosSunset > -1.0)
+            halfDayHours = std::acos(cosSunset) * 12.0 / M_PI;
+    }
+    else if (a <= 0.0) {
+        return 0.0;
+    }
+
+    // Primitiva de a + b cos((t - 12) x 15 graus) em horas.
+    auto primitive = [&](double hour) {
+        return a * hour + b * (12.0 / M_PI) * std::sin((hour - 12.0) * M_PI / 12.0);
+    };
+
+    // Um trecho de sol por dia: [12 - meio arco, 12 + meio arco] + 24 k.
+    double total = 0.0;
+    double firstDay = std::floor((hourStart - 12.0 - halfDayHours) / 24.0) + 1.0;
+
+    for (double day = firstDay; 24.0 * day + 12.0 - halfDayHours < hourEnd; day += 1.0) {
+        double from = std::max(hourStart, 24.0 * day + 12.0 - halfDayHours);
+        double to = std::min(hourEnd, 24.0 * day + 12.0 + halfDayHours);
+        if (to > from)
+            total += primitive(to) - primitive(from);
+    }
+
+    return Gmax * std::max(total, 0.0);
+}
+
+bool SolarModel::solarWindow(double latitude,
+                             int dayOfYear,
+                             double minimumWm2,
+                             double& firstHour,
+                             double& lastHour)
+{
+    double Gmax = 1000.0;
+
+    double decl =
+        23.45 * std::sin((360.0 / 365.0) *
+        (284 + dayOfYear) *
+        M_PI / 180.0);
+
+    double latRad = latitude * M_PI / 180.0;
+    double decRad = decl * M_PI / 180.0;
+
+    double a = std::sin(latRad) * std::sin(decRad);
+    double b = std::cos(latRad) * std::cos(decRad);
+    double minimum = minimumWm2 / Gmax;
+
+    // Meio trecho util em horas a partir do meio-dia: a + b cos h = minimo nas pontas.
+    double halfHours = 12.0;
+    if (b > 0.0) {
+        double cosEdge = (minimum - a) / b;
+        if (cosEdge >= 1.0)
+            return false;
+        if (cosEdge > -1.0)
+            halfHours = std::acos(cosEdge) * 12.0 / M_PI;
+    }
+    else if (a <= minimum) {
+        return false;
+    }
+
+    firstHour = 12.0 - halfHours;
+    lastHour = 12.0 + halfHours;
+    return true;
+}
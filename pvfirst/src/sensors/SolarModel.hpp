@@ -1,8 +1,45 @@
 #pragma once
 
+// Direcao do sol num instante, como vetor unitario em coordenadas locais:
+// leste, norte e para cima. up e o seno da altura do sol (negativo a noite).
+struct SunVector
+{
+    double east  = 0.0;
+    double north = 0.0;
+    double up    = 0.0;
+};
+
 class SolarModel {
 public:
     double computeIrradiance(double latitude,
                              int dayOfYear,
                              double hour);
+
+    // Mesma geometria do computeIrradiance (declinacao e angulo horario),
+    // mas com a direcao inteira do sol, para painel inclinado e sombra.
+    SunVector sunVector(double latitude,
+                        int dayOfYear,
+                        double hour);
+
+    // Integral do computeIrradiance entre as horas hourStart e hourEnd, em Wh/m2.
+    //
+    // A curva e Gmax x (sen lat sen decl + cos lat cos decl cos h), entao a integral
+    // tem forma fechada: so os trechos entre o nascer e o por do sol entram, sem
+    // amostrar nada. Custo fixo, seja a janela de um segundo ou de um dia.
+    // As horas podem passar de 24 (a janela atravessa a meia-noite); a declinacao
+    // continua a do dayOfYear.
+    double integrateIrradiance(double latitude,
+                               int dayOfYear,
+                               double hourStart,
+                               double hourEnd);
+
+    // Trecho do dia em que o computeIrradiance passa de minimumWm2: de firstHour a
+    // lastHour (0 a 24), simetrico em volta do meio-dia. Sai direto do angulo horario
+    // em que a + b cos h = minimo, sem varrer o dia.
+    // false se o sol nao chega a esse valor em nenhum momento do dia.
+    bool solarWindow(double latitude,
+                     int dayOfYear,
+                     double minimumWm2,
+                     double& firstHour,
+                     double& lastHour);
 };
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+// Fila circular de um produtor e um consumidor, sem lock.
+//
+// O produtor so escreve em tail e o consumidor so escreve em head; cada um le
+// o indice do outro com acquire, entao o valor da posicao ja esta visivel
+// quando o indice aparece. Os dois indices ficam em linhas de cache separadas
+// para uma thread nao invalidar a linha da outra a cada amostra.
+//
+// Capacity precisa ser potencia de 2: a posicao sai de uma mascara, sem divisao.
+template <class T, std::size_t Capacity>
+class SpscRing
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "A capacidade da fila precisa ser potencia de 2.");
+
+public:
+    // So o produtor chama. false com a fila cheia (a amostra fica de fora).
+    bool push(const T& value)
+    {
+        std::size_t tail = tailIndex.load(std::memory_order_relaxed);
+        if (tail - headIndex.load(std::memory_order_acquire) == Capacity)
+            return false;
+
+        slots[tail & (Capacity - 1)] = value;
+        tailIndex.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // So o consumidor chama. false com a fila vazia.
+    bool pop(T& value)
+    {
+        std::size_t head = headIndex.load(std::memory_order_relaxed);
+        if (head == tailIndex.load(std::memory_order_acquire))
+            return false;
+
+        value = slots[head & (Capacity - 1)];
+        headIndex.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Aproximado quando as duas threads estao mexendo na fila.
+    std::size_t size() const
+    {
+        return tailIndex.load(std::memory_order_acquire) - headIndex.load(std::memory_order_acquire);
+    }
+
+    static constexpr std::size_t capacity()
+    {
+        return Capacity;
+    }
+
+private:
+    alignas(64) std::atomic<std::size_t> headIndex{0};
+    alignas(64) std::atomic<std::size_t> tailIndex{0};
+    alignas(64) std::array<T, Capacity> slots{};
+};
@@ -0,0 +1,308 @@
+#include "WeatherSeries.hpp"
+#include "SensorPayloads.hpp"
+
+#include "storage/CivilTime.hpp"
+#include "storage/CsvScanner.hpp"
+#include "storage/MappedFile.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <stdexcept>
+#include <string_view>
+
+namespace
+{
+    bool parseNumber(std::string_view text, double& value)
+    {
+        std::from_chars_result result = std::from_chars(text.data(), text.data() + text.size(), value);
+        return result.ec == std::errc() && result.ptr == text.data() + text.size();
+    }
+
+    bool parseNumber(std::string_view text, int& value)
+    {
+        std::from_chars_result result = std::from_chars(text.data(), text.data() + text.size(), value);
+        return result.ec == std::errc() && result.ptr == text.data() + text.size();
+    }
+
+    // Segundo do ano num ano de 365 dias.
+    std::int64_t secondOfYearFor(int month, int day, std::int64_t secondOfDay)
+    {
+        return weatherDayOfYear(month, day) * 86400 + secondOfDay;
+    }
+
+    bool isLeapDay(int month, int day)
+    {
+        return month == 2 && day == 29;
+    }
+
+    // "AAAA-MM-DD HH:MM" -> mes, dia e segundo do dia.
+    bool parseDateTime(std::string_view text, int& month, int& day, std::int64_t& secondOfDay)
+    {
+        int year = 0;
+        int hour = 0;
+        int minute = 0;
+
+        if (text.size() < 16 ||
+            !parseNumber(text.substr(0, 4), year) ||
+            !parseNumber(text.substr(5, 2), month) ||
+            !parseNumber(text.substr(8, 2), day) ||
+            !parseNumber(text.substr(11, 2), hour) ||
+            !parseNumber(text.substr(14, 2), minute))
+            return false;
+
+        secondOfDay = hour * 3600 + minute * 60;
+        return month >= 1 && month <= 12 && day >= 1 && day <= 31;
+    }
+
+    double interpolate(const std::vector<double>& column, std::size_t before, std::size_t after, double fraction)
+    {
+        return column[before] + (column[after] - column[before]) * fraction;
+    }
+}
+
+std::int64_t weatherDayOfYear(int month, int day)
+{
+    // 2001 nao e bissexto; o 29/02 fica no 28/02.
+    if (isLeapDay(month, day))
+        day = 28;
+    return daysFromCivil(2001, static_cast<unsigned>(month), static_cast<unsigned>(day)) -
+           daysFromCivil(2001, 1, 1);
+}
+
+std::size_t WeatherSeries::size() const
+{
+    return secondOfYear.size();
+}
+
+WeatherSeries WeatherSeries::loadCsv(const std::string& path)
+{
+    MappedFile file(path);
+    std::string_view text = file.text();
+
+    std::size_t headerEnd = text.find('\n');
+    if (headerEnd == std::string_view::npos ||
+        text.substr(0, headerEnd).find("datetime;cloud_cover_pct;rain_mm;temperature_c;wind_speed_kmh") != 0)
+        throw std::runtime_error("O arquivo de clima nao tem o cabecalho esperado "
+                                 "(datetime;cloud_cover_pct;rain_mm;temperature_c;wind_speed_kmh): " + path);
+
+    std::string_view body = text.substr(headerEnd + 1);
+
+    WeatherSeries series;
+    std::size_t capacity = CsvScanner::countLines(body) + 1;
+    series.secondOfYear.reserve(capacity);
+    series.cloudCoverPct.reserve(capacity);
+    series.rainMm.reserve(capacity);
+    series.temperatureC.reserve(capacity);
+    series.windSpeedKmh.reserve(capacity);
+
+    CsvScanner scanner(body);
+    std::string_view fields[5];
+    std::size_t fieldCount = 0;
+    std::size_t line = 1;
+
+    while (scanner.nextLine(fields, 5, fieldCount)) {
+        line++;
+
+        if (fieldCount == 1 && fields[0].empty())
+            continue;
+
+        int month = 0;
+        int day = 0;
+        std::int64_t secondOfDay = 0;
+        double values[4];
+
+        bool valid = fieldCount == 5 && parseDateTime(fields[0], month, day, secondOfDay);
+        for (std::size_t i = 0; valid && i < 4; i++)
+            valid = parseNumber(fields[1 + i], values[i]);
+
+        if (!valid)
+            throw std::runtime_error("Linha invalida no arquivo de clima " + path +
+                                     " (linha " + std::to_string(line) + ")");
+
+        if (isLeapDay(month, day))
+            continue;
+
+        std::int64_t second = secondOfYearFor(month, day, secondOfDay);
+
+        if (!series.secondOfYear.empty() && second < series.secondOfYear.back())
+            throw std::runtime_error("O arquivo de clima precisa estar em ordem de data " + path +
+                                     " (linha " + std::to_string(line) + ")");
+
+        series.secondOfYear.push_back(second);
+        series.cloudCoverPct.push_back(values[0]);
+        series.rainMm.push_back(values[1]);
+        series.temperatureC.push_back(values[2]);
+        series.windSpeedKmh.push_back(values[3]);
+    }
+
+    if (series.size() == 0)
+        throw std::runtime_error("O arquivo de clima nao tem nenhuma amostra: " + path);
+
+    return series;
+}
+
+WeatherSeries WeatherSeries::loadEpw(const std::string& path)
+{
+    MappedFile file(path);
+    std::string_view text = file.text();
+
+    const std::size_t headerLines = 8;
+    const std::size_t columnCount = 35;
+
+    // As linhas de cabecalho sao puladas direto pelos '\n': os comentarios do EPW
+    // podem ter aspas soltas, que confundiriam o CsvScanner.
+    std::size_t bodyStart = 0;
+    for (std::size_t line = 0; line < headerLines; line++) {
+        std::size_t lineEnd = text.find('\n', bodyStart);
+        if (lineEnd == std::string_view::npos)
+            throw std::runtime_error("O EPW acabou no meio do cabecalho: " + path);
+        bodyStart = lineEnd + 1;
+    }
+
+    std::string_view fields[columnCount];
+    std::size_t fieldCount = 0;
+
+    WeatherSeries series;
+
+    // LOCATION,cidade,estado,pais,fonte,WMO,latitude,longitude,fuso,altitude
+    CsvScanner location(text.substr(0, text.find('\n')), ',');
+    if (!location.nextLine(fields, columnCount, fieldCount) || fieldCount < 8 || fields[0] != "LOCATION")
+        throw std::runtime_error("O arquivo nao parece um EPW (a primeira linha deveria ser LOCATION): " + path);
+
+    series.city.assign(fields[1].data(), fields[1].size());
+    series.hasLocation = parseNumber(fields[6], series.latitude) && parseNumber(fields[7], series.longitude);
+
+    std::size_t capacity = 8760;
+    series.secondOfYear.reserve(capacity);
+    series.cloudCoverPct.reserve(capacity);
+    series.rainMm.reserve(capacity);
+    series.temperatureC.reserve(capacity);
+    series.windSpeedKmh.reserve(capacity);
+    series.globalHorizontalWm2.reserve(capacity);
+
+    // Ultimo valor valido de cada grandeza, para cobrir os buracos do arquivo.
+    double temperature = 28.0;
+    double globalHorizontal = 0.0;
+    double windSpeed = 0.0;
+    double cloudCover = 0.0;
+    double rain = 0.0;
+
+    CsvScanner scanner(text.substr(bodyStart), ',');
+    std::size_t line = headerLines;
+
+    while (scanner.nextLine(fields, columnCount, fieldCount)) {
+        line++;
+
+        if (fieldCount == 1 && fields[0].empty())
+            continue;
+
+        int month = 0;
+        int day = 0;
+        int hour = 0;
+        double value = 0.0;
+
+        if (fieldCount < 34 ||
+            !parseNumber(fields[1], month) ||
+            !parseNumber(fields[2], day) ||
+            !parseNumber(fields[3], hour) ||
+            month < 1 || month > 12 || day < 1 || day > 31 || hour < 1 || hour > 24)
+            throw std::runtime_error("Linha invalida no EPW " + path + " (linha " + std::to_string(line) + ")");
+
+        if (isLeapDay(month, day))
+            continue;
+
+        if (parseNumber(fields[6], value) && value < 99.9)
+            temperature = value;
+        if (parseNumber(fields[13], value) && value < 9999.0)
+            globalHorizontal = value;
+        if (parseNumber(fields[21], value) && value < 999.0)
+            windSpeed = value * 3.6;
+        if (parseNumber(fields[22], value) && value < 99.0)
+            cloudCover = value * 10.0;
+        if (parseNumber(fields[33], value) && value < 999.0)
+            rain = value;
+
+        series.secondOfYear.push_back(secondOfYearFor(month, day, (hour - 1) * 3600 + 1800));
+        series.temperatureC.push_back(temperature);
+        series.globalHorizontalWm2.push_back(globalHorizontal);
+        series.windSpeedKmh.push_back(windSpeed);
+        series.cloudCoverPct.push_back(cloudCover);
+        series.rainMm.push_back(rain);
+    }
+
+    if (series.size() == 0)
+        throw std::runtime_error("O EPW nao tem nenhuma hora de dados: " + path);
+
+    for (std::size_t i = 1; i < series.size(); i++) {
+        if (series.secondOfYear[i] < series.secondOfYear[i - 1])
+            throw std::runtime_error("As horas do EPW nao estao em ordem: " + path);
+    }
+
+    return series;
+}
+
+WeatherCursor::WeatherCursor(const WeatherSeries& series)
+    : series(series)
+{
+}
+
+void WeatherCursor::locate(std::int64_t secondOfYear, std::size_t& after, double& fraction)
+{
+    const std::vector<std::int64_t>& times = series.secondOfYear;
+    const std::size_t count = times.size();
+
+    // index fica na ultima amostra com tempo <= secondOfYear
+    // (ou na ultima do arquivo, quando o instante vem antes da primeira).
+    if (secondOfYear < times[0]) {
+        index = count - 1;
+    }
+    else {
+        if (secondOfYear < times[index]) {
+            index = static_cast<std::size_t>(
+                std::upper_bound(times.begin(), times.end(), secondOfYear) - times.begin()) - 1;
+        }
+        while (index + 1 < count && times[index + 1] <= secondOfYear)
+            index++;
+    }
+
+    after = index + 1 < count ? index + 1 : 0;
+
+    // Da ultima amostra para a primeira, o tempo passa pela virada do ano.
+    std::int64_t start = times[index];
+    std::int64_t end = times[after];
+    std::int64_t position = secondOfYear;
+    if (after <= index)
+        end += secondsPerWeatherYear;
+    if (position < start)
+        position += secondsPerWeatherYear;
+
+    fraction = end > start ? static_cast<double>(position - start) / static_cast<double>(end - start) : 0.0;
+    fraction = std::min(1.0, std::max(0.0, fraction));
+}
+
+WeatherImpact WeatherCursor::at(std::int64_t secondOfYear)
+{
+    std::size_t after = 0;
+    double fraction = 0.0;
+    locate(secondOfYear, after, fraction);
+
+    WeatherImpact impact;
+    impact.cloudCover  = interpolate(series.cloudCoverPct, index, after, fraction);
+    impact.rainAmount  = interpolate(series.rainMm, index, after, fraction);
+    impact.temperature = interpolate(series.temperatureC, index, after, fraction);
+    impact.windSpeed   = interpolate(series.windSpeedKmh, index, after, fraction);
+
+    applyWeatherFactors(impact);
+    return impact;
+}
+
+double WeatherCursor::globalHorizontalAt(std::int64_t secondOfYear)
+{
+    if (series.globalHorizontalWm2.empty())
+        return 0.0;
+
+    std::size_t after = 0;
+    double fraction = 0.0;
+    locate(secondOfYear, after, fraction);
+    return interpolate(series.globalHorizontalWm2, index, after, fraction);
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "MetarSensor.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Clima de um ano inteiro vindo de arquivo, sem rede nenhuma.
+// Cada amostra guarda as mesmas leituras brutas que o open-meteo devolve
+// (nuvem, chuva, temperatura e vento), uma coluna por grandeza.
+//
+// O tempo de cada amostra e o segundo do ano (0 = 1o de janeiro 00:00),
+// sem o ano em si: um ano climatologico serve para simular qualquer ano.
+struct WeatherSeries
+{
+    std::vector<std::int64_t> secondOfYear;
+    std::vector<double> cloudCoverPct;
+    std::vector<double> rainMm;
+    std::vector<double> temperatureC;
+    std::vector<double> windSpeedKmh;
+
+    // Irradiancia global horizontal medida (W/m2). Vazia quando o arquivo nao traz.
+    std::vector<double> globalHorizontalWm2;
+
+    // Local do arquivo, quando ele informa (o EPW informa).
+    bool hasLocation = false;
+    std::string city;
+    double latitude  = 0.0;
+    double longitude = 0.0;
+
+    std::size_t size() const;
+
+    // CSV de ponto e virgula, uma linha por amostra, em ordem de tempo:
+    //   datetime;cloud_cover_pct;rain_mm;temperature_c;wind_speed_kmh
+    //   2026-01-01 00:00;75;0;24.1;6.5
+    // O ano da coluna datetime e ignorado, e o 29/02 fica de fora.
+    static WeatherSeries loadCsv(const std::string& path);
+
+    // Arquivo EPW do EnergyPlus (ano meteorologico tipico, TMY), lido sem rede.
+    // Das 35 colunas de cada hora eu uso: temperatura de bulbo seco (6),
+    // irradiancia global horizontal (13), vento (21, m/s -> km/h),
+    // cobertura total do ceu (22, decimos -> %) e chuva (33, mm).
+    // A linha da hora H cobre o intervalo (H-1, H]; a amostra fica no meio dele.
+    // Valor faltando (99, 999, 9999...) repete a hora anterior.
+    static WeatherSeries loadEpw(const std::string& path);
+};
+
+// Leitura do clima num instante qualquer, interpolando entre as amostras vizinhas.
+//
+// Andando para frente no tempo (o caso da simulacao), cada consulta so
+// compara com a proxima amostra: custo constante. Voltando no tempo,
+// a posicao e achada de novo com busca binaria.
+// Depois da ultima amostra, a interpolacao continua ate a primeira do ano seguinte.
+class WeatherCursor
+{
+public:
+    explicit WeatherCursor(const WeatherSeries& series);
+
+    // Leituras interpoladas e fatores do modelo ja calculados (applyWeatherFactors).
+    WeatherImpact at(std::int64_t secondOfYear);
+
+    // Irradiancia global horizontal medida, interpolada. So com globalHorizontalWm2 preenchida.
+    double globalHorizontalAt(std::int64_t secondOfYear);
+
+private:
+    // Acha as duas amostras em volta do instante e quanto ja andou de uma para a outra.
+    void locate(std::int64_t secondOfYear, std::size_t& after, double& fraction);
+
+    const WeatherSeries& series;
+    std::size_t index = 0;
+};
+
+// Segundos de um ano de 365 dias; num ano bissexto o 29/02 reaproveita o 28/02
+// (ver weatherDayOfYear).
+const std::int64_t secondsPerWeatherYear = 365 * 86400;
+
+// Dia (0 a 364) do ano de clima de uma data do calendario, pelo mes e dia:
+// assim o 1/03 de ano bissexto continua caindo no 1/03 do arquivo.
+std::int64_t weatherDayOfYear(int month, int day);
@@ -0,0 +1,292 @@
+#include "PlatformBuilder.hpp"
+
+#include <simgrid/s4u.hpp>
+
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+namespace sg4 = simgrid::s4u;
+
+namespace
+{
+    // Aqui eu quebro o topo_parameters em grupos separados por ';'
+    // e cada grupo em numeros separados por ','.
+    std::vector<std::vector<unsigned int>> parseTopoParameters(const std::string& text)
+    {
+        std::vector<std::vector<unsigned int>> groups;
+
+        std::stringstream groupStream(text);
+        std::string group;
+        while (std::getline(groupStream, group, ';')) {
+            std::vector<unsigned int> values;
+
+            std::stringstream valueStream(group);
+            std::string value;
+            while (std::getline(valueStream, value, ',')) {
+                try {
+                    values.push_back(static_cast<unsigned int>(std::stoul(value)));
+                }
+                catch (...) {
+                    throw std::runtime_error(
+                        "Parametro de topologia invalido: '" + text + "'."
+                    );
+                }
+            }
+
+            groups.push_back(values);
+        }
+
+        return groups;
+    }
+
+    sg4::FatTreeParams toFatTreeParams(const std::string& text)
+    {
+        auto groups = parseTopoParameters(text);
+
+        if (groups.size() != 4 || groups[0].size() != 1) {
+            throw std::runtime_error(
+                "Fat-tree espera 'niveis;descidas;subidas;links', recebi: '" + text + "'."
+            );
+        }
+
+        unsigned int levels = groups[0][0];
+        if (groups[1].size() != levels || groups[2].size() != levels || groups[3].size() != levels) {
+            throw std::runtime_error(
+                "Fat-tree com numero de niveis diferente da quantidade de valores: '" + text + "'."
+            );
+        }
+
+        return sg4::FatTreeParams(levels, groups[1], groups[2], groups[3]);
+    }
+
+    sg4::DragonflyParams toDragonflyParams(const std::string& text)
+    {
+        auto groups = parseTopoParameters(text);
+
+        if (groups.size() != 4 || groups[0].size() != 2 || groups[1].size() != 2 ||
+            groups[2].size() != 2 || groups[3].size() != 1) {
+            throw std::runtime_error(
+                "Dragonfly espera 'g,l;c,l;r,l;nos', recebi: '" + text + "'."
+            );
+        }
+
+        return sg4::DragonflyParams({groups[0][0], groups[0][1]},
+                                    {groups[1][0], groups[1][1]},
+                                    {groups[2][0], groups[2][1]},
+                                    groups[3][0]);
+    }
+
+    const NodeClass& nodeClassFor(const PlatformSpec& spec, unsigned long id)
+    {
+        if (spec.nodeClasses.empty())
+            throw std::runtime_error("A plataforma precisa de pelo menos uma classe de no.");
+
+        unsigned long first = 0;
+        for (const auto& nodeClass : spec.nodeClasses) {
+            unsigned long count = nodeClass.count > 0 ? static_cast<unsigned long>(nodeClass.count) : 0;
+            if (id < first + count)
+                return nodeClass;
+            first += count;
+        }
+
+        return spec.nodeClasses.back();
+    }
+
+    std::string nodeName(const PlatformSpec& spec, unsigned long id)
+    {
+        return spec.hostPrefix + std::to_string(id);
+    }
+
+    sg4::Host* createNode(sg4::NetZone* zone, const PlatformSpec& spec, unsigned long id)
+    {
+        const NodeClass& nodeClass = nodeClassFor(spec, id);
+
+        sg4::Host* host = zone->create_host(nodeName(spec, id), nodeClass.speedFlops)
+                              ->set_core_count(nodeClass.cores)
+                              ->set_property("wattage_per_state", nodeClass.wattagePerState)
+                              ->set_property("wattage_off", nodeClass.wattageOff);
+        host->seal();
+        return host;
+    }
+
+    const char* topologyXmlName(ClusterTopology topology)
+    {
+        switch (topology) {
+        case ClusterTopology::FatTree:
+            return "FAT_TREE";
+        case ClusterTopology::Dragonfly:
+            return "DRAGONFLY";
+        case ClusterTopology::Star:
+            break;
+        }
+        return "FLAT";
+    }
+
+    void writeEnergyProps(std::ostringstream& xml, const NodeClass& nodeClass, const std::string& indent)
+    {
+        xml << indent << "<prop id=\"wattage_per_state\" value=\"" << nodeClass.wattagePerState << "\" />\n";
+        xml << indent << "<prop id=\"wattage_off\" value=\"" << nodeClass.wattageOff << "\" />\n";
+    }
+}
+
+ClusterTopology PlatformBuilder::parseTopology(const std::string& text)
+{
+    if (text == "star")
+        return ClusterTopology::Star;
+
+    if (text == "fattree" || text == "fat-tree")
+        return ClusterTopology::FatTree;
+
+    if (text == "dragonfly")
+        return ClusterTopology::Dragonfly;
+
+    throw std::runtime_error(
+        "Topologia desconhecida: '" + text + "'. Use star, fattree ou dragonfly."
+    );
+}
+
+std::string PlatformBuilder::hostName(const PlatformSpec& spec, unsigned long id) const
+{
+    return nodeName(spec, id);
+}
+
+int PlatformBuilder::totalNodes(const PlatformSpec& spec) const
+{
+    if (spec.topology == ClusterTopology::Star)
+        return spec.nodeCount;
+
+    auto groups = parseTopoParameters(spec.topoParameters);
+    unsigned long total = 1;
+
+    if (spec.topology == ClusterTopology::FatTree) {
+        // Em um fat-tree o numero de folhas e o produto das descidas de cada nivel.
+        if (groups.size() < 2)
+            throw std::runtime_error("Fat-tree sem parametros de descida.");
+        for (unsigned int down : groups[1])
+            total *= down;
+    }
+    else {
+        // Em um dragonfly sao grupos x chassis x roteadores x nos por roteador.
+        if (groups.size() != 4 || groups[0].empty() || groups[1].empty() ||
+            groups[2].empty() || groups[3].empty())
+            throw std::runtime_error("Dragonfly com parametros incompletos.");
+        total = static_cast<unsigned long>(groups[0][0]) * groups[1][0] * groups[2][0] * groups[3][0];
+    }
+
+    return static_cast<int>(total);
+}
+
+void PlatformBuilder::build(const PlatformSpec& spec)
+{
+    // A primeira zona criada vira a zona raiz do Engine.
+    // Por isso aqui eu crio direto a zona do cluster, sem nada em volta.
+    if (spec.topology == ClusterTopology::Star) {
+        sg4::NetZone* zone = sg4::create_star_zone(spec.name);
+
+        for (int id = 0; id < spec.nodeCount; id++) {
+            sg4::Host* host = createNode(zone, spec, static_cast<unsigned long>(id));
+
+            const sg4::Link* link =
+                zone->create_split_duplex_link(host->get_name() + "_link", spec.linkBandwidth)
+                    ->set_latency(spec.linkLatency)
+                    ->seal();
+
+            // Cada no fala com o centro da estrela por um link proprio (UP e DOWN).
+            zone->add_route(host->get_netpoint(), nullptr, nullptr, nullptr,
+                            {sg4::LinkInRoute(link, sg4::LinkInRoute::Direction::UP)}, true);
+        }
+
+        zone->seal();
+        return;
+    }
+
+    // Em fat-tree e dragonfly o proprio SimGrid monta os roteadores e os links.
+    // Eu so preciso dizer como nasce cada no folha.
+    auto setNode = [&spec](sg4::NetZone* zone, const std::vector<unsigned long>& /*coord*/, unsigned long id) {
+        sg4::Host* host = createNode(zone, spec, id);
+        return std::make_pair(host->get_netpoint(), static_cast<simgrid::kernel::routing::NetPoint*>(nullptr));
+    };
+
+    sg4::ClusterCallbacks callbacks(std::function<sg4::ClusterCallbacks::ClusterNetPointCb>{setNode});
+
+    sg4::NetZone* zone = nullptr;
+    if (spec.topology == ClusterTopology::FatTree) {
+        zone = sg4::create_fatTree_zone(spec.name, nullptr, toFatTreeParams(spec.topoParameters), callbacks,
+                                        spec.linkBandwidth, spec.linkLatency,
+                                        sg4::Link::SharingPolicy::SPLITDUPLEX);
+    }
+    else {
+        zone = sg4::create_dragonfly_zone(spec.name, nullptr, toDragonflyParams(spec.topoParameters), callbacks,
+                                          spec.linkBandwidth, spec.linkLatency,
+                                          sg4::Link::SharingPolicy::SPLITDUPLEX);
+    }
+
+    zone->seal();
+}
+
+std::string PlatformBuilder::toXml(const PlatformSpec& spec) const
+{
+    int nodes = totalNodes(spec);
+
+    std::ostringstream xml;
+    xml << "<?xml version='1.0'?>\n";
+    xml << "<!DOCTYPE platform SYSTEM \"https://simgrid.org/simgrid.dtd\">\n";
+    xml << "<platform version=\"4.1\">\n";
+
+    // Se todos os nos sao iguais, um <cluster> resolve e continua compacto.
+    bool homogeneous = spec.nodeClasses.size() == 1;
+
+    if (homogeneous) {
+        const NodeClass& nodeClass = spec.nodeClasses.front();
+
+        xml << "  <cluster id=\"" << spec.name << "\""
+            << " prefix=\"" << spec.hostPrefix << "\" suffix=\"\""
+            << " radical=\"0-" << (nodes - 1) << "\""
+            << " speed=\"" << nodeClass.speedFlops << "f\""
+            << " core=\"" << nodeClass.cores << "\""
+            << " bw=\"" << spec.linkBandwidth << "Bps\""
+            << " lat=\"" << spec.linkLatency << "s\""
+            << " sharing_policy=\"SPLITDUPLEX\"";
+
+        if (spec.topology != ClusterTopology::Star) {
+            xml << " topology=\"" << topologyXmlName(spec.topology) << "\""
+                << " topo_parameters=\"" << spec.topoParameters << "\"";
+        }
+
+        xml << ">\n";
+        writeEnergyProps(xml, nodeClass, "    ");
+        xml << "  </cluster>\n";
+        xml << "</platform>\n";
+        return xml.str();
+    }
+
+    // O <cluster> do XML so aceita nos iguais.
+    // Para a estrela heterogenea eu escrevo os hosts um a um numa zona Cluster.
+    if (spec.topology != ClusterTopology::Star) {
+        throw std::runtime_error(
+            "O XML do SimGrid nao descreve fat-tree ou dragonfly com nos diferentes. "
+            "Use uma unica classe de no para exportar essa plataforma."
+        );
+    }
+
+    xml << "  <zone id=\"" << spec.name << "\" routing=\"Cluster\">\n";
+
+    for (int id = 0; id < nodes; id++) {
+        const NodeClass& nodeClass = nodeClassFor(spec, static_cast<unsigned long>(id));
+        std::string name = hostName(spec, static_cast<unsigned long>(id));
+
+        xml << "    <host id=\"" << name << "\" speed=\"" << nodeClass.speedFlops << "f\""
+            << " core=\"" << nodeClass.cores << "\">\n";
+        writeEnergyProps(xml, nodeClass, "      ");
+        xml << "    </host>\n";
+        xml << "    <link id=\"" << name << "_link\" bandwidth=\"" << spec.linkBandwidth << "Bps\""
+            << " latency=\"" << spec.linkLatency << "s\" sharing_policy=\"SPLITDUPLEX\" />\n";
+        xml << "    <host_link id=\"" << name << "\" up=\"" << name << "_link_UP\""
+            << " down=\"" << name << "_link_DOWN\" />\n";
+    }
+
+    xml << "  </zone>\n";
+    xml << "</platform>\n";
+    return xml.str();
+}
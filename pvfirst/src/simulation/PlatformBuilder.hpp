@@ -0,0 +1,68 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Aqui eu descrevo uma plataforma do SimGrid direto em codigo.
+// A ideia e nao depender de um platform.xml gigante quando eu quero simular
+// maquinas grandes (milhares de nos): montar a plataforma pela API de zonas
+// do s4u e bem mais rapido do que fazer o SimGrid parsear o XML equivalente.
+
+enum class ClusterTopology
+{
+    Star,
+    FatTree,
+    Dragonfly
+};
+
+// Um bloco de nos iguais dentro do cluster.
+// Os blocos sao aplicados em ordem pelos ids dos nos.
+// Se a soma dos count for menor que o total de nos, o ultimo bloco cobre o resto.
+struct NodeClass
+{
+    int count     = 1;
+    double speedFlops = 50e9;
+    int cores     = 1;
+
+    // Mesmo formato das props do plugin de energia no platform.xml.
+    std::string wattagePerState = "120:250:250";
+    std::string wattageOff      = "10";
+};
+
+struct PlatformSpec
+{
+    ClusterTopology topology = ClusterTopology::Star;
+
+    std::string name       = "pvfirst-cluster";
+    std::string hostPrefix = "hpc-node-";
+
+    // So vale para Star.
+    // Em FatTree e Dragonfly o numero de nos sai de topoParameters.
+    int nodeCount = 1;
+
+    // Mesma sintaxe do atributo topo_parameters do <cluster> no XML:
+    // - FatTree  : "2;4,4;1,2;1,2"  (niveis;descidas;subidas;links paralelos)
+    // - Dragonfly: "3,4;3,2;3,1;2"  (grupos;chassis;roteadores;nos por roteador)
+    std::string topoParameters;
+
+    double linkBandwidth = 1.25e9; // bytes/s
+    double linkLatency   = 1e-6;   // s
+
+    std::vector<NodeClass> nodeClasses = {NodeClass{}};
+};
+
+class PlatformBuilder
+{
+public:
+    // Cria a plataforma no Engine atual.
+    // Precisa ser chamado depois do sg_host_energy_plugin_init, igual ao load_platform.
+    void build(const PlatformSpec& spec);
+
+    // Gera o XML equivalente, para quando eu precisar inspecionar ou versionar a plataforma.
+    std::string toXml(const PlatformSpec& spec) const;
+
+    int totalNodes(const PlatformSpec& spec) const;
+    std::string hostName(const PlatformSpec& spec, unsigned long id) const;
+
+    static ClusterTopology parseTopology(const std::string& text);
+};
@@ -3,48 +3,134 @@
 #include <simgrid/plugins/energy.h>
 #include <simgrid/s4u.hpp>
 
+#include <map>
 #include <stdexcept>
 
 namespace sg4 = simgrid::s4u;
 
+namespace
+{
+    // O SimGrid so aceita um Engine e uma plataforma por processo.
+    // Entao aqui eu guardo esse Engine ja pronto (plugin ligado, plataforma carregada)
+    // e os hosts ja resolvidos, para reaproveitar em todas as simulacoes seguintes.
+    struct SimGridSession
+    {
+        // Eu nunca destruo o Engine de proposito: ele vive ate o fim do processo,
+        // e destruir no meio dos destrutores estaticos so arrisca derrubar a saida.
+        // created e o Engine ja construido; engine so aponta para ele depois que a
+        // plataforma carregou, entao uma carga que falhou e tentada de novo na
+        // proxima execucao (o SimGrid nao deixa criar um segundo Engine).
+        sg4::Engine* created = nullptr;
+        sg4::Engine* engine = nullptr;
+
+        std::string platformKey;
+        std::map<std::string, sg4::Host*> hosts;
+    };
+
+    SimGridSession& session()
+    {
+        static SimGridSession instance;
+        return instance;
+    }
+
+    std::string platformKeyFor(const SimGridJobConfig& config)
+    {
+        if (config.useGeneratedPlatform)
+            return "generated:" + config.platformSpec.name;
+
+        return "xml:" + config.platformPath;
+    }
+
+    void openSession(const SimGridJobConfig& config)
+    {
+        SimGridSession& current = session();
+
+        // Os argumentos ficam estaticos porque o Engine vive ate o fim do processo.
+        static int argc = 1;
+        static char programName[] = "pvfirst";
+        static char* argv[] = {programName, nullptr};
+
+        if (current.created == nullptr) {
+            current.created = new sg4::Engine(&argc, argv);
+
+            // O plugin de energia precisa ser ligado antes do load_platform (ou do PlatformBuilder).
+            // Sem isso eu consigo simular o job, mas nao consigo ler o consumo energetico do host.
+            sg_host_energy_plugin_init();
+        }
+
+        if (config.useGeneratedPlatform) {
+            // Plataforma montada em codigo: nada de parsear XML.
+            PlatformBuilder builder;
+            builder.build(config.platformSpec);
+        }
+        else {
+            try {
+                current.created->load_platform(config.platformPath);
+            }
+            catch (const std::exception& e) {
+                throw std::runtime_error(
+                    "Nao consegui abrir a plataforma do SimGrid em: " + config.platformPath +
+                    " (" + e.what() + "). Verifique se o arquivo simgrid/platform.xml existe na raiz do projeto "
+                    "e se o CMake copiou esse arquivo para build/simgrid."
+                );
+            }
+        }
+
+        // So aqui a sessao passa a valer: com erro acima, engine continua nulo.
+        current.engine = current.created;
+        current.platformKey = platformKeyFor(config);
+    }
+
+    sg4::Host* resolveHost(const std::string& hostName)
+    {
+        SimGridSession& current = session();
+
+        auto cached = current.hosts.find(hostName);
+        if (cached != current.hosts.end())
+            return cached->second;
+
+        sg4::Host* host = current.engine->host_by_name_or_null(hostName);
+        if (host == nullptr) {
+            throw std::runtime_error(
+                "Nao encontrei o host '" + hostName +
+                "' dentro da plataforma do SimGrid."
+            );
+        }
+
+        current.hosts[hostName] = host;
+        return host;
+    }
+}
+
 SimGridJobResult SimGridJobRunner::run(const SimGridJobConfig& config)
 {
     // Eu deixei essa parte isolada para a logica principal do projeto continuar limpa.
     // O papel daqui e so este:
-    // 1) carregar a plataforma do SimGrid
+    // 1) carregar a plataforma do SimGrid (so na primeira vez do processo)
     // 2) mandar um host executar um job com certa quantidade de FLOPs
     // 3) medir quanto tempo esse job levou
     // 4) medir quanta energia o host consumiu nesse intervalo
 
-    int argc = 1;
-    char programName[] = "pvfirst";
-    char* argv[] = {programName, nullptr};
-
-    sg4::Engine engine(&argc, argv);
-
-    // O plugin de energia precisa ser ligado antes do load_platform.
-    // Sem isso eu consigo simular o job, mas nao consigo ler o consumo energetico do host.
-    sg_host_energy_plugin_init();
+    SimGridSession& current = session();
 
-    try {
-        engine.load_platform(config.platformPath);
+    if (current.engine == nullptr) {
+        openSession(config);
     }
-    catch (const std::exception&) {
+    else if (current.platformKey != platformKeyFor(config)) {
         throw std::runtime_error(
-            "Nao consegui abrir a plataforma do SimGrid em: " + config.platformPath +
-            ". Verifique se o arquivo simgrid/platform.xml existe na raiz do projeto "
-            "e se o CMake copiou esse arquivo para build/simgrid."
+            "O SimGrid ja esta com a plataforma '" + current.platformKey +
+            "' carregada neste processo e nao consegue trocar para '" +
+            platformKeyFor(config) + "'."
         );
     }
 
-    sg4::Host* host = engine.host_by_name(config.hostName);
-    if (host == nullptr) {
-        throw std::runtime_error(
-            "Nao encontrei o host '" + config.hostName +
-            "' dentro da plataforma do SimGrid."
-        );
-    }
+    std::string hostName = config.hostName;
+    if (hostName.empty())
+        hostName = config.useGeneratedPlatform ? PlatformBuilder().hostName(config.platformSpec, 0) : "hpc-node";
+
+    sg4::Host* host = resolveHost(hostName);
 
+    double jobFlops    = config.jobFlops;
     double startTime   = 0.0;
     double finishTime  = 0.0;
     double energyStart = sg_host_get_consumed_energy(host);
@@ -52,22 +138,24 @@ SimGridJobResult SimGridJobRunner::run(const SimGridJobConfig& config)
     // Aqui nasce o job do SimGrid.
     // Eu crio um ator no host escolhido e mando esse ator executar a carga computacional.
     // O SimGrid converte essa carga em tempo de execucao de acordo com a velocidade do host.
-    sg4::Actor::create("pvfirst_job", host, [config, &startTime, &finishTime]() {
+    sg4::Actor::create("pvfirst_job", host, [jobFlops, &startTime, &finishTime]() {
         startTime = sg4::Engine::get_clock();
 
         // Essa linha representa o trabalho computacional do job.
         // Se eu aumentar jobFlops, o job passa a exigir mais tempo e mais energia do host.
-        sg4::this_actor::execute(config.jobFlops);
+        sg4::this_actor::execute(jobFlops);
 
         finishTime = sg4::Engine::get_clock();
     });
 
-    engine.run();
+    // Nas execucoes seguintes o relogio simulado continua de onde parou.
+    // Como eu calculo duracao e energia por diferenca, isso nao muda o resultado.
+    current.engine->run();
 
     double energyFinish = sg_host_get_consumed_energy(host);
 
     SimGridJobResult result;
-    result.hostName        = config.hostName;
+    result.hostName        = hostName;
     result.jobFlops        = config.jobFlops;
     result.durationSeconds = finishTime - startTime;
     result.energyJoules    = energyFinish - energyStart;
@@ -82,4 +170,4 @@ SimGridJobResult SimGridJobRunner::run(const SimGridJobConfig& config)
     }
 
     return result;
-}
\ No newline at end of file
+}
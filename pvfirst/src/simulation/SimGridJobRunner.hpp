@@ -1,12 +1,21 @@
 #pragma once
 
+#include "PlatformBuilder.hpp"
+
 #include <string>
 
 struct SimGridJobConfig
 {
     std::string platformPath = "simgrid/platform.xml";
-    std::string hostName     = "hpc-node";
     double jobFlops          = 5e10;
+
+    // Vazio: "hpc-node" do platform.xml, ou o primeiro no (id 0) da plataforma gerada.
+    std::string hostName;
+
+    // Se ligado, eu monto a plataforma em codigo a partir de platformSpec
+    // em vez de parsear o platformPath.
+    bool useGeneratedPlatform = false;
+    PlatformSpec platformSpec;
 };
 
 struct SimGridJobResult
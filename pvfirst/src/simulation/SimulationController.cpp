@@ -1,53 +1,105 @@
 #include "SimulationController.hpp"
 #include "SimGridJobRunner.hpp"
-#include "sensors/GeoSensor.hpp"
-#include "sensors/MetarSensor.hpp"
-#include "sensors/SolarModel.hpp"
+#include "energy/TickModel.hpp"
+#include "metrics/Metrics.hpp"
+#include "sensors/SensorFallback.hpp"
+#include "storage/CivilTime.hpp"
+#include "storage/ResultsCsvWriter.hpp"
+#include "storage/TimingCsvWriter.hpp"
 
-#include <ctime>
 #include <filesystem>
-#include <fstream>
-#include <iomanip>
 #include <iostream>
-#include <sstream>
-#include <stdexcept>
+#include <utility>
 
 namespace
 {
-    // Aqui eu converti o tipo de material em um fator multiplicador simples.
-    // A base do projeto continua sendo a eficiencia configurada em baseEfficiency.
-    // O material ajusta essa base para representar paineis diferentes sem complicar demais o modelo.
-    double getPanelMaterialFactor(const std::string& material)
+    // O registro binario sai do mesmo report que alimenta a saida e o CSV.
+    EventRecord makeEvent(const TickReport& report, EventType type, std::time_t now, std::int64_t tickNs)
     {
-        if (material == "monocrystalline")
-            return 1.00;
+        const ResultRow& row = report.row;
+
+        EventRecord event;
+        event.timestamp = static_cast<std::int64_t>(now);
+        event.type      = static_cast<std::uint16_t>(type);
+        event.latitude  = row.latitude;
+        event.longitude = row.longitude;
+
+        event.locationSource = static_cast<std::uint8_t>(report.locationSource);
+        event.weatherSource  = static_cast<std::uint8_t>(report.weatherSource);
+
+        event.irradianceTheoreticalWm2 = row.irradianceTheoreticalWm2;
+        event.irradianceAdjustedWm2    = row.irradianceAdjustedWm2;
+        event.pvPowerKW                = row.pvPowerKW;
+
+        event.cloudCoverPct = row.cloudCoverPct;
+        event.rainMm        = row.rainMm;
+        event.temperatureC  = row.temperatureC;
+        event.windSpeedKmh  = row.windSpeedKmh;
+
+        event.jobDurationS  = row.jobDurationS;
+        event.jobEnergyKWh  = row.jobEnergyKWh;
+        event.energyPvKWh   = row.energyPvKWh;
+        event.energyGridKWh = row.energyGridKWh;
+        event.co2G          = row.co2G;
+
+        event.tickNs = tickNs;
+        return event;
+    }
+}
 
-        if (material == "polycrystalline")
-            return 0.90;
+SimulationController::SimulationController()
+    : config(),
+      model(config.gridCarbonIntensity),
+      fetcher(curlHttpGet),
+      clock([]() { return std::time(nullptr); }),
+      output(makeTickOutput(config.output, std::cout))
+{
+    loadCarbonProfile();
+}
 
-        if (material == "thinfilm")
-            return 0.65;
+SimulationController::SimulationController(const SimulationConfig& simulationConfig)
+    : config(simulationConfig),
+      model(config.gridCarbonIntensity),
+      fetcher(curlHttpGet),
+      clock([]() { return std::time(nullptr); }),
+      output(makeTickOutput(config.output, std::cout))
+{
+    loadCarbonProfile();
+}
 
-        // Se vier um texto inesperado, eu nao travo o programa.
-        // So volto para um fator neutro.
-        return 1.00;
-    }
+void SimulationController::loadCarbonProfile()
+{
+    if (config.carbonProfilePath.empty())
+        return;
 
-    // Aqui eu trato o efeito de monofacial ou bifacial.
-    // Se for bifacial, eu aplico um ganho extra configuravel.
-    double getPanelFaceGain(const std::string& faceType, double bifacialGainFactor)
-    {
-        if (faceType == "bifacial")
-            return bifacialGainFactor;
+    carbonProfile = std::make_unique<CarbonIntensityProfile>(
+        CarbonIntensityProfile::loadCsv(config.carbonProfilePath));
+    carbonCursor = std::make_unique<CarbonIntensityCursor>(*carbonProfile);
+}
 
-        return 1.0;
-    }
+void SimulationController::setHttpFetcher(HttpFetcher httpFetcher)
+{
+    fetcher = std::move(httpFetcher);
 }
 
-SimulationController::SimulationController()
-    : config(),
-      model(config.gridCarbonIntensity)
+void SimulationController::setClock(std::function<std::time_t()> tickClock)
+{
+    clock = std::move(tickClock);
+}
+
+void SimulationController::setEventLog(EventLog* log)
 {
+    eventLog = log;
+}
+
+void SimulationController::setIrradianceStream(IrradianceStream* stream)
+{
+    irradianceStream = stream;
+}
+
+const TickProfile& SimulationController::getLastProfile() const
+{
+    return lastProfile;
 }
 
 double SimulationController::parseJobInput(const std::string& input)
@@ -61,10 +113,17 @@ double SimulationController::parseJobInput(const std::string& input)
 
 double SimulationController::askJobFlops()
 {
+    if (!config.askJobInput)
+        return config.defaultJobFlops;
+
     std::string input;
 
-    std::cout << "Digite a carga do job em FLOPs (ex: 5e10).\n";
-    std::cout << "Se quiser usar o valor padrao, e so apertar Enter: ";
+    // Fora do modo texto o stdout e so dos registros (JSON lines) ou de nada:
+    // a pergunta vai para o stderr.
+    std::ostream& prompt = config.output == OutputMode::Text ? std::cout : std::cerr;
+    prompt << "Digite a carga do job em FLOPs (ex: 5e10).\n";
+    prompt << "Se quiser usar o valor padrao, e so apertar Enter: ";
+    prompt.flush();
     std::getline(std::cin, input);
 
     return parseJobInput(input);
@@ -72,27 +131,71 @@ double SimulationController::askJobFlops()
 
 void SimulationController::run()
 {
-    std::cout << "\n============================================================\n";
-    std::cout << "SIMULACAO PV-FIRST COM JOB DO SIMGRID\n";
-    std::cout << "============================================================\n\n";
+    // Cada bloco abaixo mede o proprio tempo com um StageSpan.
+    // Com config.stageTiming desligado, profile fica nulo e os spans nao medem nada.
+    lastProfile = TickProfile{};
+    TickProfile* profile = config.stageTiming ? &lastProfile : nullptr;
 
-    std::cout << "Fluxo da simulacao:\n";
-    std::cout << "1) eu verifico local, clima e irradiancia solar\n";
-    std::cout << "2) se houver irradiancia util, o SimGrid executa o job\n";
-    std::cout << "3) a politica PV-First tenta atender primeiro o job com a placa\n\n";
+    // O total vai para o log de eventos mesmo sem --timing: sao so duas leituras do relogio.
+    auto tickStart = std::chrono::steady_clock::now();
 
-    // ============================== LOCALIZACAO ==============================
-    // Aqui eu pego a localizacao atual do experimento.
-    // Isso serve de base para o clima e para o calculo solar.
-    GeoSensor geo;
-    GPSData gps = geo.getLocation();
+    PvfirstMetrics& processMetrics = metrics();
+    processMetrics.ticks.inc();
+
+    // O prazo conta do inicio da execucao, com o relogio monotonico.
+    auto deadline = std::chrono::steady_clock::now() +
+                    std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                        std::chrono::duration<double>(config.tickDeadlineSeconds));
+
+    SensorFallback sensors(fetcher, (std::filesystem::path(config.resultsDir) / "SPVfirst_sensores.txt").string());
+    if (!config.metarFeedPath.empty())
+        sensors.setMetarFeed(config.metarFeedPath, config.metarStation);
+
+    // Tudo o que esta execucao produz vai sendo juntado aqui.
+    // A saida (texto, JSON lines ou nada), o CSV e o log de eventos leem do report.
+    TickReport report;
+    ResultRow& row = report.row;
+
+    {
+        StageSpan span(profile, TickStage::Console);
+        output->tickStarted();
+    }
 
     // ========================== HORA LOCAL E DIA =============================
     // Aqui eu uso a hora local da maquina.
     // Isso define o dia do ano e a hora decimal que entram no modelo solar.
-    std::time_t now = std::time(nullptr);
+    std::time_t now = clock();
     std::tm localTime = *std::localtime(&now);
 
+    // ============================ MEDIDOR LOCAL ==============================
+    // Com o piranometro (ou o inversor) ligado, a media dos ultimos segundos
+    // medidos vale mais que o modelo. Amostra velha demais quer dizer medidor parado.
+    // A janela fecha aqui, junto com a hora da execucao, antes de esperar pelas APIs.
+    StreamWindow measured;
+    if (irradianceStream != nullptr) {
+        irradianceStream->drain();
+
+        std::int64_t nowNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        measured = irradianceStream->window(nowNs, config.streamWindowSeconds);
+
+        if (measured.count > 0 && nowNs - measured.lastTimeNs > static_cast<std::int64_t>(config.streamMaxAgeSeconds * 1e9))
+            measured = StreamWindow{};
+    }
+    report.streamSamples = measured.count;
+
+    // ============================== LOCALIZACAO ==============================
+    // Aqui eu pego a localizacao atual do experimento.
+    // Isso serve de base para o clima e para o calculo solar.
+    // Se a API nao responder a tempo, vem o ultimo local bom ou o padrao.
+    GPSData gps;
+    {
+        StageSpan span(profile, TickStage::Location);
+        LocationReading location = sensors.location(static_cast<std::int64_t>(now), deadline);
+        gps = location.gps;
+        report.locationSource = location.source;
+    }
+
     int dayOfYear = localTime.tm_yday + 1;
     int hourInt   = localTime.tm_hour;
     int minuteInt = localTime.tm_min;
@@ -101,86 +204,84 @@ void SimulationController::run()
     double hourDecimal = hourInt + minuteInt / 60.0;
 
     // ========================== CLIMA E IRRADIANCIA ==========================
-    // Primeiro eu calculo a irradiancia teorica.
-    // Depois puxo os fatores meteorologicos reais.
-    SolarModel solar;
-    double irradianceTheoreticalWm2 =
-        solar.computeIrradiance(gps.latitude, dayOfYear, hourDecimal);
+    // Aqui eu puxo os fatores meteorologicos reais.
+    // A irradiancia teorica sai junto com o painel, logo abaixo.
+    WeatherImpact impact;
+    {
+        StageSpan span(profile, TickStage::Weather);
+        WeatherReading weather =
+            sensors.weather(gps.latitude, gps.longitude, static_cast<std::int64_t>(now), deadline);
+        impact = weather.impact;
+        report.weatherSource = weather.source;
+        sensors.save();
+    }
 
-    MetarSensor metar;
-    WeatherImpact impact = metar.getWeatherImpact(gps.latitude, gps.longitude);
+    // ======================== PARAMETROS DO PAINEL ===========================
+    // Aqui eu aplico clima e parametros do painel em cima da irradiancia teorica
+    // (ou da medida). A conta inteira fica no TickModel, a mesma que o pvfirst_golden
+    // confere contra os dias de referencia.
+    TickPvInput pvInput;
+    pvInput.latitude    = gps.latitude;
+    pvInput.dayOfYear   = dayOfYear;
+    pvInput.hourDecimal = hourDecimal;
+    pvInput.impact      = impact;
+    pvInput.measured    = measured;
+    if (irradianceStream != nullptr)
+        pvInput.measuredQuantity = irradianceStream->quantity();
+
+    TickPv pvTick;
+    {
+        StageSpan span(profile, TickStage::Solar);
+        pvTick = evaluateTickPv(config.pv, pvInput);
+    }
 
-    // Aqui eu reduzo a irradiancia teorica com os fatores de nuvem e chuva.
-    double irradianceAdjustedWm2 =
-        irradianceTheoreticalWm2 *
-        impact.cloudFactor *
-        impact.rainFactor;
+    const PanelOutput& panel = pvTick.panel;
+    double irradianceTheoreticalWm2 = pvTick.irradianceTheoreticalWm2;
+    double irradianceAdjustedWm2    = panel.irradianceAdjustedWm2;
+    double pvPowerKW                = panel.pvPowerKW;
+
+    processMetrics.pvPowerKW.set(pvPowerKW);
+    processMetrics.irradianceTheoreticalWm2.set(irradianceTheoreticalWm2);
+    processMetrics.irradianceAdjustedWm2.set(irradianceAdjustedWm2);
+
+    row.year   = localTime.tm_year + 1900;
+    row.month  = localTime.tm_mon + 1;
+    row.day    = localTime.tm_mday;
+    row.hour   = hourInt;
+    row.minute = minuteInt;
+    row.second = secondInt;
+
+    row.dayOfYear = dayOfYear;
+    row.city      = gps.city;
+    row.latitude  = gps.latitude;
+    row.longitude = gps.longitude;
+
+    row.panelMaterial                = config.pv.panelMaterial;
+    row.panelFaceType                = config.pv.panelFaceType;
+    row.panelAreaM2                  = config.pv.panelAreaM2;
+    row.panelBaseEfficiency          = config.pv.baseEfficiency;
+    row.panelMaterialFactor          = panel.materialFactor;
+    row.panelEffectiveBaseEfficiency = panel.effectiveBaseEfficiency;
+    row.panelBifacialGainFactor      = config.pv.bifacialGainFactor;
+
+    row.cloudCoverPct = impact.cloudCover;
+    row.rainMm        = impact.rainAmount;
+    row.temperatureC  = impact.temperature;
+    row.windSpeedKmh  = impact.windSpeed;
+
+    row.irradianceTheoreticalWm2 = irradianceTheoreticalWm2;
+    row.irradianceAdjustedWm2    = irradianceAdjustedWm2;
+    row.pvEfficiency             = panel.pvEfficiency;
+    row.pvPowerKW                = pvPowerKW;
+
+    // Com perfil, aqui vai o fator do instante; na triagem ele vira a media da janela do job.
+    row.gridCarbonIntensity = carbonCursor ? carbonCursor->average(rowSeconds(row), 0.0)
+                                           : config.gridCarbonIntensity;
 
-    // ======================== PARAMETROS DO PAINEL ===========================
-    // Aqui eu aplico a parte modular do painel sem criar arquivo novo.
-    // A ideia e:
-    // - baseEfficiency representa a eficiencia de referencia do experimento
-    // - panelMaterial ajusta essa base para o tipo de tecnologia
-    // - panelFaceType ajusta o ganho extra se o painel for bifacial
-    double materialFactor =
-        getPanelMaterialFactor(config.pv.panelMaterial);
-
-    double effectiveBaseEfficiency =
-        config.pv.baseEfficiency * materialFactor;
-
-    double faceGain =
-        getPanelFaceGain(
-            config.pv.panelFaceType,
-            config.pv.bifacialGainFactor
-        );
-
-    // Agora eu monto a eficiencia final do arranjo.
-    // Primeiro ajusto pela tecnologia do painel.
-    // Depois aplico temperatura, vento e eventualmente ganho bifacial.
-    double pvEfficiency =
-        effectiveBaseEfficiency *
-        impact.tempFactor *
-        impact.windCoolingFactor *
-        faceGain;
-
-    double pvPowerKW =
-        pvEfficiency *
-        config.pv.panelAreaM2 *
-        irradianceAdjustedWm2 / 1000.0;
-
-    if (pvPowerKW < 0.0)
-        pvPowerKW = 0.0;
-
-    std::cout << "\n-------------------- DADOS DO LOCAL --------------------\n";
-    std::cout << "Cidade detectada : " << gps.city << "\n";
-    std::cout << "Latitude         : " << gps.latitude << "\n";
-    std::cout << "Longitude        : " << gps.longitude << "\n";
-    std::cout << "Hora local       : "
-              << std::setfill('0') << std::setw(2) << hourInt << ":"
-              << std::setfill('0') << std::setw(2) << minuteInt << ":"
-              << std::setfill('0') << std::setw(2) << secondInt << "\n";
-    std::cout << "Dia do ano       : " << dayOfYear << "\n";
-
-    std::cout << "\n------------------ CONDICOES DO CLIMA ------------------\n";
-    std::cout << "Cobertura nuvens : " << impact.cloudCover << " %\n";
-    std::cout << "Chuva            : " << impact.rainAmount << " mm\n";
-    std::cout << "Temperatura      : " << impact.temperature << " C\n";
-    std::cout << "Vento            : " << impact.windSpeed << " km/h\n";
-
-    std::cout << "\n----------------- CONFIGURACAO DO PAINEL ----------------\n";
-    std::cout << "Material          : " << config.pv.panelMaterial << "\n";
-    std::cout << "Face do painel    : " << config.pv.panelFaceType << "\n";
-    std::cout << "Area do painel    : " << config.pv.panelAreaM2 << " m2\n";
-    std::cout << "Eficiencia base   : " << config.pv.baseEfficiency << "\n";
-    std::cout << "Ganho bifacial    : " << config.pv.bifacialGainFactor << "\n";
-    std::cout << "Fator do material : " << materialFactor << "\n";
-
-    std::cout << "\n----------------- MODELO FOTOVOLTAICO ------------------\n";
-    std::cout << "Irradiancia teorica      : " << irradianceTheoreticalWm2 << " W/m2\n";
-    std::cout << "Irradiancia ajustada     : " << irradianceAdjustedWm2 << " W/m2\n";
-    std::cout << "Eficiencia base efetiva  : " << effectiveBaseEfficiency << "\n";
-    std::cout << "Eficiencia final arranjo : " << pvEfficiency << "\n";
-    std::cout << "Potencia PV disponivel   : " << pvPowerKW << " kW\n";
+    {
+        StageSpan span(profile, TickStage::Console);
+        output->environmentReady(report);
+    }
 
     // ====================== FILTRO DE IRRADIANCIA UTIL =======================
     // Aqui esta o ponto principal para nao encher o CSV com dados sem sentido.
@@ -189,22 +290,21 @@ void SimulationController::run()
     // Assim:
     // - nao rodo o job no SimGrid sem necessidade
     // - nao salvo linha no CSV
-    // - o script externo entende que ainda nao comecou o periodo solar
-    //   ou que o periodo solar ja terminou.
-    //
-    // Esse texto PVFIRST_SEM_IRRADIANCIA e proposital.
-    // O script run_solar_window.sh usa exatamente essa frase para decidir
-    // se continua aguardando ou se encerra o experimento do dia.
-    const double irradianceMinimumToRun = 1.0; // W/m2
-
+    // - quem roda uma execucao por vez ve PVFIRST_SEM_IRRADIANCIA na saida em texto
+    //   (o daemon com --janela-solar nem chega aqui fora do periodo solar).
     if (irradianceAdjustedWm2 <= irradianceMinimumToRun || pvPowerKW <= 0.0) {
-        std::cout << "\nPVFIRST_SEM_IRRADIANCIA\n";
-        std::cout << "Sem irradiancia util neste instante.\n";
-        std::cout << "Nenhum job foi executado no SimGrid.\n";
-        std::cout << "Nenhum resultado foi salvo no CSV.\n";
-        std::cout << "\n============================================================\n";
-        std::cout << "EXECUCAO ENCERRADA SEM REGISTRO\n";
-        std::cout << "============================================================\n";
+        report.status = "sem_irradiancia";
+
+        {
+            StageSpan span(profile, TickStage::Console);
+            output->tickFinished(report);
+        }
+
+        processMetrics.ticksWithoutIrradiance.inc();
+        finishTickTiming(localTime, report.status, tickStart);
+
+        if (eventLog != nullptr)
+            eventLog->append(makeEvent(report, EventType::NoIrradiance, now, lastProfile.totalNs));
         return;
     }
 
@@ -216,20 +316,28 @@ void SimulationController::run()
     // Aqui o SimGrid continua sendo a fonte oficial da demanda do job.
     // Ou seja: a duracao, a energia e a potencia media saem da simulacao computacional,
     // e nao de um chute feito no controller.
-    SimGridJobRunner jobRunner;
-    SimGridJobConfig jobConfig;
-    jobConfig.jobFlops = jobFlops;
+    SimGridJobResult job;
+    {
+        StageSpan span(profile, TickStage::SimGrid);
+
+        SimGridJobRunner jobRunner;
+        SimGridJobConfig jobConfig;
+        jobConfig.jobFlops = jobFlops;
 
-    SimGridJobResult job = jobRunner.run(jobConfig);
+        auto simgridStart = std::chrono::steady_clock::now();
+        job = jobRunner.run(jobConfig);
+        processMetrics.simgridRunSeconds.observe(
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - simgridStart).count());
+    }
 
-    std::cout << "\n--------------------- JOB DO SIMGRID -------------------\n";
-    std::cout << "Host usado           : " << job.hostName << "\n";
-    std::cout << "Carga do job         : " << job.jobFlops << " FLOPs\n";
-    std::cout << "Velocidade do host   : " << job.hostSpeedFlops << " flop/s\n";
-    std::cout << "Duracao do job       : " << job.durationSeconds << " s\n";
-    std::cout << "Energia do job       : " << job.energyJoules << " J\n";
-    std::cout << "Energia do job       : " << job.energyKWh << " kWh\n";
-    std::cout << "Potencia media do job: " << job.averagePowerKW << " kW\n";
+    report.hostName       = job.hostName;
+    report.hostSpeedFlops = job.hostSpeedFlops;
+
+    row.jobFlops          = job.jobFlops;
+    row.jobDurationS      = job.durationSeconds;
+    row.jobEnergyJ        = job.energyJoules;
+    row.jobEnergyKWh      = job.energyKWh;
+    row.jobAveragePowerKW = job.averagePowerKW;
 
     // ============================= TRIAGEM PV-FIRST ==========================
     // Aqui eu junto os dois lados do problema:
@@ -238,154 +346,81 @@ void SimulationController::run()
     //
     // A politica PV-First entra justamente aqui:
     // primeiro tenta atender com a placa, depois empurra o resto para a rede.
-    model.update(job.averagePowerKW, pvPowerKW, job.durationSeconds);
-    EnergyStats stats = model.getStats();
-
-    double pvPossibleKWh = pvPowerKW * (job.durationSeconds / 3600.0);
-
-    std::cout << "\n-------------------- RESULTADO PV-FIRST ----------------\n";
-    std::cout << "Energia total do job  : " << stats.E_total << " kWh\n";
-    std::cout << "Energia vinda da PV   : " << stats.E_pv << " kWh\n";
-    std::cout << "Energia vinda da rede : " << stats.E_grid << " kWh\n";
-    std::cout << "CO2 da parte da rede  : " << stats.CO2 << " gCO2\n";
-
-    std::cout << "\nLeitura rapida do experimento:\n";
-    std::cout << "- o job do SimGrid pediu " << job.energyKWh << " kWh no total\n";
-    std::cout << "- a placa poderia entregar ate " << pvPossibleKWh << " kWh nesse mesmo intervalo\n";
-    std::cout << "- a politica PV-First usou primeiro a energia solar e mandou o resto para a rede\n";
+    {
+        StageSpan span(profile, TickStage::Triage);
+
+        EnergyStats before = model.getStats();
+
+        // O CO2 da rede e cobrado pelo fator medio enquanto o job rodou.
+        double carbonIntensity = config.gridCarbonIntensity;
+        if (carbonCursor) {
+            carbonIntensity = carbonCursor->average(rowSeconds(row), job.durationSeconds);
+            row.gridCarbonIntensity = carbonIntensity;
+        }
+
+        // A placa entra com a potencia media enquanto o job rodou (ver evaluateTickEnergy).
+        TickJob tickJob;
+        tickJob.averagePowerKW  = job.averagePowerKW;
+        tickJob.durationSeconds = job.durationSeconds;
+        tickJob.carbonIntensity = carbonIntensity;
+
+        double pvWindowKW =
+            evaluateTickEnergy(config.pv, pvInput, pvTick, tickJob, JobPvMode::WindowAverage, model);
+        EnergyStats stats = model.getStats();
+
+        row.energyTotalKWh = stats.E_total;
+        row.energyPvKWh    = stats.E_pv;
+        row.energyGridKWh  = stats.E_grid;
+        row.co2G           = stats.CO2;
+
+        report.pvPossibleKWh = pvWindowKW * (job.durationSeconds / 3600.0);
+
+        // Nas metricas entra so o que este job somou.
+        // O acumulado do processo inteiro fica por conta dos contadores.
+        processMetrics.energyTotalKWh.add(stats.E_total - before.E_total);
+        processMetrics.energyPvKWh.add(stats.E_pv - before.E_pv);
+        processMetrics.energyGridKWh.add(stats.E_grid - before.E_grid);
+        processMetrics.co2G.add(stats.CO2 - before.CO2);
+    }
 
-        // ================================ CSV ====================================
+    // ================================ CSV ====================================
     // Aqui eu salvo um arquivo por dia dentro da pasta results na raiz do projeto.
-    // Agora usei ponto e virgula como separador, porque no Excel em portugues
-    // o CSV com virgula costuma abrir todo baguncado.
     //
     // Exemplo:
     // results/RPVfirst170626.csv
+    {
+        StageSpan span(profile, TickStage::Csv);
 
-    std::filesystem::create_directories("results");
-
-    std::ostringstream fileNameBuilder;
-    fileNameBuilder << "RPVfirst"
-                    << std::setfill('0') << std::setw(2) << localTime.tm_mday
-                    << std::setfill('0') << std::setw(2) << (localTime.tm_mon + 1)
-                    << std::setfill('0') << std::setw(2) << ((localTime.tm_year + 1900) % 100)
-                    << ".csv";
+        ResultsCsvWriter writer(config.resultsDir);
+        report.resultsFile = writer.append(row).string();
+    }
 
-    std::filesystem::path resultsFilePath =
-        std::filesystem::path("results") / fileNameBuilder.str();
+    {
+        StageSpan span(profile, TickStage::Console);
+        output->tickFinished(report);
+    }
 
-    bool fileExists = std::filesystem::exists(resultsFilePath);
+    finishTickTiming(localTime, report.status, tickStart);
 
-    std::ofstream file(resultsFilePath, std::ios::app);
+    // ============================ LOG DE EVENTOS =============================
+    // Um registro binario de tamanho fixo por execucao, sem formatar nada.
+    // O "pvfirst log" e quem transforma isso em texto depois.
+    if (eventLog != nullptr)
+        eventLog->append(makeEvent(report, EventType::TickOk, now, lastProfile.totalNs));
+}
 
-    if (!file.is_open()) {
-        throw std::runtime_error(
-            "Nao consegui abrir ou criar o arquivo de resultados em: " +
-            resultsFilePath.string()
-        );
-    }
+void SimulationController::finishTickTiming(const std::tm& localTime,
+                                            const std::string& status,
+                                            std::chrono::steady_clock::time_point tickStart)
+{
+    lastProfile.totalNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - tickStart).count();
 
-    std::ostringstream runDateBuilder;
-    runDateBuilder << (localTime.tm_year + 1900) << "-"
-                   << std::setfill('0') << std::setw(2) << (localTime.tm_mon + 1) << "-"
-                   << std::setfill('0') << std::setw(2) << localTime.tm_mday;
-
-    std::ostringstream runTimeBuilder;
-    runTimeBuilder << std::setfill('0') << std::setw(2) << hourInt << ":"
-                   << std::setfill('0') << std::setw(2) << minuteInt << ":"
-                   << std::setfill('0') << std::setw(2) << secondInt;
-
-    std::ostringstream runDateTimeBuilder;
-    runDateTimeBuilder << runDateBuilder.str() << " " << runTimeBuilder.str();
-
-    std::ostringstream runIdBuilder;
-    runIdBuilder << "run_"
-                 << (localTime.tm_year + 1900)
-                 << std::setfill('0') << std::setw(2) << (localTime.tm_mon + 1)
-                 << std::setfill('0') << std::setw(2) << localTime.tm_mday
-                 << "_"
-                 << std::setfill('0') << std::setw(2) << hourInt
-                 << std::setfill('0') << std::setw(2) << minuteInt
-                 << std::setfill('0') << std::setw(2) << secondInt;
-
-    const char sep = ';';
-
-    if (!fileExists) {
-        file << "run_id" << sep
-             << "run_date" << sep
-             << "run_time" << sep
-             << "run_datetime" << sep
-             << "day_of_year" << sep
-             << "city" << sep
-             << "latitude" << sep
-             << "longitude" << sep
-             << "panel_material" << sep
-             << "panel_face_type" << sep
-             << "panel_area_m2" << sep
-             << "panel_base_efficiency" << sep
-             << "panel_material_factor" << sep
-             << "panel_effective_base_efficiency" << sep
-             << "panel_bifacial_gain_factor" << sep
-             << "cloud_cover_pct" << sep
-             << "rain_mm" << sep
-             << "temperature_c" << sep
-             << "wind_speed_kmh" << sep
-             << "irradiance_theoretical_w_m2" << sep
-             << "irradiance_adjusted_w_m2" << sep
-             << "pv_efficiency" << sep
-             << "pv_power_kw" << sep
-             << "grid_carbon_intensity_gco2_kwh" << sep
-             << "job_flops" << sep
-             << "job_duration_s" << sep
-             << "job_energy_j" << sep
-             << "job_energy_kwh" << sep
-             << "job_average_power_kw" << sep
-             << "energy_total_kwh" << sep
-             << "energy_pv_kwh" << sep
-             << "energy_grid_kwh" << sep
-             << "co2_g\n";
-    }
+    if (!config.stageTiming)
+        return;
 
-    file << runIdBuilder.str() << sep
-         << runDateBuilder.str() << sep
-         << runTimeBuilder.str() << sep
-         << runDateTimeBuilder.str() << sep
-         << dayOfYear << sep
-         << "\"" << gps.city << "\"" << sep
-         << gps.latitude << sep
-         << gps.longitude << sep
-         << "\"" << config.pv.panelMaterial << "\"" << sep
-         << "\"" << config.pv.panelFaceType << "\"" << sep
-         << config.pv.panelAreaM2 << sep
-         << config.pv.baseEfficiency << sep
-         << materialFactor << sep
-         << effectiveBaseEfficiency << sep
-         << config.pv.bifacialGainFactor << sep
-         << impact.cloudCover << sep
-         << impact.rainAmount << sep
-         << impact.temperature << sep
-         << impact.windSpeed << sep
-         << irradianceTheoreticalWm2 << sep
-         << irradianceAdjustedWm2 << sep
-         << pvEfficiency << sep
-         << pvPowerKW << sep
-         << config.gridCarbonIntensity << sep
-         << job.jobFlops << sep
-         << job.durationSeconds << sep
-         << job.energyJoules << sep
-         << job.energyKWh << sep
-         << job.averagePowerKW << sep
-         << stats.E_total << sep
-         << stats.E_pv << sep
-         << stats.E_grid << sep
-         << stats.CO2 << "\n";
-
-    file.close();
-
-    std::cout << "\nDados salvos em: "
-              << resultsFilePath.string() << "\n";
-
-    std::cout << "\n============================================================\n";
-    std::cout << "SIMULACAO FINALIZADA\n";
-    std::cout << "============================================================\n";
-}
\ No newline at end of file
+    // A escrita do arquivo de tempos fica fora do total de proposito:
+    // ela so existe quando a medicao esta ligada.
+    TimingCsvWriter timingWriter(config.resultsDir);
+    timingWriter.append(localTime, status, lastProfile);
+}
@@ -1,28 +1,20 @@
 #pragma once
 
+#include "energy/CarbonIntensityProfile.hpp"
 #include "energy/EnergyModel.hpp"
+#include "energy/PanelModel.hpp"
+#include "sensors/HttpClient.hpp"
+#include "sensors/IrradianceStream.hpp"
+#include "storage/EventLog.hpp"
+#include "TickOutput.hpp"
+#include "TickProfile.hpp"
 
+#include <chrono>
+#include <ctime>
+#include <functional>
+#include <memory>
 #include <string>
 
-// Aqui eu concentrei os parametros do painel em uma struct simples.
-// A ideia e deixar o experimento mais modular sem mudar a estrutura do projeto.
-//
-// Para trocar o painel, basta alterar estes valores:
-// - panelMaterial: monocrystalline, polycrystalline, thinfilm
-// - panelFaceType: monofacial, bifacial
-// - panelAreaM2
-// - baseEfficiency
-// - bifacialGainFactor
-struct PVConfig
-{
-    std::string panelMaterial = "monocrystalline";
-    std::string panelFaceType = "monofacial";
-
-    double panelAreaM2 = 10.0;
-    double baseEfficiency = 0.20;
-    double bifacialGainFactor = 1.10;
-};
-
 // Aqui ficam os parametros gerais do experimento.
 // O jobFlops continua entrando pelo usuario durante a execucao,
 // mas eu deixei um valor padrao para o caso de apertar Enter.
@@ -31,21 +23,98 @@ struct SimulationConfig
     double defaultJobFlops = 5e10;
     double gridCarbonIntensity = 100.0;
 
+    // Arquivo com o fator da rede ao longo do dia/ano (ver CarbonIntensityProfile.hpp).
+    // Vazio: vale o gridCarbonIntensity fixo acima.
+    std::string carbonProfilePath;
+
+    // No modo interativo eu pergunto os FLOPs do job no terminal.
+    // No modo daemon ninguem responde, entao eu uso direto o defaultJobFlops.
+    bool askJobInput = true;
+
+    // Pasta onde sai o CSV diario.
+    // O estado dos sensores (disjuntores, ultimos valores, previsao) fica nela tambem,
+    // em SPVfirst_sensores.txt.
+    std::string resultsDir = "results";
+
+    // Prazo para local e clima juntos, contado do inicio da execucao.
+    // Passou disso, as APIs nao sao mais esperadas e entram as reservas
+    // (ver SensorFallback.hpp). Com a cadencia de 60 s, 20 s deixam folga.
+    double tickDeadlineSeconds = 20.0;
+
+    // Arquivo ou pasta de METAR (opcional). Quando tem relatorio recente da
+    // estacao, o clima vem dele antes da API. SBBE e o aeroporto de Belem.
+    std::string metarFeedPath;
+    std::string metarStation = "SBBE";
+
+    // Medidor local (ver IrradianceStream.hpp). Com ele ligado, a irradiancia
+    // (ou a potencia do inversor) da execucao e a media das amostras dos ultimos
+    // streamWindowSeconds, no lugar do modelo com os fatores do clima.
+    // Se a amostra mais nova tiver mais que streamMaxAgeSeconds, o medidor e ignorado.
+    double streamWindowSeconds = 10.0;
+    double streamMaxAgeSeconds = 5.0;
+
+    // Liga a medicao de tempo por etapa (localizacao, clima, SimGrid, CSV...).
+    // Os tempos vao para results/TPVfirstDDMMAA.csv, uma linha por execucao.
+    // Desligado, o custo e so um teste de ponteiro por etapa.
+    bool stageTiming = false;
+
+    // Como cada execucao aparece no terminal: o texto de sempre,
+    // uma linha JSON por execucao ou nada (o CSV continua sendo gravado).
+    OutputMode output = OutputMode::Text;
+
     PVConfig pv;
 };
 
 class SimulationController
 {
 public:
+    // Abaixo disso (irradiancia ajustada, W/m2) a execucao para antes do SimGrid.
+    // O daemon com --janela-solar usa o mesmo valor para saber quando dormir.
+    static constexpr double irradianceMinimumToRun = 1.0;
+
     SimulationController();
+    explicit SimulationController(const SimulationConfig& simulationConfig);
     void run();
 
+    // Por padrao os sensores usam o CURL e a hora vem do relogio da maquina.
+    // Em benchmark eu troco os dois por respostas gravadas e um relogio virtual.
+    void setHttpFetcher(HttpFetcher fetcher);
+    void setClock(std::function<std::time_t()> clock);
+
+    // Log de eventos binario (opcional). Quem cria e fecha o log e quem chama:
+    // o controller so registra um evento no fim de cada execucao.
+    void setEventLog(EventLog* eventLog);
+
+    // Medidor local (opcional), do mesmo jeito: quem cria a leitura e quem chama.
+    // O controller so drena a fila dele no comeco da execucao, junto com a hora.
+    void setIrradianceStream(IrradianceStream* stream);
+
+    // Tempo de cada etapa da ultima execucao do run() (so com stageTiming ligado).
+    const TickProfile& getLastProfile() const;
+
 private:
     double askJobFlops();
     double parseJobInput(const std::string& input);
+    void loadCarbonProfile();
+    void finishTickTiming(const std::tm& localTime,
+                          const std::string& status,
+                          std::chrono::steady_clock::time_point tickStart);
 
     // A ordem importa aqui.
     // Eu deixei config antes de model porque o EnergyModel usa o fator de CO2 da config.
     SimulationConfig config;
     EnergyModel model;
+
+    HttpFetcher fetcher;
+    std::function<std::time_t()> clock;
+    TickProfile lastProfile;
+
+    EventLog* eventLog = nullptr;
+    IrradianceStream* irradianceStream = nullptr;
+
+    // So existem com config.carbonProfilePath preenchido.
+    std::unique_ptr<CarbonIntensityProfile> carbonProfile;
+    std::unique_ptr<CarbonIntensityCursor> carbonCursor;
+
+    std::unique_ptr<TickOutput> output;
 };
\ No newline at end of file
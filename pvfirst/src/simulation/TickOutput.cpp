@@ -0,0 +1,267 @@
+#include "TickOutput.hpp"
+#include "storage/CivilTime.hpp"
+
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <iomanip>
+
+namespace
+{
+    void appendKey(std::string& out, const char* key)
+    {
+        if (out.back() != '{')
+            out += ',';
+        out += '"';
+        out += key;
+        out += "\":";
+    }
+
+    // to_chars escreve o menor texto que volta exatamente para o mesmo double
+    // (0.2 continua 0.2) e sai bem mais barato que o snprintf.
+    // NaN e infinito nao existem em JSON: saem como null.
+    void appendNumber(std::string& out, const char* key, double value)
+    {
+        appendKey(out, key);
+        if (!std::isfinite(value)) {
+            out += "null";
+            return;
+        }
+
+        char text[32];
+        std::to_chars_result result = std::to_chars(text, text + sizeof(text), value);
+        out.append(text, static_cast<size_t>(result.ptr - text));
+    }
+
+    void appendNumber(std::string& out, const char* key, int value)
+    {
+        char text[16];
+        int size = std::snprintf(text, sizeof(text), "%d", value);
+        appendKey(out, key);
+        out.append(text, static_cast<size_t>(size));
+    }
+
+    void appendText(std::string& out, const char* key, const std::string& value)
+    {
+        appendKey(out, key);
+        out += '"';
+        for (char c : value) {
+            unsigned char code = static_cast<unsigned char>(c);
+            if (c == '"' || c == '\\') {
+                out += '\\';
+                out += c;
+            }
+            else if (code < 0x20) {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", code);
+                out += escaped;
+            }
+            else {
+                out += c;
+            }
+        }
+        out += '"';
+    }
+}
+
+bool parseOutputMode(const std::string& text, OutputMode& mode)
+{
+    if (text == "texto")
+        mode = OutputMode::Text;
+    else if (text == "jsonl")
+        mode = OutputMode::JsonLines;
+    else if (text == "silencioso")
+        mode = OutputMode::Silent;
+    else
+        return false;
+    return true;
+}
+
+TextTickOutput::TextTickOutput(std::ostream& out)
+    : out(out)
+{
+}
+
+void TextTickOutput::tickStarted()
+{
+    out << "\n============================================================\n";
+    out << "SIMULACAO PV-FIRST COM JOB DO SIMGRID\n";
+    out << "============================================================\n\n";
+
+    out << "Fluxo da simulacao:\n";
+    out << "1) eu verifico local, clima e irradiancia solar\n";
+    out << "2) se houver irradiancia util, o SimGrid executa o job\n";
+    out << "3) a politica PV-First tenta atender primeiro o job com a placa\n\n";
+}
+
+void TextTickOutput::environmentReady(const TickReport& report)
+{
+    const ResultRow& row = report.row;
+
+    out << "\n-------------------- DADOS DO LOCAL --------------------\n";
+    out << "Cidade detectada : " << row.city << "\n";
+    out << "Latitude         : " << row.latitude << "\n";
+    out << "Longitude        : " << row.longitude << "\n";
+    out << "Hora local       : "
+        << std::setfill('0') << std::setw(2) << row.hour << ":"
+        << std::setfill('0') << std::setw(2) << row.minute << ":"
+        << std::setfill('0') << std::setw(2) << row.second << "\n";
+    out << "Dia do ano       : " << row.dayOfYear << "\n";
+    out << "Fonte do local   : " << sensorSourceName(report.locationSource) << "\n";
+
+    out << "\n------------------ CONDICOES DO CLIMA ------------------\n";
+    out << "Cobertura nuvens : " << row.cloudCoverPct << " %\n";
+    out << "Chuva            : " << row.rainMm << " mm\n";
+    out << "Temperatura      : " << row.temperatureC << " C\n";
+    out << "Vento            : " << row.windSpeedKmh << " km/h\n";
+    out << "Fonte do clima   : " << sensorSourceName(report.weatherSource) << "\n";
+
+    out << "\n----------------- CONFIGURACAO DO PAINEL ----------------\n";
+    out << "Material          : " << row.panelMaterial << "\n";
+    out << "Face do painel    : " << row.panelFaceType << "\n";
+    out << "Area do painel    : " << row.panelAreaM2 << " m2\n";
+    out << "Eficiencia base   : " << row.panelBaseEfficiency << "\n";
+    out << "Ganho bifacial    : " << row.panelBifacialGainFactor << "\n";
+    out << "Fator do material : " << row.panelMaterialFactor << "\n";
+
+    out << "\n----------------- MODELO FOTOVOLTAICO ------------------\n";
+    out << "Irradiancia teorica      : " << row.irradianceTheoreticalWm2 << " W/m2\n";
+    out << "Irradiancia ajustada     : " << row.irradianceAdjustedWm2 << " W/m2\n";
+    out << "Eficiencia base efetiva  : " << row.panelEffectiveBaseEfficiency << "\n";
+    out << "Eficiencia final arranjo : " << row.pvEfficiency << "\n";
+    out << "Potencia PV disponivel   : " << row.pvPowerKW << " kW\n";
+    if (report.streamSamples > 0)
+        out << "Medidor local            : media de " << report.streamSamples << " amostras\n";
+}
+
+void TextTickOutput::tickFinished(const TickReport& report)
+{
+    const ResultRow& row = report.row;
+
+    // O marcador PVFIRST_SEM_IRRADIANCIA fica para quem filtra a saida em texto.
+    // O run_solar_window.sh nao depende mais dele: o daemon com --janela-solar
+    // ja dorme fora do periodo com sol util.
+    if (report.status == "sem_irradiancia") {
+        out << "\nPVFIRST_SEM_IRRADIANCIA\n";
+        out << "Sem irradiancia util neste instante.\n";
+        out << "Nenhum job foi executado no SimGrid.\n";
+        out << "Nenhum resultado foi salvo no CSV.\n";
+        out << "\n============================================================\n";
+        out << "EXECUCAO ENCERRADA SEM REGISTRO\n";
+        out << "============================================================\n";
+        return;
+    }
+
+    out << "\n--------------------- JOB DO SIMGRID -------------------\n";
+    out << "Host usado           : " << report.hostName << "\n";
+    out << "Carga do job         : " << row.jobFlops << " FLOPs\n";
+    out << "Velocidade do host   : " << report.hostSpeedFlops << " flop/s\n";
+    out << "Duracao do job       : " << row.jobDurationS << " s\n";
+    out << "Energia do job       : " << row.jobEnergyJ << " J\n";
+    out << "Energia do job       : " << row.jobEnergyKWh << " kWh\n";
+    out << "Potencia media do job: " << row.jobAveragePowerKW << " kW\n";
+
+    out << "\n-------------------- RESULTADO PV-FIRST ----------------\n";
+    out << "Energia total do job  : " << row.energyTotalKWh << " kWh\n";
+    out << "Energia vinda da PV   : " << row.energyPvKWh << " kWh\n";
+    out << "Energia vinda da rede : " << row.energyGridKWh << " kWh\n";
+    out << "CO2 da parte da rede  : " << row.co2G << " gCO2\n";
+
+    out << "\nLeitura rapida do experimento:\n";
+    out << "- o job do SimGrid pediu " << row.jobEnergyKWh << " kWh no total\n";
+    out << "- a placa poderia entregar ate " << report.pvPossibleKWh << " kWh nesse mesmo intervalo\n";
+    out << "- a politica PV-First usou primeiro a energia solar e mandou o resto para a rede\n";
+
+    out << "\nDados salvos em: "
+        << report.resultsFile << "\n";
+
+    out << "\n============================================================\n";
+    out << "SIMULACAO FINALIZADA\n";
+    out << "============================================================\n";
+}
+
+JsonLinesTickOutput::JsonLinesTickOutput(std::ostream& out)
+    : out(out)
+{
+}
+
+void JsonLinesTickOutput::appendJson(std::string& line, const TickReport& report)
+{
+    const ResultRow& row = report.row;
+
+    std::string stamp;
+    appendDateTime(stamp, row, 'T');
+
+    // As chaves seguem os nomes das colunas do CSV de resultados.
+    line += '{';
+
+    appendText(line, "status", report.status);
+    appendText(line, "run_datetime", stamp);
+    appendNumber(line, "day_of_year", row.dayOfYear);
+    appendText(line, "city", row.city);
+    appendNumber(line, "latitude", row.latitude);
+    appendNumber(line, "longitude", row.longitude);
+    appendText(line, "location_source", sensorSourceName(report.locationSource));
+
+    appendText(line, "panel_material", row.panelMaterial);
+    appendText(line, "panel_face_type", row.panelFaceType);
+    appendNumber(line, "panel_area_m2", row.panelAreaM2);
+    appendNumber(line, "panel_base_efficiency", row.panelBaseEfficiency);
+    appendNumber(line, "panel_material_factor", row.panelMaterialFactor);
+    appendNumber(line, "panel_effective_base_efficiency", row.panelEffectiveBaseEfficiency);
+    appendNumber(line, "panel_bifacial_gain_factor", row.panelBifacialGainFactor);
+
+    appendNumber(line, "cloud_cover_pct", row.cloudCoverPct);
+    appendNumber(line, "rain_mm", row.rainMm);
+    appendNumber(line, "temperature_c", row.temperatureC);
+    appendNumber(line, "wind_speed_kmh", row.windSpeedKmh);
+    appendText(line, "weather_source", sensorSourceName(report.weatherSource));
+
+    appendNumber(line, "irradiance_theoretical_w_m2", row.irradianceTheoreticalWm2);
+    appendNumber(line, "irradiance_adjusted_w_m2", row.irradianceAdjustedWm2);
+    appendNumber(line, "pv_efficiency", row.pvEfficiency);
+    appendNumber(line, "pv_power_kw", row.pvPowerKW);
+    appendNumber(line, "stream_samples", static_cast<int>(report.streamSamples));
+
+    if (report.status != "sem_irradiancia") {
+        appendNumber(line, "grid_carbon_intensity_gco2_kwh", row.gridCarbonIntensity);
+        appendText(line, "host", report.hostName);
+        appendNumber(line, "host_speed_flops", report.hostSpeedFlops);
+        appendNumber(line, "job_flops", row.jobFlops);
+        appendNumber(line, "job_duration_s", row.jobDurationS);
+        appendNumber(line, "job_energy_j", row.jobEnergyJ);
+        appendNumber(line, "job_energy_kwh", row.jobEnergyKWh);
+        appendNumber(line, "job_average_power_kw", row.jobAveragePowerKW);
+        appendNumber(line, "energy_total_kwh", row.energyTotalKWh);
+        appendNumber(line, "energy_pv_kwh", row.energyPvKWh);
+        appendNumber(line, "energy_grid_kwh", row.energyGridKWh);
+        appendNumber(line, "co2_g", row.co2G);
+        appendNumber(line, "pv_possible_kwh", report.pvPossibleKWh);
+        appendText(line, "results_file", report.resultsFile);
+    }
+
+    line += '}';
+}
+
+void JsonLinesTickOutput::tickFinished(const TickReport& report)
+{
+    line.clear();
+    appendJson(line, report);
+    line += '\n';
+
+    out.write(line.data(), static_cast<std::streamsize>(line.size()));
+    out.flush();
+}
+
+std::unique_ptr<TickOutput> makeTickOutput(OutputMode mode, std::ostream& out)
+{
+    switch (mode) {
+    case OutputMode::JsonLines:
+        return std::make_unique<JsonLinesTickOutput>(out);
+    case OutputMode::Silent:
+        return std::make_unique<SilentTickOutput>();
+    case OutputMode::Text:
+        break;
+    }
+    return std::make_unique<TextTickOutput>(out);
+}
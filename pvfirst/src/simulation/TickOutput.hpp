@@ -0,0 +1,103 @@
+#pragma once
+
+#include "sensors/SensorState.hpp"
+#include "storage/ResultRow.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <string>
+
+// Tudo o que uma execucao do controller produziu, num lugar so.
+// As saidas (texto, JSON lines, silenciosa) leem daqui e de mais nenhum lugar.
+struct TickReport
+{
+    // "ok" quando o job rodou, "sem_irradiancia" quando a execucao parou no filtro.
+    // Mesmos nomes do CSV de tempos e do log de eventos.
+    std::string status = "ok";
+
+    // Hora, local, clima, painel, job e energia, do mesmo jeito que vai para o CSV.
+    // Sem irradiancia, so hora, local, clima e painel ficam preenchidos.
+    ResultRow row;
+
+    // De onde vieram local e clima nesta execucao (API ou uma das reservas).
+    SensorSource locationSource = SensorSource::None;
+    SensorSource weatherSource = SensorSource::None;
+
+    // Amostras do medidor local por tras da irradiancia (ou da potencia) desta execucao.
+    // Zero quando elas vieram do modelo.
+    std::size_t streamSamples = 0;
+
+    std::string hostName;
+    double hostSpeedFlops = 0.0;
+
+    // Quanto a placa poderia entregar durante o job.
+    double pvPossibleKWh = 0.0;
+
+    std::string resultsFile;
+};
+
+enum class OutputMode
+{
+    Text,
+    JsonLines,
+    Silent
+};
+
+// "texto", "jsonl" ou "silencioso".
+bool parseOutputMode(const std::string& text, OutputMode& mode);
+
+// Saida de uma execucao.
+// O controller chama as tres etapas na ordem; cada saida decide o que mostrar.
+class TickOutput
+{
+public:
+    virtual ~TickOutput() = default;
+
+    // Antes dos sensores.
+    virtual void tickStarted() {}
+
+    // Local, clima e painel ja calculados, antes do filtro de irradiancia
+    // (e antes de perguntar os FLOPs do job no modo interativo).
+    virtual void environmentReady(const TickReport&) {}
+
+    // Fim da execucao, com ou sem job.
+    virtual void tickFinished(const TickReport&) {}
+};
+
+// O texto de sempre, com os blocos de local, clima, painel, job e resultado.
+class TextTickOutput : public TickOutput
+{
+public:
+    explicit TextTickOutput(std::ostream& out);
+
+    void tickStarted() override;
+    void environmentReady(const TickReport& report) override;
+    void tickFinished(const TickReport& report) override;
+
+private:
+    std::ostream& out;
+};
+
+// Uma linha JSON por execucao, escrita de uma vez no fim.
+class JsonLinesTickOutput : public TickOutput
+{
+public:
+    explicit JsonLinesTickOutput(std::ostream& out);
+
+    void tickFinished(const TickReport& report) override;
+
+    // A linha sem o '\n' do fim.
+    static void appendJson(std::string& line, const TickReport& report);
+
+private:
+    std::ostream& out;
+    std::string line;
+};
+
+// Nao escreve nada: o CSV (e o log de eventos, se ligado) continuam sendo gravados.
+class SilentTickOutput : public TickOutput
+{
+};
+
+std::unique_ptr<TickOutput> makeTickOutput(OutputMode mode, std::ostream& out);
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// Aqui eu separo o tempo de uma execucao do controller pelas etapas dela.
+// Cada etapa bate com um dos blocos marcados no SimulationController::run.
+enum class TickStage
+{
+    Location,
+    Weather,
+    Solar,
+    SimGrid,
+    Triage,
+    Csv,
+    Console,
+    Count
+};
+
+constexpr std::size_t tickStageCount = static_cast<std::size_t>(TickStage::Count);
+
+inline const char* tickStageName(TickStage stage)
+{
+    switch (stage) {
+    case TickStage::Location:
+        return "localizacao";
+    case TickStage::Weather:
+        return "clima";
+    case TickStage::Solar:
+        return "modelo_solar";
+    case TickStage::SimGrid:
+        return "simgrid";
+    case TickStage::Triage:
+        return "triagem_pvfirst";
+    case TickStage::Csv:
+        return "csv";
+    case TickStage::Console:
+        return "console";
+    case TickStage::Count:
+        break;
+    }
+    return "?";
+}
+
+// Tempos de uma execucao, em nanossegundos.
+// Uma etapa pode aparecer mais de uma vez (o console, por exemplo): os tempos somam.
+struct TickProfile
+{
+    std::array<std::int64_t, tickStageCount> stageNs{};
+    std::int64_t totalNs = 0;
+};
+
+// Mede o tempo de um bloco pelo relogio monotonico e soma na etapa ao sair do escopo.
+// Com profile nulo (medicao desligada) o span nao le relogio nenhum:
+// sobra so um teste de ponteiro na entrada e outro na saida do bloco.
+class StageSpan
+{
+public:
+    StageSpan(TickProfile* profile, TickStage stage)
+        : profile(profile),
+          stage(stage)
+    {
+        if (profile != nullptr)
+            start = std::chrono::steady_clock::now();
+    }
+
+    ~StageSpan()
+    {
+        if (profile == nullptr)
+            return;
+
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        profile->stageNs[static_cast<std::size_t>(stage)] +=
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    }
+
+    StageSpan(const StageSpan&) = delete;
+    StageSpan& operator=(const StageSpan&) = delete;
+
+private:
+    TickProfile* profile;
+    TickStage stage;
+    std::chrono::steady_clock::time_point start;
+};
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "ResultRow.hpp"
+
+#include <charconv>
+#include <cstdint>
+#include <ctime>
+#include <string>
+
+// Conversao entre data do calendario e segundos corridos, sem fuso nenhum.
+// E so uma forma compacta de guardar e comparar ano, mes, dia, hora, minuto
+// e segundo de uma linha de resultado (a hora continua sendo a hora local da linha).
+
+// Dias desde 1970-01-01 no calendario civil (algoritmo de Howard Hinnant).
+inline std::int64_t daysFromCivil(std::int64_t year, unsigned month, unsigned day)
+{
+    year -= month <= 2;
+    std::int64_t era = (year >= 0 ? year : year - 399) / 400;
+    unsigned yearOfEra = static_cast<unsigned>(year - era * 400);
+    unsigned dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    unsigned dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + static_cast<std::int64_t>(dayOfEra) - 719468;
+}
+
+inline void civilFromDays(std::int64_t days, int& year, int& month, int& day)
+{
+    days += 719468;
+    std::int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    unsigned dayOfEra = static_cast<unsigned>(days - era * 146097);
+    unsigned yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    unsigned dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    unsigned monthIndex = (5 * dayOfYear + 2) / 153;
+
+    day = static_cast<int>(dayOfYear - (153 * monthIndex + 2) / 5 + 1);
+    month = static_cast<int>(monthIndex < 10 ? monthIndex + 3 : monthIndex - 9);
+    year = static_cast<int>(static_cast<std::int64_t>(yearOfEra) + era * 400 + (month <= 2));
+}
+
+// Divisao que arredonda para baixo tambem com numero negativo.
+inline std::int64_t floorDiv(std::int64_t value, std::int64_t divisor)
+{
+    return value >= 0 ? value / divisor : (value - divisor + 1) / divisor;
+}
+
+inline std::int64_t rowSeconds(const ResultRow& row)
+{
+    return daysFromCivil(row.year, static_cast<unsigned>(row.month), static_cast<unsigned>(row.day)) * 86400 +
+           row.hour * 3600 + row.minute * 60 + row.second;
+}
+
+inline void setRowTime(ResultRow& row, std::int64_t seconds)
+{
+    std::int64_t days = floorDiv(seconds, 86400);
+    std::int64_t secondOfDay = seconds - days * 86400;
+
+    civilFromDays(days, row.year, row.month, row.day);
+    row.hour = static_cast<int>(secondOfDay / 3600);
+    row.minute = static_cast<int>((secondOfDay / 60) % 60);
+    row.second = static_cast<int>(secondOfDay % 60);
+}
+
+// Inteiro em texto no fim de out. Com width 2, de 0 a 9 ganha o zero na frente,
+// como o %02d; fora disso sai o numero inteiro, sem cortar nada.
+inline void appendCivilField(std::string& out, int value, int width)
+{
+    if (width == 2 && value >= 0 && value < 10)
+        out += '0';
+
+    char text[16];
+    std::to_chars_result result = std::to_chars(text, text + sizeof(text), value);
+    out.append(text, static_cast<std::size_t>(result.ptr - text));
+}
+
+// "AAAA-MM-DD" no fim de out.
+inline void appendDate(std::string& out, int year, int month, int day)
+{
+    appendCivilField(out, year, 0);
+    out += '-';
+    appendCivilField(out, month, 2);
+    out += '-';
+    appendCivilField(out, day, 2);
+}
+
+// "AAAA-MM-DD HH:MM:SS" no fim de out: o formato de data e hora de todos os CSV,
+// logs e relatorios. separator troca o espaco (o JSON usa 'T').
+inline void appendDateTime(std::string& out, int year, int month, int day,
+                           int hour, int minute, int second, char separator = ' ')
+{
+    appendDate(out, year, month, day);
+    out += separator;
+    appendCivilField(out, hour, 2);
+    out += ':';
+    appendCivilField(out, minute, 2);
+    out += ':';
+    appendCivilField(out, second, 2);
+}
+
+inline void appendDateTime(std::string& out, const ResultRow& row, char separator = ' ')
+{
+    appendDateTime(out, row.year, row.month, row.day, row.hour, row.minute, row.second, separator);
+}
+
+inline void appendDateTime(std::string& out, const std::tm& time)
+{
+    appendDateTime(out, time.tm_year + 1900, time.tm_mon + 1, time.tm_mday,
+                   time.tm_hour, time.tm_min, time.tm_sec);
+}
+
+inline std::string formatDateTime(const std::tm& time)
+{
+    std::string text;
+    appendDateTime(text, time);
+    return text;
+}
@@ -0,0 +1,171 @@
+#include "CsvScanner.hpp"
+
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    const std::size_t blockSize = 64;
+
+    // Bit i ligado quando p[i] e o separador, '"' ou '\n'. p precisa ter 64 bytes legiveis.
+    std::uint64_t markBlock(const char* p, char separator)
+    {
+#if defined(__AVX2__)
+        const __m256i separators = _mm256_set1_epi8(separator);
+        const __m256i quote = _mm256_set1_epi8('"');
+        const __m256i newline = _mm256_set1_epi8('\n');
+
+        std::uint64_t marks = 0;
+        for (int half = 0; half < 2; half++) {
+            __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32 * half));
+            __m256i hits = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(bytes, separators),
+                                                           _mm256_cmpeq_epi8(bytes, quote)),
+                                           _mm256_cmpeq_epi8(bytes, newline));
+            marks |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(hits))) << (32 * half);
+        }
+        return marks;
+#elif defined(__SSE2__)
+        const __m128i separators = _mm_set1_epi8(separator);
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i newline = _mm_set1_epi8('\n');
+
+        std::uint64_t marks = 0;
+        for (int quarter = 0; quarter < 4; quarter++) {
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * quarter));
+            __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(bytes, separators),
+                                                     _mm_cmpeq_epi8(bytes, quote)),
+                                        _mm_cmpeq_epi8(bytes, newline));
+            marks |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm_movemask_epi8(hits))) << (16 * quarter);
+        }
+        return marks;
+#else
+        std::uint64_t marks = 0;
+        for (std::size_t i = 0; i < blockSize; i++) {
+            char c = p[i];
+            if (c == separator || c == '"' || c == '\n')
+                marks |= std::uint64_t(1) << i;
+        }
+        return marks;
+#endif
+    }
+
+    std::string_view makeField(const char* first, const char* last)
+    {
+        std::string_view field(first, static_cast<std::size_t>(last - first));
+
+        if (!field.empty() && field.front() == '"') {
+            field.remove_prefix(1);
+            if (!field.empty() && field.back() == '"')
+                field.remove_suffix(1);
+        }
+        return field;
+    }
+}
+
+CsvScanner::CsvScanner(std::string_view text, char separator)
+    : text(text),
+      separator(separator)
+{
+    if (!text.empty())
+        loadBlock();
+}
+
+void CsvScanner::loadBlock()
+{
+    std::size_t remaining = text.size() - block;
+
+    if (remaining >= blockSize) {
+        marks = markBlock(text.data() + block, separator);
+        return;
+    }
+
+    // Ultimo pedaco: eu copio para um bloco zerado, para nao ler alem do fim do texto.
+    char tail[blockSize] = {};
+    std::memcpy(tail, text.data() + block, remaining);
+    marks = markBlock(tail, separator) & ((std::uint64_t(1) << remaining) - 1);
+}
+
+bool CsvScanner::nextLine(std::string_view* fields, std::size_t maxFields, std::size_t& fieldCount)
+{
+    if (cursor >= text.size())
+        return false;
+
+    const char* data = text.data();
+    std::size_t fieldStart = cursor;
+    bool quoted = false;
+    fieldCount = 0;
+
+    for (;;) {
+        while (marks == 0) {
+            block += blockSize;
+
+            // Texto terminou sem '\n': a ultima linha vai ate o fim.
+            if (block >= text.size()) {
+                std::size_t lineEnd = text.size();
+                if (lineEnd > fieldStart && data[lineEnd - 1] == '\r')
+                    lineEnd--;
+                if (fieldCount < maxFields)
+                    fields[fieldCount] = makeField(data + fieldStart, data + lineEnd);
+                fieldCount++;
+                cursor = text.size();
+                return true;
+            }
+
+            loadBlock();
+        }
+
+        std::size_t mark = block + static_cast<std::size_t>(__builtin_ctzll(marks));
+        marks &= marks - 1;
+
+        char c = data[mark];
+
+        if (c == '"') {
+            quoted = !quoted;
+            continue;
+        }
+
+        if (quoted)
+            continue;
+
+        if (c == separator) {
+            if (fieldCount < maxFields)
+                fields[fieldCount] = makeField(data + fieldStart, data + mark);
+            fieldCount++;
+            fieldStart = mark + 1;
+            continue;
+        }
+
+        // '\n'
+        std::size_t lineEnd = mark;
+        if (lineEnd > fieldStart && data[lineEnd - 1] == '\r')
+            lineEnd--;
+        if (fieldCount < maxFields)
+            fields[fieldCount] = makeField(data + fieldStart, data + lineEnd);
+        fieldCount++;
+        cursor = mark + 1;
+        return true;
+    }
+}
+
+std::size_t CsvScanner::countLines(std::string_view text)
+{
+    // O memchr da libc ja usa SIMD; so os '\n' interessam aqui.
+    std::size_t lines = 0;
+    const char* position = text.data();
+    const char* last = text.data() + text.size();
+
+    while (position < last) {
+        const void* found = std::memchr(position, '\n', static_cast<std::size_t>(last - position));
+        if (found == nullptr)
+            break;
+        lines++;
+        position = static_cast<const char*>(found) + 1;
+    }
+
+    return lines;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Separador de linhas e campos de CSV (ponto e virgula por padrao), sem copiar nada:
+// cada campo sai como string_view apontando para o texto original.
+//
+// Em vez de olhar byte a byte, eu marco de 64 em 64 bytes onde estao o separador,
+// '"' e '\n' (com SSE2 ou AVX2 quando o compilador deixa) e depois so pulo de marca
+// em marca. Os bytes do meio de um numero nem chegam a ser olhados aqui.
+//
+// Aspas: separador e '\n' dentro de aspas fazem parte do campo, e as aspas em volta
+// do campo sao removidas. Aspas dobradas ("") nao sao tratadas porque o writer
+// nunca gera.
+class CsvScanner
+{
+public:
+    explicit CsvScanner(std::string_view text, char separator = ';');
+
+    // Separa a proxima linha. Ate maxFields campos vao para fields;
+    // fieldCount recebe quantos campos a linha tinha de verdade (pode ser mais).
+    // Devolve false quando o texto acabou. O '\r' do fim da linha e removido.
+    bool nextLine(std::string_view* fields, std::size_t maxFields, std::size_t& fieldCount);
+
+    // Quantos '\n' o texto tem, para reservar as colunas antes de ler.
+    static std::size_t countLines(std::string_view text);
+
+private:
+    void loadBlock();
+
+    std::string_view text;
+    char separator;
+
+    // Bloco de 64 bytes em analise (posicao no texto) e as marcas que ainda faltam nele.
+    std::size_t block = 0;
+    std::uint64_t marks = 0;
+
+    // Comeco da proxima linha.
+    std::size_t cursor = 0;
+};
@@ -0,0 +1,280 @@
+#include "EventLog.hpp"
+#include "CivilTime.hpp"
+#include "sensors/SensorState.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <stdexcept>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    const char logMagic[8] = {'P', 'V', 'F', 'E', 'V', 'L', 'O', 'G'};
+    const std::uint32_t logVersion = 1;
+
+    // Cabecalho no comeco do arquivo, ocupando 64 bytes.
+    struct EventLogHeader
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t recordSize;
+        std::uint64_t capacity;
+        std::uint64_t nextSequence;
+        unsigned char reserved[32];
+    };
+
+    static_assert(sizeof(EventLogHeader) == 64, "O cabecalho do log precisa ter 64 bytes");
+    static_assert(std::is_trivially_copyable<EventRecord>::value, "EventRecord vai direto para o arquivo");
+
+    std::string systemError(const std::string& message, const std::string& path)
+    {
+        return message + path + " (" + std::strerror(errno) + ")";
+    }
+
+    void checkHeader(const EventLogHeader& header, std::size_t fileSize, const std::string& path)
+    {
+        if (std::memcmp(header.magic, logMagic, sizeof(logMagic)) != 0 || header.version != logVersion)
+            throw std::runtime_error("O arquivo nao e um log de eventos do PV-First: " + path);
+
+        if (header.recordSize != sizeof(EventRecord))
+            throw std::runtime_error("O log de eventos foi gravado com outro formato de registro: " + path);
+
+        if (header.capacity == 0 ||
+            fileSize < sizeof(EventLogHeader) + header.capacity * sizeof(EventRecord))
+            throw std::runtime_error("O log de eventos esta truncado: " + path);
+    }
+}
+
+const char* eventTypeName(EventType type)
+{
+    switch (type) {
+    case EventType::TickOk:
+        return "ok";
+    case EventType::NoIrradiance:
+        return "sem_irradiancia";
+    case EventType::TickFailed:
+        return "falha";
+    }
+    return "?";
+}
+
+bool parseEventType(const std::string& text, EventType& type)
+{
+    for (EventType candidate : {EventType::TickOk, EventType::NoIrradiance, EventType::TickFailed}) {
+        if (text == eventTypeName(candidate)) {
+            type = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+EventLog::EventLog(const std::string& path, std::uint64_t capacity)
+{
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0)
+        throw std::runtime_error(systemError("Nao consegui abrir o log de eventos em: ", path));
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw std::runtime_error(systemError("Nao consegui ler o tamanho do log de eventos em: ", path));
+    }
+
+    bool freshFile = info.st_size == 0;
+
+    if (freshFile) {
+        // Arquivo novo: eu reservo o tamanho inteiro de uma vez.
+        // Depois disso o arquivo nunca mais cresce.
+        mappingSize = sizeof(EventLogHeader) + capacity * sizeof(EventRecord);
+        if (::ftruncate(fd, static_cast<off_t>(mappingSize)) != 0) {
+            ::close(fd);
+            throw std::runtime_error(systemError("Nao consegui reservar o log de eventos em: ", path));
+        }
+    }
+    else {
+        mappingSize = static_cast<std::size_t>(info.st_size);
+    }
+
+    void* address = ::mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (address == MAP_FAILED) {
+        ::close(fd);
+        throw std::runtime_error(systemError("Nao consegui mapear o log de eventos em: ", path));
+    }
+    mapping = static_cast<unsigned char*>(address);
+
+    EventLogHeader* header = reinterpret_cast<EventLogHeader*>(mapping);
+
+    if (freshFile) {
+        std::memset(header, 0, sizeof(EventLogHeader));
+        std::memcpy(header->magic, logMagic, sizeof(logMagic));
+        header->version = logVersion;
+        header->recordSize = sizeof(EventRecord);
+        header->capacity = capacity;
+        header->nextSequence = 0;
+        return;
+    }
+
+    try {
+        checkHeader(*header, mappingSize, path);
+    }
+    catch (...) {
+        ::munmap(mapping, mappingSize);
+        ::close(fd);
+        throw;
+    }
+}
+
+EventLog::~EventLog()
+{
+    if (mapping != nullptr) {
+        // O kernel grava as paginas sozinho; aqui eu so peco para nao esperar.
+        ::msync(mapping, mappingSize, MS_ASYNC);
+        ::munmap(mapping, mappingSize);
+    }
+
+    if (fd >= 0)
+        ::close(fd);
+}
+
+void EventLog::append(EventRecord record)
+{
+    EventLogHeader* header = reinterpret_cast<EventLogHeader*>(mapping);
+
+    std::uint64_t sequence = header->nextSequence;
+    std::uint64_t slot = sequence % header->capacity;
+
+    record.sequence = sequence;
+
+    unsigned char* destination = mapping + sizeof(EventLogHeader) + slot * sizeof(EventRecord);
+    std::memcpy(destination, &record, sizeof(EventRecord));
+
+    // O registro precisa estar inteiro antes de o contador anunciar ele para quem le.
+    std::atomic_thread_fence(std::memory_order_release);
+    header->nextSequence = sequence + 1;
+}
+
+EventLogReader::EventLogReader(const std::string& path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error(systemError("Nao consegui abrir o log de eventos em: ", path));
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < sizeof(EventLogHeader)) {
+        ::close(fd);
+        throw std::runtime_error("O arquivo nao e um log de eventos do PV-First: " + path);
+    }
+
+    mappingSize = static_cast<std::size_t>(info.st_size);
+
+    void* address = ::mmap(nullptr, mappingSize, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+
+    if (address == MAP_FAILED)
+        throw std::runtime_error(systemError("Nao consegui mapear o log de eventos em: ", path));
+
+    mapping = static_cast<const unsigned char*>(address);
+
+    try {
+        checkHeader(*reinterpret_cast<const EventLogHeader*>(mapping), mappingSize, path);
+    }
+    catch (...) {
+        ::munmap(const_cast<unsigned char*>(mapping), mappingSize);
+        throw;
+    }
+}
+
+EventLogReader::~EventLogReader()
+{
+    if (mapping != nullptr)
+        ::munmap(const_cast<unsigned char*>(mapping), mappingSize);
+}
+
+std::uint64_t EventLogReader::capacity() const
+{
+    return reinterpret_cast<const EventLogHeader*>(mapping)->capacity;
+}
+
+std::uint64_t EventLogReader::written() const
+{
+    std::uint64_t next = reinterpret_cast<const EventLogHeader*>(mapping)->nextSequence;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return next;
+}
+
+void EventLogReader::forEach(const std::function<void(const EventRecord&)>& callback) const
+{
+    std::uint64_t next = written();
+    std::uint64_t slots = capacity();
+    std::uint64_t first = next > slots ? next - slots : 0;
+
+    EventRecord record;
+    for (std::uint64_t sequence = first; sequence < next; sequence++) {
+        const unsigned char* source =
+            mapping + sizeof(EventLogHeader) + (sequence % slots) * sizeof(EventRecord);
+        std::memcpy(&record, source, sizeof(EventRecord));
+
+        // Se o escritor deu a volta enquanto eu lia, esse registro ja e de outra sequencia.
+        if (record.sequence != sequence)
+            continue;
+
+        callback(record);
+    }
+}
+
+std::string EventLogReader::format(const EventRecord& record)
+{
+    std::time_t timestamp = static_cast<std::time_t>(record.timestamp);
+    std::tm localTime = *std::localtime(&timestamp);
+
+    std::string stamp = formatDateTime(localTime);
+
+    EventType type = static_cast<EventType>(record.type);
+
+    char line[512];
+
+    if (type == EventType::TickFailed) {
+        std::snprintf(line, sizeof(line), "#%llu %s %s",
+                      static_cast<unsigned long long>(record.sequence), stamp.c_str(), eventTypeName(type));
+        return line;
+    }
+
+    int size = std::snprintf(line, sizeof(line),
+                             "#%llu %s %s irr=%g/%g W/m2 pv=%g kW nuvens=%g%% chuva=%g mm temp=%g C vento=%g km/h",
+                             static_cast<unsigned long long>(record.sequence), stamp.c_str(), eventTypeName(type),
+                             record.irradianceAdjustedWm2, record.irradianceTheoreticalWm2, record.pvPowerKW,
+                             record.cloudCoverPct, record.rainMm, record.temperatureC, record.windSpeedKmh);
+
+    if (type == EventType::TickOk && size > 0 && static_cast<std::size_t>(size) < sizeof(line)) {
+        size += std::snprintf(line + size, sizeof(line) - static_cast<std::size_t>(size),
+                              " job=%g s %g kWh (pv %g, rede %g) co2=%g g",
+                              record.jobDurationS, record.jobEnergyKWh,
+                              record.energyPvKWh, record.energyGridKWh, record.co2G);
+    }
+
+    // Registros antigos nao tem a fonte; so aparece quando alguma nao veio da API.
+    bool fromApi = record.locationSource == static_cast<std::uint8_t>(SensorSource::Api) &&
+                   record.weatherSource == static_cast<std::uint8_t>(SensorSource::Api);
+    if (record.locationSource != 0 && !fromApi && size > 0 && static_cast<std::size_t>(size) < sizeof(line)) {
+        size += std::snprintf(line + size, sizeof(line) - static_cast<std::size_t>(size),
+                              " fonte=%s/%s",
+                              sensorSourceName(static_cast<SensorSource>(record.locationSource)),
+                              sensorSourceName(static_cast<SensorSource>(record.weatherSource)));
+    }
+
+    if (record.tickNs > 0 && size > 0 && static_cast<std::size_t>(size) < sizeof(line)) {
+        std::snprintf(line + size, sizeof(line) - static_cast<std::size_t>(size),
+                      " tempo=%.1f us", static_cast<double>(record.tickNs) / 1000.0);
+    }
+
+    return line;
+}
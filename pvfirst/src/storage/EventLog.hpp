@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+// Aqui fica o log de eventos binario do experimento.
+//
+// O arquivo tem tamanho fixo: um cabecalho e uma fila circular de registros
+// do mesmo tamanho. Quando a fila enche, o registro mais velho e sobrescrito.
+// O arquivo fica mapeado em memoria, entao registrar uma execucao e so copiar
+// um struct para o lugar certo, sem formatar texto nenhum.
+//
+// Quem decodifica e filtra e o comando "pvfirst log".
+
+enum class EventType : std::uint16_t
+{
+    TickOk         = 1,
+    NoIrradiance   = 2,
+    TickFailed     = 3
+};
+
+// Mesmos nomes do status no CSV de tempos.
+const char* eventTypeName(EventType type);
+bool parseEventType(const std::string& text, EventType& type);
+
+// Um registro por execucao. Tudo em tipos fixos, sem ponteiro nem string,
+// para poder ir direto do struct para o arquivo e voltar.
+struct EventRecord
+{
+    std::uint64_t sequence = 0;
+    std::int64_t  timestamp = 0; // segundos desde 1970 (time_t)
+    std::uint16_t type = 0;
+
+    // De onde vieram local e clima (SensorSource). 0 nos registros antigos.
+    std::uint8_t locationSource = 0;
+    std::uint8_t weatherSource = 0;
+
+    std::uint32_t reserved32 = 0;
+
+    double latitude = 0.0;
+    double longitude = 0.0;
+
+    double irradianceTheoreticalWm2 = 0.0;
+    double irradianceAdjustedWm2 = 0.0;
+    double pvPowerKW = 0.0;
+
+    double cloudCoverPct = 0.0;
+    double rainMm = 0.0;
+    double temperatureC = 0.0;
+    double windSpeedKmh = 0.0;
+
+    double jobDurationS = 0.0;
+    double jobEnergyKWh = 0.0;
+    double energyPvKWh = 0.0;
+    double energyGridKWh = 0.0;
+    double co2G = 0.0;
+
+    // Tempo total da execucao, medido sempre (com ou sem --timing).
+    std::int64_t tickNs = 0;
+};
+
+// Escreve no log. Um processo escritor por arquivo.
+class EventLog
+{
+public:
+    // 65536 registros de 144 bytes: pouco mais de 9 MB, uns 45 dias a um registro por minuto.
+    static constexpr std::uint64_t defaultCapacity = 65536;
+
+    // Cria o arquivo se ele nao existir. Se ja existir, continua de onde parou
+    // e usa a capacidade gravada no cabecalho.
+    explicit EventLog(const std::string& path, std::uint64_t capacity = defaultCapacity);
+    ~EventLog();
+
+    EventLog(const EventLog&) = delete;
+    EventLog& operator=(const EventLog&) = delete;
+
+    // Copia o registro para a proxima posicao da fila e preenche record.sequence.
+    void append(EventRecord record);
+
+private:
+    unsigned char* mapping = nullptr;
+    std::size_t mappingSize = 0;
+    int fd = -1;
+};
+
+// Le o log em ordem, do registro mais velho que ainda esta no arquivo ao mais novo.
+class EventLogReader
+{
+public:
+    explicit EventLogReader(const std::string& path);
+    ~EventLogReader();
+
+    EventLogReader(const EventLogReader&) = delete;
+    EventLogReader& operator=(const EventLogReader&) = delete;
+
+    std::uint64_t capacity() const;
+
+    // Quantos registros ja foram escritos desde que o arquivo foi criado.
+    std::uint64_t written() const;
+
+    void forEach(const std::function<void(const EventRecord&)>& callback) const;
+
+    // Uma linha de texto legivel para o registro.
+    static std::string format(const EventRecord& record);
+
+private:
+    const unsigned char* mapping = nullptr;
+    std::size_t mappingSize = 0;
+};
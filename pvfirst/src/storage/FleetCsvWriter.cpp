@@ -0,0 +1,107 @@
+#include "FleetCsvWriter.hpp"
+#include "CivilTime.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+namespace
+{
+    const char sep = ';';
+
+    // Mesmo %g do CSV de resultados.
+    void appendNumber(std::string& out, double value)
+    {
+        char text[32];
+        int size = std::snprintf(text, sizeof(text), "%g", value);
+        out += sep;
+        out.append(text, static_cast<size_t>(size));
+    }
+
+    void appendText(std::string& out, const std::string& value)
+    {
+        out += sep;
+        for (char c : value)
+            out += (c == sep || c == '\n' || c == '\r') ? ' ' : c;
+    }
+}
+
+FleetCsvWriter::FleetCsvWriter(const std::string& resultsDir)
+    : resultsDir(resultsDir)
+{
+}
+
+const std::string& FleetCsvWriter::header()
+{
+    static const std::string text =
+        "run_datetime_utc;site;latitude;longitude;solar_hour;weather_source;"
+        "cloud_cover_pct;rain_mm;temperature_c;wind_speed_kmh;"
+        "panel_material;panel_face_type;panel_area_m2;panel_base_efficiency;"
+        "irradiance_theoretical_w_m2;irradiance_adjusted_w_m2;pv_efficiency;pv_power_kw\n";
+    return text;
+}
+
+std::string FleetCsvWriter::dailyFileName(std::int64_t utcSeconds)
+{
+    ResultRow time;
+    setRowTime(time, utcSeconds);
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "FPVfirst%02d%02d%02d.csv", time.day, time.month, time.year % 100);
+    return name;
+}
+
+std::filesystem::path FleetCsvWriter::append(std::int64_t utcSeconds,
+                                             const std::vector<FleetSite>& sites,
+                                             const std::vector<FleetSiteResult>& results)
+{
+    std::filesystem::create_directories(resultsDir);
+
+    std::filesystem::path filePath = std::filesystem::path(resultsDir) / dailyFileName(utcSeconds);
+    bool fileExists = std::filesystem::exists(filePath);
+
+    std::ofstream file(filePath, std::ios::app);
+    if (!file.is_open())
+        throw std::runtime_error("Nao consegui abrir ou criar o arquivo da frota em: " + filePath.string());
+
+    ResultRow time;
+    setRowTime(time, utcSeconds);
+
+    std::string stamp;
+    appendDateTime(stamp, time);
+
+    buffer.clear();
+    if (!fileExists)
+        buffer += header();
+
+    for (std::size_t i = 0; i < sites.size() && i < results.size(); i++) {
+        const FleetSite& site = sites[i];
+        const FleetSiteResult& result = results[i];
+
+        buffer += stamp;
+        appendText(buffer, site.name);
+        appendNumber(buffer, site.latitude);
+        appendNumber(buffer, site.longitude);
+        appendNumber(buffer, result.solarHour);
+        appendText(buffer, sensorSourceName(result.weatherSource));
+
+        appendNumber(buffer, result.impact.cloudCover);
+        appendNumber(buffer, result.impact.rainAmount);
+        appendNumber(buffer, result.impact.temperature);
+        appendNumber(buffer, result.impact.windSpeed);
+
+        appendText(buffer, site.pv.panelMaterial);
+        appendText(buffer, site.pv.panelFaceType);
+        appendNumber(buffer, site.pv.panelAreaM2);
+        appendNumber(buffer, site.pv.baseEfficiency);
+
+        appendNumber(buffer, result.irradianceTheoreticalWm2);
+        appendNumber(buffer, result.irradianceAdjustedWm2);
+        appendNumber(buffer, result.pvEfficiency);
+        appendNumber(buffer, result.pvPowerKW);
+        buffer += '\n';
+    }
+
+    file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    return filePath;
+}
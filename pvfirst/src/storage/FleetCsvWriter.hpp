@@ -0,0 +1,32 @@
+#pragma once
+
+#include "fleet/Fleet.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// CSV da frota: uma linha por sitio a cada passada, em results/FPVfirstDDMMAA.csv.
+// Como os sitios podem estar em fusos diferentes, a data do arquivo e a hora
+// da linha sao em UTC; a hora solar de cada sitio vai numa coluna propria.
+class FleetCsvWriter
+{
+public:
+    explicit FleetCsvWriter(const std::string& resultsDir = "results");
+
+    // Acrescenta a passada inteira de uma vez so. Devolve o caminho usado.
+    std::filesystem::path append(std::int64_t utcSeconds,
+                                 const std::vector<FleetSite>& sites,
+                                 const std::vector<FleetSiteResult>& results);
+
+    // Exemplo: FPVfirst170626.csv
+    static std::string dailyFileName(std::int64_t utcSeconds);
+
+    // Linha de cabecalho, ja com o '\n'.
+    static const std::string& header();
+
+private:
+    std::string resultsDir;
+    std::string buffer;
+};
@@ -0,0 +1,51 @@
+#include "MappedFile.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string& path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("Nao consegui abrir o arquivo em: " + path + " (" + std::strerror(errno) + ")");
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Nao consegui ler o tamanho do arquivo em: " + path);
+    }
+
+    size = static_cast<std::size_t>(info.st_size);
+
+    if (size > 0) {
+        void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("Nao consegui mapear o arquivo em: " + path + " (" + std::strerror(errno) + ")");
+        }
+
+        // A leitura e sempre do comeco ao fim: o kernel pode ler bem adiantado.
+        ::madvise(mapped, size, MADV_SEQUENTIAL);
+        data = static_cast<const char*>(mapped);
+    }
+
+    // O mapeamento continua valido depois de fechar o descritor.
+    ::close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+    if (data != nullptr)
+        ::munmap(const_cast<char*>(data), size);
+}
+
+std::string_view MappedFile::text() const
+{
+    return std::string_view(data, size);
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Arquivo inteiro mapeado na memoria, so para leitura.
+// O kernel traz as paginas conforme a leitura avanca: nao tem copia para um
+// buffer meu nem alocacao do tamanho do arquivo.
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Arquivo vazio devolve um texto vazio.
+    std::string_view text() const;
+
+private:
+    const char* data = nullptr;
+    std::size_t size = 0;
+};
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <string>
+
+// Uma linha do CSV de resultados (results/RPVfirstDDMMAA.csv).
+// Os campos seguem a mesma ordem das colunas do arquivo.
+// run_id, run_date, run_time e run_datetime nao ficam guardados:
+// eles sempre saem de year/month/day/hour/minute/second na hora de escrever.
+struct ResultRow
+{
+    int year   = 1970;
+    int month  = 1;
+    int day    = 1;
+    int hour   = 0;
+    int minute = 0;
+    int second = 0;
+
+    int dayOfYear = 1;
+
+    std::string city;
+    double latitude  = 0.0;
+    double longitude = 0.0;
+
+    std::string panelMaterial;
+    std::string panelFaceType;
+    double panelAreaM2                  = 0.0;
+    double panelBaseEfficiency          = 0.0;
+    double panelMaterialFactor          = 0.0;
+    double panelEffectiveBaseEfficiency = 0.0;
+    double panelBifacialGainFactor      = 0.0;
+
+    double cloudCoverPct = 0.0;
+    double rainMm        = 0.0;
+    double temperatureC  = 0.0;
+    double windSpeedKmh  = 0.0;
+
+    double irradianceTheoreticalWm2 = 0.0;
+    double irradianceAdjustedWm2    = 0.0;
+    double pvEfficiency             = 0.0;
+    double pvPowerKW                = 0.0;
+
+    double gridCarbonIntensity = 0.0;
+
+    double jobFlops          = 0.0;
+    double jobDurationS      = 0.0;
+    double jobEnergyJ        = 0.0;
+    double jobEnergyKWh      = 0.0;
+    double jobAveragePowerKW = 0.0;
+
+    double energyTotalKWh = 0.0;
+    double energyPvKWh    = 0.0;
+    double energyGridKWh  = 0.0;
+    double co2G           = 0.0;
+};
+
+// Campos double da linha, na mesma ordem em que aparecem no CSV.
+// O leitor do CSV e o arquivo compactado percorrem os campos numericos por aqui,
+// entao uma coluna nova so precisa entrar no struct, no writer e nesta lista.
+inline constexpr double ResultRow::* resultRowDoubleFields[] = {
+    &ResultRow::latitude,
+    &ResultRow::longitude,
+    &ResultRow::panelAreaM2,
+    &ResultRow::panelBaseEfficiency,
+    &ResultRow::panelMaterialFactor,
+    &ResultRow::panelEffectiveBaseEfficiency,
+    &ResultRow::panelBifacialGainFactor,
+    &ResultRow::cloudCoverPct,
+    &ResultRow::rainMm,
+    &ResultRow::temperatureC,
+    &ResultRow::windSpeedKmh,
+    &ResultRow::irradianceTheoreticalWm2,
+    &ResultRow::irradianceAdjustedWm2,
+    &ResultRow::pvEfficiency,
+    &ResultRow::pvPowerKW,
+    &ResultRow::gridCarbonIntensity,
+    &ResultRow::jobFlops,
+    &ResultRow::jobDurationS,
+    &ResultRow::jobEnergyJ,
+    &ResultRow::jobEnergyKWh,
+    &ResultRow::jobAveragePowerKW,
+    &ResultRow::energyTotalKWh,
+    &ResultRow::energyPvKWh,
+    &ResultRow::energyGridKWh,
+    &ResultRow::co2G,
+};
+
+constexpr std::size_t resultRowDoubleCount = std::size(resultRowDoubleFields);
+
+// Nome de cada campo acima, igual ao cabecalho do CSV.
+inline constexpr const char* resultRowDoubleNames[] = {
+    "latitude",
+    "longitude",
+    "panel_area_m2",
+    "panel_base_efficiency",
+    "panel_material_factor",
+    "panel_effective_base_efficiency",
+    "panel_bifacial_gain_factor",
+    "cloud_cover_pct",
+    "rain_mm",
+    "temperature_c",
+    "wind_speed_kmh",
+    "irradiance_theoretical_w_m2",
+    "irradiance_adjusted_w_m2",
+    "pv_efficiency",
+    "pv_power_kw",
+    "grid_carbon_intensity_gco2_kwh",
+    "job_flops",
+    "job_duration_s",
+    "job_energy_j",
+    "job_energy_kwh",
+    "job_average_power_kw",
+    "energy_total_kwh",
+    "energy_pv_kwh",
+    "energy_grid_kwh",
+    "co2_g",
+};
+
+static_assert(std::size(resultRowDoubleNames) == resultRowDoubleCount,
+              "Cada campo double precisa do nome da coluna");
@@ -0,0 +1,393 @@
+#include "ResultsArchive.hpp"
+#include "CivilTime.hpp"
+#include "ResultsCsvReader.hpp"
+#include "ResultsCsvWriter.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+    const char archiveMagic[8] = {'P', 'V', 'F', 'A', 'R', 'C', '0', '1'};
+
+    // horario + dia do ano + 3 textos + numeros
+    const std::uint64_t archiveColumnCount = 2 + 3 + resultRowDoubleCount;
+
+    void putVarint(std::string& out, std::uint64_t value)
+    {
+        while (value >= 0x80) {
+            out += static_cast<char>((value & 0x7F) | 0x80);
+            value >>= 7;
+        }
+        out += static_cast<char>(value);
+    }
+
+    // Zigzag: numeros negativos pequenos tambem viram varint curto.
+    std::uint64_t zigzag(std::int64_t value)
+    {
+        return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+    }
+
+    std::int64_t unzigzag(std::uint64_t value)
+    {
+        return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+    }
+
+    std::uint64_t toBits(double value)
+    {
+        std::uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    double fromBits(std::uint64_t bits)
+    {
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    [[noreturn]] void corrupted(const std::string& path)
+    {
+        throw std::runtime_error("Arquivo compactado invalido ou corrompido: " + path);
+    }
+
+    std::uint64_t readVarint(const unsigned char*& position, const unsigned char* end, const std::string& path)
+    {
+        std::uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (position == end)
+                corrupted(path);
+            unsigned char byte = *position++;
+            value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0)
+                return value;
+        }
+        corrupted(path);
+    }
+}
+
+void ResultsArchiveWriter::addText(TextColumn& column, const std::string& value)
+{
+    std::uint64_t index = 0;
+    while (index < column.dictionary.size() && column.dictionary[index] != value)
+        index++;
+
+    if (index == column.dictionary.size())
+        column.dictionary.push_back(value);
+
+    if (column.currentRun > 0 && index == column.currentIndex) {
+        column.currentRun++;
+        return;
+    }
+
+    if (column.currentRun > 0) {
+        putVarint(column.runs, column.currentIndex);
+        putVarint(column.runs, column.currentRun);
+    }
+
+    column.currentIndex = index;
+    column.currentRun = 1;
+}
+
+void ResultsArchiveWriter::addNumber(NumberColumn& column, double value)
+{
+    std::uint64_t bits = toBits(value);
+    std::uint64_t diff = bits ^ column.previousBits;
+
+    if (diff == 0) {
+        column.repeatRun++;
+        return;
+    }
+
+    // Byte 0 marca uma sequencia de valores iguais ao anterior.
+    if (column.repeatRun > 0) {
+        column.bytes += '\0';
+        putVarint(column.bytes, column.repeatRun);
+        column.repeatRun = 0;
+    }
+
+    // Depois do XOR, valores proximos tem bytes zerados nas pontas.
+    // O cabecalho diz quantos zeros tem em cima e embaixo; so o miolo e gravado.
+    int leadingBytes = __builtin_clzll(diff) / 8;
+    int trailingBytes = __builtin_ctzll(diff) / 8;
+    int keptBytes = 8 - leadingBytes - trailingBytes;
+
+    column.bytes += static_cast<char>(1 + leadingBytes * 8 + trailingBytes);
+
+    std::uint64_t kept = diff >> (trailingBytes * 8);
+    for (int i = 0; i < keptBytes; i++) {
+        column.bytes += static_cast<char>(kept & 0xFF);
+        kept >>= 8;
+    }
+
+    column.previousBits = bits;
+}
+
+void ResultsArchiveWriter::add(const ResultRow& row)
+{
+    std::int64_t seconds = rowSeconds(row);
+
+    if (rows == 0) {
+        putVarint(timestamps, zigzag(seconds));
+    }
+    else {
+        std::int64_t delta = seconds - previousTimestamp;
+        putVarint(timestamps, zigzag(delta - previousDelta));
+        previousDelta = delta;
+    }
+    previousTimestamp = seconds;
+
+    putVarint(daysOfYear, zigzag(row.dayOfYear - previousDayOfYear));
+    previousDayOfYear = row.dayOfYear;
+
+    addText(texts[0], row.city);
+    addText(texts[1], row.panelMaterial);
+    addText(texts[2], row.panelFaceType);
+
+    for (std::size_t i = 0; i < resultRowDoubleCount; i++)
+        addNumber(numbers[i], row.*resultRowDoubleFields[i]);
+
+    rows++;
+}
+
+std::size_t ResultsArchiveWriter::rowCount() const
+{
+    return rows;
+}
+
+std::string ResultsArchiveWriter::finish() const
+{
+    std::string out(archiveMagic, sizeof(archiveMagic));
+    putVarint(out, rows);
+    putVarint(out, archiveColumnCount);
+
+    auto putBlock = [&out](const std::string& block) {
+        putVarint(out, block.size());
+        out += block;
+    };
+
+    putBlock(timestamps);
+    putBlock(daysOfYear);
+
+    // As repeticoes que ainda estao abertas so entram aqui no fim.
+    for (const TextColumn& column : texts) {
+        std::string block;
+        putVarint(block, column.dictionary.size());
+        for (const std::string& entry : column.dictionary) {
+            putVarint(block, entry.size());
+            block += entry;
+        }
+
+        block += column.runs;
+        if (column.currentRun > 0) {
+            putVarint(block, column.currentIndex);
+            putVarint(block, column.currentRun);
+        }
+        putBlock(block);
+    }
+
+    for (const NumberColumn& column : numbers) {
+        std::string block = column.bytes;
+        if (column.repeatRun > 0) {
+            block += '\0';
+            putVarint(block, column.repeatRun);
+        }
+        putBlock(block);
+    }
+
+    return out;
+}
+
+std::size_t ResultsArchiveWriter::archiveCsv(const std::string& csvPath, const std::string& archivePath)
+{
+    ResultsCsvReader reader(csvPath);
+    ResultsArchiveWriter writer;
+
+    ResultRow row;
+    while (reader.next(row))
+        writer.add(row);
+
+    std::string archive = writer.finish();
+
+    std::ofstream file(archivePath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+        throw std::runtime_error("Nao consegui criar o arquivo compactado em: " + archivePath);
+
+    file.write(archive.data(), static_cast<std::streamsize>(archive.size()));
+    if (!file)
+        throw std::runtime_error("Nao consegui gravar o arquivo compactado em: " + archivePath);
+
+    return writer.rowCount();
+}
+
+ResultsArchiveReader::ResultsArchiveReader(const std::string& path)
+    : path(path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+        throw std::runtime_error("Nao consegui abrir o arquivo compactado em: " + path);
+
+    std::ostringstream buffer;
+    buffer << file.rdbuf();
+    data = buffer.str();
+
+    if (data.size() < sizeof(archiveMagic) ||
+        std::memcmp(data.data(), archiveMagic, sizeof(archiveMagic)) != 0)
+        corrupted(path);
+
+    Cursor header;
+    header.position = reinterpret_cast<const unsigned char*>(data.data()) + sizeof(archiveMagic);
+    header.end = reinterpret_cast<const unsigned char*>(data.data()) + data.size();
+
+    auto readHeaderVarint = [&path](Cursor& cursor) {
+        return readVarint(cursor.position, cursor.end, path);
+    };
+
+    rows = static_cast<std::size_t>(readHeaderVarint(header));
+    if (readHeaderVarint(header) != archiveColumnCount)
+        corrupted(path);
+
+    auto nextBlock = [&]() {
+        std::uint64_t size = readHeaderVarint(header);
+        if (size > static_cast<std::uint64_t>(header.end - header.position))
+            corrupted(path);
+
+        Cursor block;
+        block.position = header.position;
+        block.end = header.position + size;
+        header.position = block.end;
+        return block;
+    };
+
+    timestamps = nextBlock();
+    daysOfYear = nextBlock();
+
+    for (TextCursor& column : texts) {
+        column.cursor = nextBlock();
+
+        std::uint64_t entries = readHeaderVarint(column.cursor);
+        for (std::uint64_t i = 0; i < entries; i++) {
+            std::uint64_t size = readHeaderVarint(column.cursor);
+            if (size > static_cast<std::uint64_t>(column.cursor.end - column.cursor.position))
+                corrupted(path);
+
+            column.dictionary.emplace_back(reinterpret_cast<const char*>(column.cursor.position),
+                                           static_cast<std::size_t>(size));
+            column.cursor.position += size;
+        }
+    }
+
+    for (NumberCursor& column : numbers)
+        column.cursor = nextBlock();
+}
+
+std::size_t ResultsArchiveReader::rowCount() const
+{
+    return rows;
+}
+
+const std::string& ResultsArchiveReader::readText(TextCursor& column)
+{
+    if (column.remaining == 0) {
+        column.currentIndex = readVarint(column.cursor.position, column.cursor.end, path);
+        column.remaining = readVarint(column.cursor.position, column.cursor.end, path);
+
+        if (column.currentIndex >= column.dictionary.size() || column.remaining == 0)
+            corrupted(path);
+    }
+
+    column.remaining--;
+    return column.dictionary[column.currentIndex];
+}
+
+double ResultsArchiveReader::readNumber(NumberCursor& column)
+{
+    if (column.remaining > 0) {
+        column.remaining--;
+        return fromBits(column.previousBits);
+    }
+
+    if (column.cursor.position == column.cursor.end)
+        corrupted(path);
+
+    unsigned header = *column.cursor.position++;
+
+    if (header == 0) {
+        column.remaining = readVarint(column.cursor.position, column.cursor.end, path);
+        if (column.remaining == 0)
+            corrupted(path);
+
+        column.remaining--;
+        return fromBits(column.previousBits);
+    }
+
+    unsigned leadingBytes = (header - 1) / 8;
+    unsigned trailingBytes = (header - 1) % 8;
+    if (leadingBytes + trailingBytes > 7)
+        corrupted(path);
+
+    unsigned keptBytes = 8 - leadingBytes - trailingBytes;
+    if (keptBytes > static_cast<unsigned>(column.cursor.end - column.cursor.position))
+        corrupted(path);
+
+    std::uint64_t kept = 0;
+    for (unsigned i = 0; i < keptBytes; i++)
+        kept |= static_cast<std::uint64_t>(column.cursor.position[i]) << (8 * i);
+    column.cursor.position += keptBytes;
+
+    column.previousBits ^= kept << (trailingBytes * 8);
+    return fromBits(column.previousBits);
+}
+
+bool ResultsArchiveReader::next(ResultRow& row)
+{
+    if (rowsRead == rows)
+        return false;
+
+    std::uint64_t encoded = readVarint(timestamps.position, timestamps.end, path);
+
+    if (rowsRead == 0) {
+        previousTimestamp = unzigzag(encoded);
+    }
+    else {
+        previousDelta += unzigzag(encoded);
+        previousTimestamp += previousDelta;
+    }
+    setRowTime(row, previousTimestamp);
+
+    previousDayOfYear += unzigzag(readVarint(daysOfYear.position, daysOfYear.end, path));
+    row.dayOfYear = static_cast<int>(previousDayOfYear);
+
+    row.city = readText(texts[0]);
+    row.panelMaterial = readText(texts[1]);
+    row.panelFaceType = readText(texts[2]);
+
+    for (std::size_t i = 0; i < resultRowDoubleCount; i++)
+        row.*resultRowDoubleFields[i] = readNumber(numbers[i]);
+
+    rowsRead++;
+    return true;
+}
+
+std::size_t ResultsArchiveReader::restoreCsv(const std::string& archivePath, const std::string& csvPath)
+{
+    ResultsArchiveReader reader(archivePath);
+
+    std::string text = ResultsCsvWriter::header();
+    ResultRow row;
+    std::size_t count = 0;
+    while (reader.next(row)) {
+        ResultsCsvWriter::appendRow(text, row);
+        count++;
+    }
+
+    std::ofstream file(csvPath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+        throw std::runtime_error("Nao consegui criar o arquivo de resultados em: " + csvPath);
+
+    file.write(text.data(), static_cast<std::streamsize>(text.size()));
+    return count;
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "ResultRow.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Aqui fica o formato compactado dos dias ja encerrados (RPVfirstDDMMAA.pva).
+//
+// O arquivo e guardado por coluna, e cada coluna usa a codificacao que combina
+// com o jeito que ela muda ao longo do dia:
+// - horario: delta do delta em segundos (linhas de minuto em minuto viram 1 byte)
+// - dia do ano: delta
+// - textos (cidade, material, face): dicionario + repeticoes
+// - numeros: XOR com o valor anterior, guardando so os bytes que mudaram,
+//   e valores repetidos (area, eficiencia base, job_flops, fator de CO2...)
+//   viram uma repeticao so
+// Todos os inteiros vao como varint.
+//
+// Decodificar e reconstruir a linha e exato: reescrevendo as linhas com o
+// ResultsCsvWriter sai o mesmo texto do CSV original.
+
+class ResultsArchiveWriter
+{
+public:
+    void add(const ResultRow& row);
+
+    std::size_t rowCount() const;
+
+    // Monta o arquivo inteiro (cabecalho + colunas).
+    std::string finish() const;
+
+    // Atalho: le o CSV do dia e grava o .pva. Devolve quantas linhas entraram.
+    static std::size_t archiveCsv(const std::string& csvPath, const std::string& archivePath);
+
+private:
+    struct TextColumn
+    {
+        std::vector<std::string> dictionary;
+        std::string runs;
+        std::uint64_t currentIndex = 0;
+        std::uint64_t currentRun = 0;
+    };
+
+    struct NumberColumn
+    {
+        std::string bytes;
+        std::uint64_t previousBits = 0;
+        std::uint64_t repeatRun = 0;
+    };
+
+    void addText(TextColumn& column, const std::string& value);
+    void addNumber(NumberColumn& column, double value);
+
+    std::size_t rows = 0;
+
+    std::string timestamps;
+    std::int64_t previousTimestamp = 0;
+    std::int64_t previousDelta = 0;
+
+    std::string daysOfYear;
+    std::int64_t previousDayOfYear = 0;
+
+    std::array<TextColumn, 3> texts;
+    std::array<NumberColumn, resultRowDoubleCount> numbers;
+};
+
+// Devolve as linhas uma por vez, sem montar o dia inteiro na memoria.
+class ResultsArchiveReader
+{
+public:
+    explicit ResultsArchiveReader(const std::string& path);
+
+    std::size_t rowCount() const;
+
+    bool next(ResultRow& row);
+
+    // Atalho: reescreve o CSV a partir do .pva. Devolve quantas linhas sairam.
+    static std::size_t restoreCsv(const std::string& archivePath, const std::string& csvPath);
+
+private:
+    struct Cursor
+    {
+        const unsigned char* position = nullptr;
+        const unsigned char* end = nullptr;
+    };
+
+    struct TextCursor
+    {
+        Cursor cursor;
+        std::vector<std::string> dictionary;
+        std::uint64_t currentIndex = 0;
+        std::uint64_t remaining = 0;
+    };
+
+    struct NumberCursor
+    {
+        Cursor cursor;
+        std::uint64_t previousBits = 0;
+        std::uint64_t remaining = 0;
+    };
+
+    const std::string& readText(TextCursor& column);
+    double readNumber(NumberCursor& column);
+
+    std::string path;
+    std::string data;
+
+    std::size_t rows = 0;
+    std::size_t rowsRead = 0;
+
+    Cursor timestamps;
+    std::int64_t previousTimestamp = 0;
+    std::int64_t previousDelta = 0;
+
+    Cursor daysOfYear;
+    std::int64_t previousDayOfYear = 0;
+
+    std::array<TextCursor, 3> texts;
+    std::array<NumberCursor, resultRowDoubleCount> numbers;
+};
@@ -0,0 +1,181 @@
+#include "ResultsCsvReader.hpp"
+#include "CivilTime.hpp"
+#include "ResultsCsvWriter.hpp"
+
+#include <charconv>
+#include <stdexcept>
+
+namespace
+{
+    const std::size_t columnCount = 33;
+
+    bool parseNumber(std::string_view text, double& value)
+    {
+        std::from_chars_result result = std::from_chars(text.data(), text.data() + text.size(), value);
+        return result.ec == std::errc() && result.ptr == text.data() + text.size();
+    }
+
+    bool parseNumber(std::string_view text, int& value)
+    {
+        std::from_chars_result result = std::from_chars(text.data(), text.data() + text.size(), value);
+        return result.ec == std::errc() && result.ptr == text.data() + text.size();
+    }
+
+    // "AAAA-MM-DD HH:MM:SS"
+    bool parseDateTime(std::string_view text, ResultRow& row)
+    {
+        return text.size() == 19 &&
+               parseNumber(text.substr(0, 4), row.year) &&
+               parseNumber(text.substr(5, 2), row.month) &&
+               parseNumber(text.substr(8, 2), row.day) &&
+               parseNumber(text.substr(11, 2), row.hour) &&
+               parseNumber(text.substr(14, 2), row.minute) &&
+               parseNumber(text.substr(17, 2), row.second);
+    }
+
+    // Coluna do CSV de cada campo de resultRowDoubleFields:
+    // latitude e longitude ficam antes dos textos do painel; o resto vem em sequencia.
+    std::size_t doubleFieldColumn(std::size_t index)
+    {
+        return index < 2 ? 6 + index : 8 + index;
+    }
+
+    // Tudo depois da linha de cabecalho.
+    std::string_view afterHeader(std::string_view text)
+    {
+        std::size_t headerEnd = text.find('\n');
+        return headerEnd == std::string_view::npos ? std::string_view() : text.substr(headerEnd + 1);
+    }
+
+    bool parseFields(const std::string_view* fields, ResultRow& row)
+    {
+        if (!parseDateTime(fields[3], row) || !parseNumber(fields[4], row.dayOfYear))
+            return false;
+
+        row.city.assign(fields[5].data(), fields[5].size());
+        row.panelMaterial.assign(fields[8].data(), fields[8].size());
+        row.panelFaceType.assign(fields[9].data(), fields[9].size());
+
+        for (std::size_t i = 0; i < resultRowDoubleCount; i++) {
+            if (!parseNumber(fields[doubleFieldColumn(i)], row.*resultRowDoubleFields[i]))
+                return false;
+        }
+
+        return true;
+    }
+
+    // Linha em branco no fim do arquivo nao e erro.
+    bool isBlank(std::size_t fieldCount, const std::string_view* fields)
+    {
+        return fieldCount == 1 && fields[0].empty();
+    }
+}
+
+ResultsCsvReader::ResultsCsvReader(const std::string& path)
+    : path(path),
+      file(path),
+      body(afterHeader(file.text())),
+      scanner(body)
+{
+    std::string_view text = file.text();
+    std::string_view header = text.substr(0, text.size() - body.size());
+
+    while (!header.empty() && (header.back() == '\n' || header.back() == '\r'))
+        header.remove_suffix(1);
+
+    const std::string& expected = ResultsCsvWriter::header();
+    if (header != std::string_view(expected).substr(0, expected.size() - 1))
+        throw std::runtime_error("O arquivo nao tem o cabecalho de 33 colunas do PV-First: " + path);
+}
+
+bool ResultsCsvReader::next(ResultRow& row)
+{
+    std::string_view fields[columnCount];
+    std::size_t fieldCount = 0;
+
+    while (scanner.nextLine(fields, columnCount, fieldCount)) {
+        line++;
+
+        if (isBlank(fieldCount, fields))
+            continue;
+
+        if (fieldCount != columnCount || !parseFields(fields, row))
+            throw std::runtime_error("Linha invalida no arquivo de resultados " + path +
+                                     " (linha " + std::to_string(line) + ")");
+        return true;
+    }
+
+    return false;
+}
+
+std::size_t ResultsCsvReader::lineNumber() const
+{
+    return line;
+}
+
+std::size_t ResultsCsvReader::skippedLines() const
+{
+    return skipped;
+}
+
+std::size_t ResultsCsvReader::firstSkippedLine() const
+{
+    return firstSkipped;
+}
+
+std::size_t ResultsCsvReader::rowCapacity() const
+{
+    // A ultima linha pode nao ter '\n'.
+    return CsvScanner::countLines(body) + 1;
+}
+
+std::size_t ResultsCsvReader::readColumns(const ResultCsvColumns& columns, std::size_t capacity)
+{
+    std::string_view fields[columnCount];
+    std::size_t fieldCount = 0;
+    std::size_t rows = 0;
+    ResultRow time;
+
+    while (rows < capacity && scanner.nextLine(fields, columnCount, fieldCount)) {
+        line++;
+
+        if (isBlank(fieldCount, fields))
+            continue;
+
+        bool valid = fieldCount == columnCount && parseDateTime(fields[3], time);
+
+        if (valid && columns.dayOfYear != nullptr)
+            valid = parseNumber(fields[4], columns.dayOfYear[rows]);
+
+        for (std::size_t i = 0; valid && i < resultRowDoubleCount; i++) {
+            if (columns.values[i] != nullptr)
+                valid = parseNumber(fields[doubleFieldColumn(i)], columns.values[i][rows]);
+        }
+
+        // A posicao rows fica para a proxima linha boa, que escreve por cima.
+        if (!valid) {
+            if (skipped == 0)
+                firstSkipped = line;
+            skipped++;
+            continue;
+        }
+
+        if (columns.seconds != nullptr)
+            columns.seconds[rows] = rowSeconds(time);
+
+        rows++;
+    }
+
+    return rows;
+}
+
+bool ResultsCsvReader::parseLine(std::string_view line, ResultRow& row)
+{
+    std::string_view fields[columnCount];
+    std::size_t fieldCount = 0;
+
+    CsvScanner scanner(line);
+    return scanner.nextLine(fields, columnCount, fieldCount) &&
+           fieldCount == columnCount &&
+           parseFields(fields, row);
+}
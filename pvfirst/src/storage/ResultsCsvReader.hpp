@@ -0,0 +1,69 @@
+#pragma once
+
+#include "CsvScanner.hpp"
+#include "MappedFile.hpp"
+#include "ResultRow.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Colunas de destino do ResultsCsvReader::readColumns, um ponteiro por coluna.
+// Ponteiro nulo: a coluna e pulada sem nem converter o numero.
+struct ResultCsvColumns
+{
+    // run_datetime em segundos corridos (ver CivilTime.hpp).
+    std::int64_t* seconds = nullptr;
+    int* dayOfYear = nullptr;
+
+    // Na ordem de resultRowDoubleFields.
+    double* values[resultRowDoubleCount] = {};
+};
+
+// Aqui eu leio de volta um CSV de resultados (results/RPVfirstDDMMAA.csv).
+// So o formato atual de 33 colunas e aceito: o cabecalho precisa ser
+// exatamente o do ResultsCsvWriter.
+//
+// run_id, run_date e run_time nao sao lidos: a data e a hora saem do run_datetime,
+// do mesmo jeito que o writer gera as quatro colunas a partir de um horario so.
+//
+// O arquivo fica mapeado na memoria e os campos sao separados pelo CsvScanner,
+// sem copiar nem alocar nada por campo.
+class ResultsCsvReader
+{
+public:
+    explicit ResultsCsvReader(const std::string& path);
+
+    // Le a proxima linha. Devolve false quando o arquivo acaba.
+    // Linha invalida lanca std::runtime_error; chamando de novo, a leitura segue na linha seguinte.
+    bool next(ResultRow& row);
+
+    // Linha do arquivo da ultima leitura (o cabecalho e a linha 1).
+    std::size_t lineNumber() const;
+
+    // Numero maximo de linhas que ainda podem sair (conta os '\n').
+    std::size_t rowCapacity() const;
+
+    // Le ate capacity linhas direto para as colunas, a partir da posicao 0 de cada uma.
+    // Os textos (cidade e painel) nao sao lidos. Devolve quantas linhas foram lidas;
+    // menos que capacity quer dizer que o arquivo acabou.
+    // Aqui linha invalida nao lanca: ela e pulada e contada em skippedLines.
+    std::size_t readColumns(const ResultCsvColumns& columns, std::size_t capacity);
+
+    // Linhas invalidas puladas pelo readColumns, e a linha do arquivo da primeira (0 se nenhuma).
+    std::size_t skippedLines() const;
+    std::size_t firstSkippedLine() const;
+
+    // Le uma linha sem o '\n'. Devolve false se faltar coluna ou algum numero nao fizer sentido.
+    static bool parseLine(std::string_view line, ResultRow& row);
+
+private:
+    std::string path;
+    MappedFile file;
+    std::string_view body;
+    CsvScanner scanner;
+    std::size_t line = 1;
+    std::size_t skipped = 0;
+    std::size_t firstSkipped = 0;
+};
@@ -0,0 +1,151 @@
+#include "ResultsCsvWriter.hpp"
+#include "CivilTime.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+namespace
+{
+    const char sep = ';';
+
+    // O std::ostream escreve double com precisao 6 no formato %g.
+    // Eu mantenho exatamente esse formato para os arquivos novos continuarem
+    // iguais aos que ja estao em results.
+    void appendNumber(std::string& out, double value)
+    {
+        char text[32];
+        int size = std::snprintf(text, sizeof(text), "%g", value);
+        out.append(text, static_cast<size_t>(size));
+        out += sep;
+    }
+
+    void appendInt(std::string& out, int value)
+    {
+        char text[16];
+        int size = std::snprintf(text, sizeof(text), "%d", value);
+        out.append(text, static_cast<size_t>(size));
+        out += sep;
+    }
+
+    void appendQuoted(std::string& out, const std::string& value)
+    {
+        out += '"';
+        out += value;
+        out += '"';
+        out += sep;
+    }
+}
+
+ResultsCsvWriter::ResultsCsvWriter(const std::string& resultsDir)
+    : resultsDir(resultsDir),
+      rollups(resultsDir)
+{
+}
+
+const std::string& ResultsCsvWriter::header()
+{
+    static const std::string text =
+        "run_id;run_date;run_time;run_datetime;day_of_year;city;latitude;longitude;"
+        "panel_material;panel_face_type;panel_area_m2;panel_base_efficiency;"
+        "panel_material_factor;panel_effective_base_efficiency;panel_bifacial_gain_factor;"
+        "cloud_cover_pct;rain_mm;temperature_c;wind_speed_kmh;"
+        "irradiance_theoretical_w_m2;irradiance_adjusted_w_m2;pv_efficiency;pv_power_kw;"
+        "grid_carbon_intensity_gco2_kwh;job_flops;job_duration_s;job_energy_j;job_energy_kwh;"
+        "job_average_power_kw;energy_total_kwh;energy_pv_kwh;energy_grid_kwh;co2_g\n";
+    return text;
+}
+
+std::string ResultsCsvWriter::dailyFileName(const ResultRow& row)
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "RPVfirst%02d%02d%02d.csv",
+                  row.day, row.month, row.year % 100);
+    return name;
+}
+
+void ResultsCsvWriter::appendRow(std::string& out, const ResultRow& row)
+{
+    char stamp[64];
+
+    std::snprintf(stamp, sizeof(stamp), "run_%d%02d%02d_%02d%02d%02d",
+                  row.year, row.month, row.day, row.hour, row.minute, row.second);
+    out += stamp;
+    out += sep;
+
+    appendDate(out, row.year, row.month, row.day);
+    out += sep;
+
+    std::snprintf(stamp, sizeof(stamp), "%02d:%02d:%02d", row.hour, row.minute, row.second);
+    out += stamp;
+    out += sep;
+
+    appendDateTime(out, row);
+    out += sep;
+
+    appendInt(out, row.dayOfYear);
+    appendQuoted(out, row.city);
+    appendNumber(out, row.latitude);
+    appendNumber(out, row.longitude);
+    appendQuoted(out, row.panelMaterial);
+    appendQuoted(out, row.panelFaceType);
+    appendNumber(out, row.panelAreaM2);
+    appendNumber(out, row.panelBaseEfficiency);
+    appendNumber(out, row.panelMaterialFactor);
+    appendNumber(out, row.panelEffectiveBaseEfficiency);
+    appendNumber(out, row.panelBifacialGainFactor);
+    appendNumber(out, row.cloudCoverPct);
+    appendNumber(out, row.rainMm);
+    appendNumber(out, row.temperatureC);
+    appendNumber(out, row.windSpeedKmh);
+    appendNumber(out, row.irradianceTheoreticalWm2);
+    appendNumber(out, row.irradianceAdjustedWm2);
+    appendNumber(out, row.pvEfficiency);
+    appendNumber(out, row.pvPowerKW);
+    appendNumber(out, row.gridCarbonIntensity);
+    appendNumber(out, row.jobFlops);
+    appendNumber(out, row.jobDurationS);
+    appendNumber(out, row.jobEnergyJ);
+    appendNumber(out, row.jobEnergyKWh);
+    appendNumber(out, row.jobAveragePowerKW);
+    appendNumber(out, row.energyTotalKWh);
+    appendNumber(out, row.energyPvKWh);
+    appendNumber(out, row.energyGridKWh);
+    appendNumber(out, row.co2G);
+
+    // A ultima coluna termina com quebra de linha, nao com separador.
+    out.back() = '\n';
+}
+
+std::filesystem::path ResultsCsvWriter::append(const ResultRow& row)
+{
+    std::filesystem::create_directories(resultsDir);
+
+    std::filesystem::path resultsFilePath =
+        std::filesystem::path(resultsDir) / dailyFileName(row);
+
+    bool fileExists = std::filesystem::exists(resultsFilePath);
+
+    std::ofstream file(resultsFilePath, std::ios::app);
+
+    if (!file.is_open()) {
+        throw std::runtime_error(
+            "Nao consegui abrir ou criar o arquivo de resultados em: " +
+            resultsFilePath.string()
+        );
+    }
+
+    buffer.clear();
+
+    if (!fileExists)
+        buffer += header();
+
+    appendRow(buffer, row);
+
+    file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    file.close();
+
+    rollups.append(row);
+
+    return resultsFilePath;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "ResultRow.hpp"
+#include "ResultsRollup.hpp"
+
+#include <filesystem>
+#include <string>
+
+// Aqui fica a escrita do CSV de resultados, que antes morava dentro do controller.
+// Eu uso ponto e virgula como separador, porque no Excel em portugues
+// o CSV com virgula costuma abrir todo baguncado.
+class ResultsCsvWriter
+{
+public:
+    explicit ResultsCsvWriter(const std::string& resultsDir = "results");
+
+    // Acrescenta a linha no arquivo do dia (um arquivo por dia) e devolve o caminho usado.
+    // Se o arquivo ainda nao existir, o cabecalho entra primeiro.
+    // Os totais de 15 min, hora e dia (ResultsRollup.hpp) sao atualizados junto.
+    std::filesystem::path append(const ResultRow& row);
+
+    // Exemplo: RPVfirst170626.csv
+    static std::string dailyFileName(const ResultRow& row);
+
+    // Linha de cabecalho, ja com o '\n'.
+    static const std::string& header();
+
+    // Formata a linha no fim de out, com o mesmo texto que o std::ostream produzia.
+    // Reaproveitando o mesmo out, a formatacao nao aloca nada.
+    static void appendRow(std::string& out, const ResultRow& row);
+
+private:
+    std::string resultsDir;
+    std::string buffer;
+    ResultsRollupWriter rollups;
+};
@@ -0,0 +1,316 @@
+#include "ResultsRollup.hpp"
+#include "CivilTime.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+    const char sep = ';';
+
+    // Uma linha de faixa nunca passa disso; e o tanto que eu leio do fim do arquivo.
+    const std::size_t tailBytes = 512;
+
+    // Aqui o numero precisa voltar exatamente igual, porque a linha e lida e
+    // somada de novo a cada minuto. Com %g (6 digitos) o erro ia acumulando ao
+    // longo do dia; to_chars escreve o menor texto que volta para o mesmo double.
+    void appendNumber(std::string& out, double value)
+    {
+        char text[32];
+        std::to_chars_result result = std::to_chars(text, text + sizeof(text), value);
+        out += sep;
+        out.append(text, static_cast<size_t>(result.ptr - text));
+    }
+
+    bool parseNumber(std::string_view text, double& value)
+    {
+        std::from_chars_result result = std::from_chars(text.data(), text.data() + text.size(), value);
+        return result.ec == std::errc() && result.ptr == text.data() + text.size();
+    }
+
+    // Junta duas linhas da mesma faixa (arquivo que ficou com a faixa repetida).
+    void mergeBucket(RollupBucket& into, const RollupBucket& from)
+    {
+        if (from.rows == 0)
+            return;
+
+        if (into.rows == 0) {
+            into.irradianceMinWm2 = from.irradianceMinWm2;
+            into.irradianceMaxWm2 = from.irradianceMaxWm2;
+        }
+        else {
+            into.irradianceMinWm2 = std::min(into.irradianceMinWm2, from.irradianceMinWm2);
+            into.irradianceMaxWm2 = std::max(into.irradianceMaxWm2, from.irradianceMaxWm2);
+        }
+
+        into.rows += from.rows;
+        into.energyTotalKWh += from.energyTotalKWh;
+        into.energyPvKWh += from.energyPvKWh;
+        into.energyGridKWh += from.energyGridKWh;
+        into.co2G += from.co2G;
+        into.irradianceSumWm2 += from.irradianceSumWm2;
+    }
+}
+
+void RollupBucket::add(const ResultRow& row)
+{
+    double irradiance = row.irradianceAdjustedWm2;
+
+    if (rows == 0) {
+        irradianceMinWm2 = irradiance;
+        irradianceMaxWm2 = irradiance;
+    }
+    else {
+        irradianceMinWm2 = std::min(irradianceMinWm2, irradiance);
+        irradianceMaxWm2 = std::max(irradianceMaxWm2, irradiance);
+    }
+
+    rows++;
+    energyTotalKWh += row.energyTotalKWh;
+    energyPvKWh += row.energyPvKWh;
+    energyGridKWh += row.energyGridKWh;
+    co2G += row.co2G;
+    irradianceSumWm2 += irradiance;
+}
+
+ResultsRollupWriter::ResultsRollupWriter(const std::string& resultsDir)
+    : resultsDir(resultsDir)
+{
+}
+
+const std::string& ResultsRollupWriter::header()
+{
+    static const std::string text =
+        "bucket_start;rows;energy_total_kwh;energy_pv_kwh;energy_grid_kwh;co2_g;"
+        "irradiance_min_w_m2;irradiance_mean_w_m2;irradiance_max_w_m2;irradiance_sum_w_m2\n";
+    return text;
+}
+
+void ResultsRollupWriter::appendBucket(std::string& out, const RollupBucket& bucket)
+{
+    ResultRow time;
+    setRowTime(time, bucket.start);
+
+    appendDateTime(out, time);
+    out += ';';
+    out += std::to_string(bucket.rows);
+
+    appendNumber(out, bucket.energyTotalKWh);
+    appendNumber(out, bucket.energyPvKWh);
+    appendNumber(out, bucket.energyGridKWh);
+    appendNumber(out, bucket.co2G);
+    appendNumber(out, bucket.irradianceMinWm2);
+    appendNumber(out, bucket.rows > 0 ? bucket.irradianceSumWm2 / static_cast<double>(bucket.rows) : 0.0);
+    appendNumber(out, bucket.irradianceMaxWm2);
+
+    // A media e para quem le o arquivo; a soma e o que volta para a proxima linha,
+    // sem passar pela divisao.
+    appendNumber(out, bucket.irradianceSumWm2);
+    out += '\n';
+}
+
+bool ResultsRollupWriter::parseBucket(const std::string& line, RollupBucket& bucket)
+{
+    std::string_view fields[10];
+    std::size_t count = 0;
+    std::size_t start = 0;
+
+    while (count < 10) {
+        std::size_t end = line.find(sep, start);
+        fields[count++] = std::string_view(line).substr(start, end == std::string::npos ? std::string::npos : end - start);
+        if (end == std::string::npos)
+            break;
+        start = end + 1;
+    }
+
+    if (count != 9 && count != 10)
+        return false;
+
+    ResultRow time;
+    if (std::sscanf(std::string(fields[0]).c_str(), "%d-%d-%d %d:%d:%d",
+                    &time.year, &time.month, &time.day, &time.hour, &time.minute, &time.second) != 6)
+        return false;
+    bucket.start = rowSeconds(time);
+
+    std::from_chars_result rows = std::from_chars(fields[1].data(), fields[1].data() + fields[1].size(), bucket.rows);
+    if (rows.ec != std::errc() || rows.ptr != fields[1].data() + fields[1].size())
+        return false;
+
+    double mean = 0.0;
+    if (!parseNumber(fields[2], bucket.energyTotalKWh) ||
+        !parseNumber(fields[3], bucket.energyPvKWh) ||
+        !parseNumber(fields[4], bucket.energyGridKWh) ||
+        !parseNumber(fields[5], bucket.co2G) ||
+        !parseNumber(fields[6], bucket.irradianceMinWm2) ||
+        !parseNumber(fields[7], mean) ||
+        !parseNumber(fields[8], bucket.irradianceMaxWm2))
+        return false;
+
+    if (count == 10)
+        return parseNumber(fields[9], bucket.irradianceSumWm2);
+
+    // Linha do formato antigo: a soma nao foi guardada.
+    bucket.irradianceSumWm2 = mean * static_cast<double>(bucket.rows);
+    return true;
+}
+
+void ResultsRollupWriter::append(const ResultRow& row)
+{
+    std::int64_t seconds = rowSeconds(row);
+
+    appendTo("APVfirst_15min.csv", floorDiv(seconds, 900) * 900, row);
+    appendTo("APVfirst_hora.csv", floorDiv(seconds, 3600) * 3600, row);
+    appendTo("APVfirst_dia.csv", floorDiv(seconds, 86400) * 86400, row);
+}
+
+void ResultsRollupWriter::appendTo(const std::string& fileName, std::int64_t bucketStart, const ResultRow& row)
+{
+    std::filesystem::create_directories(resultsDir);
+
+    std::filesystem::path rollupPath = std::filesystem::path(resultsDir) / fileName;
+
+    std::uintmax_t fileSize = std::filesystem::exists(rollupPath) ? std::filesystem::file_size(rollupPath) : 0;
+
+    RollupBucket bucket;
+    bucket.start = bucketStart;
+
+    // Onde a linha nova comeca: no fim do arquivo, ou em cima da ultima linha
+    // quando ela ainda e a faixa desta linha de resultado.
+    std::uintmax_t writeOffset = fileSize;
+
+    buffer.clear();
+
+    if (fileSize == 0) {
+        buffer += header();
+    }
+    else {
+        std::ifstream input(rollupPath, std::ios::binary);
+        std::uintmax_t tailStart = fileSize > tailBytes ? fileSize - tailBytes : 0;
+
+        std::string tail(static_cast<std::size_t>(fileSize - tailStart), '\0');
+        input.seekg(static_cast<std::streamoff>(tailStart));
+        input.read(tail.data(), static_cast<std::streamsize>(tail.size()));
+
+        if (!input) {
+            throw std::runtime_error("Nao consegui ler o fim do arquivo de totais em: " + rollupPath.string());
+        }
+
+        bool complete = tail.back() == '\n';
+        std::size_t lineEnd = complete ? tail.size() - 1 : tail.size();
+        std::size_t lineStart = tail.rfind('\n', lineEnd == 0 ? 0 : lineEnd - 1);
+        lineStart = lineStart == std::string::npos ? 0 : lineStart + 1;
+
+        std::string lastLine = tail.substr(lineStart, lineEnd - lineStart);
+        RollupBucket last;
+        bool parsed = complete && parseBucket(lastLine, last);
+
+        // Caminho lento: linha fora de ordem, ou arquivo do formato antigo
+        // (linha de 9 colunas, ou so o cabecalho antigo).
+        bool legacyLine = parsed && std::count(lastLine.begin(), lastLine.end(), sep) == 8;
+        bool legacyHeader = complete && tailStart + lineStart == 0 && lastLine + '\n' != header();
+        if (legacyLine || legacyHeader || (parsed && last.start > bucketStart)) {
+            rewriteWith(rollupPath, bucketStart, row);
+            return;
+        }
+
+        if (parsed && last.start == bucketStart) {
+            bucket = last;
+            writeOffset = tailStart + lineStart;
+        }
+        else if (!complete) {
+            // Uma escrita interrompida deixou meia linha no fim: eu escrevo por cima dela.
+            writeOffset = tailStart + lineStart;
+        }
+    }
+
+    bucket.add(row);
+    appendBucket(buffer, bucket);
+
+    if (fileSize == 0) {
+        std::ofstream file(rollupPath, std::ios::binary);
+        if (!file.is_open()) {
+            throw std::runtime_error("Nao consegui criar o arquivo de totais em: " + rollupPath.string());
+        }
+        file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        return;
+    }
+
+    {
+        std::fstream file(rollupPath, std::ios::in | std::ios::out | std::ios::binary);
+        if (!file.is_open()) {
+            throw std::runtime_error("Nao consegui abrir o arquivo de totais em: " + rollupPath.string());
+        }
+        file.seekp(static_cast<std::streamoff>(writeOffset));
+        file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    }
+
+    // A linha reescrita pode ter ficado mais curta que a anterior.
+    std::uintmax_t newSize = writeOffset + buffer.size();
+    if (newSize < fileSize)
+        std::filesystem::resize_file(rollupPath, newSize);
+}
+
+void ResultsRollupWriter::rewriteWith(const std::filesystem::path& rollupPath, std::int64_t bucketStart,
+                                      const ResultRow& row)
+{
+    std::vector<RollupBucket> buckets;
+    {
+        std::ifstream input(rollupPath, std::ios::binary);
+        if (!input.is_open()) {
+            throw std::runtime_error("Nao consegui ler o arquivo de totais em: " + rollupPath.string());
+        }
+
+        std::string line;
+        RollupBucket bucket;
+        while (std::getline(input, line)) {
+            if (parseBucket(line, bucket))
+                buckets.push_back(bucket);
+        }
+    }
+
+    RollupBucket fresh;
+    fresh.start = bucketStart;
+    buckets.push_back(fresh);
+
+    // Em ordem de inicio, com cada faixa uma vez so.
+    std::stable_sort(buckets.begin(), buckets.end(),
+                     [](const RollupBucket& a, const RollupBucket& b) { return a.start < b.start; });
+
+    std::vector<RollupBucket> merged;
+    for (const RollupBucket& bucket : buckets) {
+        if (merged.empty() || merged.back().start != bucket.start)
+            merged.push_back(bucket);
+        else
+            mergeBucket(merged.back(), bucket);
+    }
+
+    for (RollupBucket& bucket : merged) {
+        if (bucket.start == bucketStart)
+            bucket.add(row);
+    }
+
+    buffer = header();
+    for (const RollupBucket& bucket : merged)
+        appendBucket(buffer, bucket);
+
+    // Escrevo ao lado e troco de uma vez: uma queda no meio nao perde o arquivo.
+    std::filesystem::path temporary = rollupPath;
+    temporary += ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            throw std::runtime_error("Nao consegui criar o arquivo de totais em: " + temporary.string());
+        }
+        file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        if (!file) {
+            throw std::runtime_error("Nao consegui gravar o arquivo de totais em: " + temporary.string());
+        }
+    }
+    std::filesystem::rename(temporary, rollupPath);
+}
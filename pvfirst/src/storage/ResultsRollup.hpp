@@ -0,0 +1,69 @@
+#pragma once
+
+#include "ResultRow.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+// Totais por faixa de tempo, mantidos na hora em que cada linha e escrita.
+// Assim painel e relatorio leem algumas centenas de linhas em vez de
+// refazer a soma de todas as linhas de minuto.
+//
+// Sao tres arquivos ao lado dos CSVs do dia, um por granularidade:
+//   results/APVfirst_15min.csv, results/APVfirst_hora.csv, results/APVfirst_dia.csv
+//
+// A ultima linha de cada arquivo e a faixa ainda aberta. Cada linha nova
+// de resultado le so essa ultima linha, soma nela e reescreve no lugar
+// (ou acrescenta uma linha nova quando a faixa virou). O custo por linha e
+// fixo, nao importa o tamanho do arquivo, e nada fica so na memoria:
+// um processo novo a cada minuto continua os mesmos totais.
+//
+// Uma linha de resultado fora de ordem (de uma faixa que ja fechou) e o caso
+// raro: ai o arquivo inteiro e lido, a faixa dela e achada (ou criada no lugar
+// certo) e o arquivo e reescrito. O mesmo acontece uma vez com arquivo do
+// formato antigo, sem a coluna irradiance_sum_w_m2.
+struct RollupBucket
+{
+    // Inicio da faixa, em segundos corridos da hora local (ver CivilTime.hpp).
+    std::int64_t start = 0;
+    std::uint64_t rows = 0;
+
+    double energyTotalKWh = 0.0;
+    double energyPvKWh    = 0.0;
+    double energyGridKWh  = 0.0;
+    double co2G           = 0.0;
+
+    // Irradiancia ajustada (a que chega no painel).
+    double irradianceMinWm2 = 0.0;
+    double irradianceSumWm2 = 0.0;
+    double irradianceMaxWm2 = 0.0;
+
+    void add(const ResultRow& row);
+};
+
+class ResultsRollupWriter
+{
+public:
+    explicit ResultsRollupWriter(const std::string& resultsDir = "results");
+
+    // Soma a linha nas tres granularidades.
+    void append(const ResultRow& row);
+
+    // Linha de cabecalho, ja com o '\n'.
+    static const std::string& header();
+
+    // Formata a faixa como linha do arquivo, com o '\n'.
+    static void appendBucket(std::string& out, const RollupBucket& bucket);
+
+    // Le uma linha do arquivo de volta; false se ela nao estiver no formato.
+    // Tambem aceita a linha antiga, sem a soma: ai a soma sai de media x linhas.
+    static bool parseBucket(const std::string& line, RollupBucket& bucket);
+
+private:
+    void appendTo(const std::string& fileName, std::int64_t seconds, const ResultRow& row);
+    void rewriteWith(const std::filesystem::path& rollupPath, std::int64_t bucketStart, const ResultRow& row);
+
+    std::string resultsDir;
+    std::string buffer;
+};
@@ -0,0 +1,80 @@
+#include "TimingCsvWriter.hpp"
+#include "CivilTime.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+namespace
+{
+    const char sep = ';';
+
+    void appendMicros(std::string& out, std::int64_t nanoseconds)
+    {
+        char text[32];
+        int size = std::snprintf(text, sizeof(text), "%.1f", static_cast<double>(nanoseconds) / 1000.0);
+        out += sep;
+        out.append(text, static_cast<size_t>(size));
+    }
+}
+
+TimingCsvWriter::TimingCsvWriter(const std::string& resultsDir)
+    : resultsDir(resultsDir)
+{
+}
+
+std::string TimingCsvWriter::dailyFileName(const std::tm& localTime)
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "TPVfirst%02d%02d%02d.csv",
+                  localTime.tm_mday, localTime.tm_mon + 1, (localTime.tm_year + 1900) % 100);
+    return name;
+}
+
+std::filesystem::path TimingCsvWriter::append(const std::tm& localTime,
+                                              const std::string& status,
+                                              const TickProfile& profile)
+{
+    std::filesystem::create_directories(resultsDir);
+
+    std::filesystem::path timingFilePath =
+        std::filesystem::path(resultsDir) / dailyFileName(localTime);
+
+    bool fileExists = std::filesystem::exists(timingFilePath);
+
+    std::ofstream file(timingFilePath, std::ios::app);
+
+    if (!file.is_open()) {
+        throw std::runtime_error(
+            "Nao consegui abrir ou criar o arquivo de tempos em: " +
+            timingFilePath.string()
+        );
+    }
+
+    buffer.clear();
+
+    if (!fileExists) {
+        buffer += "run_datetime";
+        buffer += sep;
+        buffer += "status";
+        buffer += sep;
+        buffer += "total_us";
+        for (std::size_t stage = 0; stage < tickStageCount; stage++) {
+            buffer += sep;
+            buffer += tickStageName(static_cast<TickStage>(stage));
+            buffer += "_us";
+        }
+        buffer += '\n';
+    }
+
+    appendDateTime(buffer, localTime);
+    buffer += sep;
+    buffer += status;
+    appendMicros(buffer, profile.totalNs);
+    for (std::size_t stage = 0; stage < tickStageCount; stage++)
+        appendMicros(buffer, profile.stageNs[stage]);
+    buffer += '\n';
+
+    file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    return timingFilePath;
+}
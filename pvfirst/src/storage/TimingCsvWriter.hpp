@@ -0,0 +1,28 @@
+#pragma once
+
+#include "simulation/TickProfile.hpp"
+
+#include <ctime>
+#include <filesystem>
+#include <string>
+
+// Aqui eu salvo o tempo de cada etapa de cada execucao num CSV proprio,
+// ao lado do CSV de resultados (results/TPVfirstDDMMAA.csv).
+// Eu deixei separado de proposito: o CSV de resultados continua com as mesmas
+// 33 colunas que o Excel e as ferramentas ja esperam.
+class TimingCsvWriter
+{
+public:
+    explicit TimingCsvWriter(const std::string& resultsDir = "results");
+
+    // status: "ok" quando o job rodou, "sem_irradiancia" quando a execucao parou no filtro.
+    std::filesystem::path append(const std::tm& localTime,
+                                 const std::string& status,
+                                 const TickProfile& profile);
+
+    static std::string dailyFileName(const std::tm& localTime);
+
+private:
+    std::string resultsDir;
+    std::string buffer;
+};